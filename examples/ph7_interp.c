@@ -57,8 +57,11 @@ static const char zBanner[] = {
 static void Help(void)
 {
 	puts(zBanner);
-	puts("ph7 [-h|-r|-d] path/to/php_file [script args]");
+	puts("ph7 [-h|-r|-d|-D|-O|-i] path/to/php_file [script args]");
 	puts("\t-d: Dump PH7 byte-code instructions");
+	puts("\t-D: Dump byte-code of functions and methods too");
+	puts("\t-O: Enable the peephole optimizer");
+	puts("\t-i: Evaluate calls to small functions in place");
 	puts("\t-r: Report run-time errors");
 	puts("\t-h: Display this message an exit");
 	/* Exit immediately */
@@ -114,6 +117,8 @@ int main(int argc,char **argv)
 	ph7 *pEngine; /* PH7 engine */
 	ph7_vm *pVm;  /* Compiled PHP program */
 	int dump_vm = 0;    /* Dump VM instructions if TRUE */
+	int dump_full = 0;  /* Dump functions and methods too if TRUE */
+	int iFlags = 0;     /* Compile flags */
 	int err_report = 0; /* Report run-time errors if TRUE */
 	int n;              /* Script arguments */
 	int rc;
@@ -125,9 +130,18 @@ int main(int argc,char **argv)
 			break;
 		}
 		c = argv[n][1];
-		if( c == 'd' || c == 'D' ){
+		if( c == 'd' ){
 			/* Dump byte-code instructions */
 			dump_vm = 1;
+		}else if( c == 'D' ){
+			/* Dump functions and methods byte-code too */
+			dump_vm = dump_full = 1;
+		}else if( c == 'o' || c == 'O' ){
+			/* Enable the peephole optimizer */
+			iFlags |= PH7_PHP_PEEPHOLE;
+		}else if( c == 'i' || c == 'I' ){
+			/* Inline small user functions */
+			iFlags |= PH7_PHP_INLINE;
 		}else if( c == 'r' || c == 'R' ){
 			/* Report run-time errors */
 			err_report = 1;
@@ -161,7 +175,7 @@ int main(int argc,char **argv)
 		pEngine, /* PH7 Engine */
 		argv[n], /* Path to the PHP file to compile */
 		&pVm,    /* OUT: Compiled PHP program */
-		0        /* IN: Compile flags */
+		iFlags   /* IN: Compile flags */
 		);
 	if( rc != PH7_OK ){ /* Compile error */
 		if( rc == PH7_IO_ERR ){
@@ -196,6 +210,10 @@ int main(int argc,char **argv)
 		/* Report script run-time errors */
 		ph7_vm_config(pVm,PH7_VM_CONFIG_ERR_REPORT);
 	}
+	if( dump_full ){
+		/* Dump functions, methods and peephole statistics */
+		ph7_vm_config(pVm,PH7_VM_CONFIG_DUMP_FULL);
+	}
 	if( dump_vm ){
 		/* Dump PH7 byte-code instructions */
 		ph7_vm_dump_v2(pVm,
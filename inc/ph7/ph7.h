@@ -610,6 +610,21 @@ typedef sxi64 ph7_int64;
 /** ONE ARGUMENT: void (*xErrLog)(const char *,int,const char *,const char *) */
 #define PH7_VM_CONFIG_ERR_LOG_HANDLER 21
 
+/** TWO ARGUMENTS: int nThread,unsigned int nThreshold */
+#define PH7_VM_CONFIG_SORT_THREAD     22
+
+/** TWO ARGUMENTS: const char *zClass,const char *zPath */
+#define PH7_VM_CONFIG_AUTOLOAD_CLASS  23
+
+/** NO ARGUMENTS: Let ph7_vm_dump_v2() dump user functions, class methods and peephole statistics */
+#define PH7_VM_CONFIG_DUMP_FULL       24
+
+/** TWO ARGUMENTS: int nEntry,unsigned int nMaxByte */
+#define PH7_VM_CONFIG_EVAL_CACHE      25
+
+/** THREE ARGUMENTS: const char **azPath,int nPath,int nThread */
+#define PH7_VM_CONFIG_PRELOAD_FILES   26
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /*
@@ -669,6 +684,25 @@ typedef sxi64 ph7_int64;
 /** This flag is reserved for future use. */
 #define PH7_PHP_EXPR 0x02
 
+/**
+ * If this flag is set then the compiler runs the peephole optimizer over
+ * the generated bytecode. Adjacent instructions are rewritten into cheaper
+ * forms [i.e: a store followed by a pop becomes a single store that
+ * discards its result]. Use [ph7_vm_dump_v2()] with the
+ * PH7_VM_CONFIG_DUMP_FULL directive to inspect the rewritten program.
+ */
+#define PH7_PHP_PEEPHOLE 0x04
+
+/**
+ * If this flag is set then calls to small user functions are evaluated in
+ * place without entering a new VM frame. Only plain functions whose body is
+ * a single return of an arithmetic, bitwise or comparison expression over
+ * their by-value arguments qualify [i.e: function sq($x){ return $x*$x; }].
+ * Class methods, closures and functions with static variables, default or
+ * typed arguments are always called the regular way.
+ */
+#define PH7_PHP_INLINE 0x08
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /*
@@ -1163,6 +1197,8 @@ PH7_APIEXPORT int ph7_array_add_intkey_elem(ph7_value* pArray, int iKey, ph7_val
 
 PH7_APIEXPORT unsigned int ph7_array_count(ph7_value* pArray);
 
+PH7_APIEXPORT int ph7_array_reserve(ph7_value* pArray, unsigned int nEntry);
+
 PH7_APIEXPORT int ph7_object_walk(
     ph7_value* pObject,
     int (* xWalk)(const char*, ph7_value*, void*),
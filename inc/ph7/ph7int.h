@@ -39,6 +39,8 @@
 
 #include "ph7.h"
 
+#include <stddef.h> // NULL, size_t
+
 #ifndef PH7_PI
 #define PH7_PI 3.1415926535898
 #endif
@@ -204,6 +206,8 @@ typedef sxi32 (* ProcHashSum)(const void*, sxu32, unsigned char*, sxu32);
 
 typedef sxi32 (* ProcSort)(void*, sxu32, sxu32, ProcCmp);
 
+typedef void (* ProcThreadTask)(void*);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #define MACRO_LIST_PUSH(Head, Item)\
@@ -1208,8 +1212,21 @@ typedef struct ph7_constant
     /** Last argument to xExpand() */
     void* pUserData;
 
+    /** Constant flags (PH7_CONSTANT_* bits) */
+    sxi32 iFlags;
+
+    /** Literal table index of the inlined value (0 when not yet inlined) */
+    sxu32 nLitIdx;
+
 } ph7_constant;
 
+/*
+ * Constant flags.
+ * An immutable constant always expands to the same value and cannot be redefined
+ * so that the compiler is free to inline its value into the literal table.
+ */
+#define PH7_CONSTANT_IMMUTABLE 0x01 /* Constant value never changes */
+
 /**
  * Auxiliary data associated with each foreign function is stored
  * in a stack of the following structure.
@@ -1358,8 +1375,17 @@ struct ph7_hashmap
 
     /** Reference count */
     sxi32 iRef;
+
+    /** Control flags [i.e: HASHMAP_LITERAL] */
+    sxi32 iFlags;
+
+    /** Literal whose entries are shared by this map until its first modification. NULL otherwise */
+    ph7_hashmap* pLiteral;
 };
 
+/** Constant array literal of scalar values folded by the compiler. Loaded as a shared view */
+#define HASHMAP_LITERAL 0x001
+
 /**
  * An instance of the following structure is the context
  * for the FOREACH_STEP/FOREACH_INIT VM instructions.
@@ -1402,6 +1428,9 @@ struct ph7_foreach_step
         ph7_class_instance* pThis;
 
     } xIter;
+
+    /** Next attribute slot to visit [Object iteration only] */
+    sxu32 nAttr;
 };
 
 /// Foreach step control flags.
@@ -1565,6 +1594,81 @@ struct GenBlock
     SySet aPostContFix;
 };
 
+/**
+ * Incremental PHP tokenizer [refer to lex.c].
+ * A PHP chunk is tokenized one top-level statement at a time so that the
+ * token set handed to the code generator never holds more than the statement
+ * being compiled plus a few lookahead tokens.
+ */
+typedef struct ph7_token_stream ph7_token_stream;
+
+struct ph7_token_stream
+{
+    /** Underlying lexer */
+    SyLex sLexer;
+
+    /** First token of the current statement window */
+    sxu32 nStart;
+
+    /** One past the last token of the current statement window */
+    sxu32 nEnd;
+
+    /** First token not yet tracked */
+    sxu32 nScan;
+
+    /** '(','[' and '{' nesting level */
+    sxi32 iNest;
+
+    /** Alternative syntax [i.e: if(): ... endif;] nesting level */
+    sxi32 iAlt;
+
+    /** Pending ternary '?' operators in the current statement */
+    sxi32 nQuest;
+
+    /** Keyword leading the current statement */
+    sxu32 nLead;
+
+    /** TRUE if the next token leads a new statement */
+    sxu8 bLead;
+};
+
+/** Maximum number of peephole rewrite rules [refer to compile.c] */
+#define GEN_PEEPHOLE_MAX 16
+
+/** Default size in bytes of an expression arena block */
+#define GEN_ARENA_BLOCK_SIZE 4096
+
+/**
+ * Expression nodes and their argument sets are bump-allocated from a chain
+ * of blocks owned by the code generator [refer to parse.c].
+ * Blocks are never freed during compilation, they are rewound and reused.
+ */
+typedef struct GenArenaBlock GenArenaBlock;
+
+struct GenArenaBlock
+{
+    /** Next block in the chain */
+    GenArenaBlock* pNext;
+
+    /** Usable bytes that follow this header */
+    sxu32 nSize;
+};
+
+/**
+ * A position in the expression arena. It is saved before an expression tree
+ * is built and restored once its code is emitted, which discards the whole tree at once.
+ */
+typedef struct GenArenaMark GenArenaMark;
+
+struct GenArenaMark
+{
+    /** Current block or NULL if nothing was allocated yet */
+    GenArenaBlock* pBlock;
+
+    /** Used bytes in the current block */
+    sxu32 nUsed;
+};
+
 /**
  * Code generator state is remembered in an instance of the following
  * structure. We put the information in this structure and pass around
@@ -1629,6 +1733,30 @@ struct ph7_gen_state
 
     /** Token containers */
     SySet* pTokenSet;
+
+    /** Incremental tokenizer feeding pTokenSet one statement at a time */
+    ph7_token_stream* pTokStream;
+
+    /** First block of the expression arena */
+    GenArenaBlock* pArenaFirst;
+
+    /** Current position in the expression arena */
+    GenArenaMark sArena;
+
+    /** Literals indexed below this mark may be shared [i.e: inlined constants] and are never reclaimed by the constant folder */
+    sxu32 nLitKeep;
+
+    /** TRUE if calls to pure built-in functions may be folded [i.e: not shadowed by the compiled script] */
+    sxi32 bPureCall;
+
+    /** TRUE if the peephole optimizer is enabled [i.e: PH7_PHP_PEEPHOLE compile flag] */
+    sxi32 bPeephole;
+
+    /** TRUE if calls to small user functions are evaluated in place [i.e: PH7_PHP_INLINE compile flag] */
+    sxi32 bInline;
+
+    /** Number of times each peephole rule was applied [refer to ph7_vm_dump_v2()] */
+    sxu32 aPeephole[GEN_PEEPHOLE_MAX];
 };
 
 /* Forward references */
@@ -1787,6 +1915,12 @@ struct ph7_vm_func
 
     /** Next VM function with the same name as this one */
     ph7_vm_func* pNextName;
+
+    /** Body rewritten for in-place evaluation at call sites [refer to PH7_PHP_INLINE] */
+    struct VmInstr* aInline;
+
+    /** Length of aInline: 0 if the body was not analyzed yet, -1 if it cannot be inlined */
+    sxi32 nInline;
 };
 
 /**
@@ -1819,8 +1953,28 @@ typedef struct ph7_builtin_constant
     /** C routine responsible of expanding constant value */
     ProcConstant xExpand;
 
+    /** TRUE if the value depends on the running script and must be expanded at run-time */
+    int bDynamic;
+
 } ph7_builtin_constant;
 
+/// Magic methods cached in ph7_class.apMagic[]
+
+#define PH7_CLASS_MAGIC_CONSTRUCT  0  /* __construct() or a method named after the class */
+#define PH7_CLASS_MAGIC_DESTRUCT   1  /* __destruct() */
+#define PH7_CLASS_MAGIC_CLONE      2  /* __clone() */
+#define PH7_CLASS_MAGIC_GET        3  /* __get() */
+#define PH7_CLASS_MAGIC_CALL       4  /* __call() */
+#define PH7_CLASS_MAGIC_CALLSTATIC 5  /* __callStatic() */
+#define PH7_CLASS_MAGIC_INVOKE     6  /* __invoke() */
+#define PH7_CLASS_MAGIC_TOSTRING   7  /* __toString() */
+#define PH7_CLASS_MAGIC_TOINT      8  /* __toInt() [Symisc eXtension] */
+#define PH7_CLASS_MAGIC_TOFLOAT    9  /* __toFloat() [Symisc eXtension] */
+#define PH7_CLASS_MAGIC_TOBOOL     10 /* __toBool() [Symisc eXtension] */
+#define PH7_CLASS_MAGIC_OFFSETGET  11 /* ArrayAccess::offsetGet() */
+#define PH7_CLASS_MAGIC_OFFSETSET  12 /* ArrayAccess::offsetSet() */
+#define PH7_CLASS_MAGIC_COUNT      13
+
 /**
  * Each class is parsed out and stored in an instance of the following structure.
  * PH7 introduced powerful extensions to the PHP 5 OO subsystems.
@@ -1852,6 +2006,24 @@ typedef struct ph7_class
     /** Implemented interface container */
     SySet aInterface;
 
+    /** Magic methods resolved once the class is compiled [i.e: apMagic[PH7_CLASS_MAGIC_GET] => __get()] */
+    struct ph7_class_method* apMagic[PH7_CLASS_MAGIC_COUNT];
+
+    /** Recycled instances ready for reuse [i.e: Linked through ph7_class_instance.pNextFree] */
+    ph7_class_instance* pFreeInstance;
+
+    /** Total number of recycled instances */
+    sxu32 nFreeInstance;
+
+    /** Class itself, base classes and implemented interfaces sorted by address */
+    SySet aAncestor;
+
+    /** Instance layout [i.e: attribute stored at each slot of ph7_class_instance.aAttr] */
+    SySet aLayout;
+
+    /** Attribute name => instance slot */
+    SyHash hLayout;
+
     /** Next class [interface, abstract, etc.] with the same name */
     ph7_class* pNextName;
 
@@ -1874,6 +2046,12 @@ typedef struct ph7_class
 /** Class is array-accessible */
 #define PH7_CLASS_ARRAYACCESS 0x020
 
+/** Class mounted [i.e: static attributes initialized and methods installed on first use] */
+#define PH7_CLASS_MOUNTED     0x040
+
+/** Maximum number of recycled instances kept per class */
+#define PH7_CLASS_FREE_INSTANCE_MAX 64
+
 /// Class attribute/methods/constants protection levels.
 
 /** Public visibility. */
@@ -1903,12 +2081,18 @@ typedef struct ph7_class_attr
     /** Compiled attribute body */
     SySet aByteCode;
 
+    /** Precomputed default value [Only if PH7_CLASS_ATTR_TEMPLATE is set] */
+    ph7_value sDefault;
+
     /** Attribute index */
     sxu32 nIdx;
 
     /** Line number on which this attribute was defined */
     sxu32 nLine;
 
+    /** Class that declared this attribute */
+    ph7_class* pClass;
+
 } ph7_class_attr;
 
 /// Attribute configuration
@@ -1925,6 +2109,9 @@ typedef struct ph7_class_attr
 /** Final method */
 #define PH7_CLASS_ATTR_FINAL        0x008
 
+/** Literal default value precomputed at class installation */
+#define PH7_CLASS_ATTR_TEMPLATE     0x010
+
 /**
  * Each class method is parsed out and stored in an instance of the following structure.
  * PH7 introduced some powerful extensions to the PHP 5 programming
@@ -1973,14 +2160,20 @@ struct ph7_class_instance
     /** Object is an instance of this class */
     ph7_class* pClass;
 
-    /** Hashtable of active class members */
-    SyHash hAttr;
+    /** Active class members at the fixed slots given by the class layout */
+    struct VmClassAttr* aAttr;
+
+    /** Total number of slots */
+    sxu32 nAttr;
 
     /** Reference count */
     sxi32 iRef;
 
     /** Control flags */
     sxi32 iFlags;
+
+    /** Next recycled instance in the free list of the class */
+    ph7_class_instance* pNextFree;
 };
 
 /**
@@ -2103,6 +2296,108 @@ typedef struct ph7_switch
 /** Callback to call on failed assertions */
 #define PH7_ASSERT_CALLBACK   0x10
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Parallel sort limits [refer to the PH7_VM_CONFIG_SORT_THREAD configuration directive]
+
+/** Maximum number of threads used by a single sort */
+#define PH7_SORT_THREAD_MAX       64
+
+/** Default minimum number of entries before a sort is split across threads */
+#define PH7_SORT_THREAD_THRESHOLD 100000
+
+/** Maximum number of threads used to preload scripts [refer to PH7_VM_CONFIG_PRELOAD_FILES] */
+#define PH7_PRELOAD_THREAD_MAX    64
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Compiled chunk cache limits [refer to the PH7_VM_CONFIG_EVAL_CACHE configuration directive]
+
+/** Default maximum number of compiled chunks kept by the cache */
+#define PH7_EVAL_CACHE_ENTRIES    128
+
+/** Default memory cap in bytes of the compiled chunk cache */
+#define PH7_EVAL_CACHE_BYTES      (4 * 1024 * 1024)
+
+typedef struct VmEvalEntry VmEvalEntry;
+
+/**
+ * Each chunk compiled by eval(), assert() or include/require is remembered in an
+ * instance of the following structure so that evaluating the same source text
+ * again skips the code generator [refer to VmEvalChunk()].
+ */
+struct VmEvalEntry
+{
+    /** Copy of the source text, also used as the hash key */
+    SyString sSource;
+
+    /** Compile flags the chunk was compiled with */
+    sxi32 iFlags;
+
+    /** Compiled bytecode terminated by PH7_OP_DONE */
+    SySet aByteCode;
+
+    /** Memory charged to the cache */
+    sxu32 nByte;
+
+    /** Number of active executions of this chunk */
+    sxu32 nRef;
+
+    /** Previous entry in the LRU list (more recently used) */
+    VmEvalEntry* pPrev;
+
+    /** Next entry in the LRU list (less recently used) */
+    VmEvalEntry* pNext;
+};
+
+/** Number of strtr() replacement tables kept by each VM */
+#define PH7_STRTR_CACHE_ENTRIES   4
+
+typedef struct ph7_strtr_edge ph7_strtr_edge;
+typedef struct ph7_strtr_table ph7_strtr_table;
+
+/**
+ * Edge of a strtr() replacement trie, stored in an open addressing hashtable
+ * keyed by the parent node and the input byte.
+ */
+struct ph7_strtr_edge
+{
+    /** Parent node */
+    sxu32 iNode;
+
+    /** Child node, zero marks an empty slot */
+    sxu32 iChild;
+
+    /** Input byte */
+    sxu32 c;
+};
+
+/**
+ * The replacement pairs given to strtr() are compiled into a trie of the search
+ * keys so that the subject is translated in a single left to right pass
+ * [refer to the strtr() implementation in builtin.c].
+ */
+struct ph7_strtr_table
+{
+    /** Serialized pairs [i.e: key length, key, value length, value], also used as the cache key */
+    SyBlob sPairs;
+
+    /** Child of the root node for each leading byte, zero if no key starts with it */
+    sxu32 aRoot[256];
+
+    /** Trie edges below the first level */
+    ph7_strtr_edge* aEdge;
+
+    /** Log2 of the number of edge slots */
+    sxu32 nEdgeShift;
+
+    /** Offset plus one in sPairs of the value attached to each node, zero for inner nodes */
+    sxu32* aValue;
+
+    /** Total number of nodes including the root */
+    sxu32 nNode;
+};
+
 /**
  * error_log() consumer function signature.
  * Refer to the [PH7_VM_CONFIG_ERR_LOG_HANDLER] configuration directive
@@ -2157,6 +2452,12 @@ struct ph7_vm
     /** Compiled classes container */
     SyHash hClass;
 
+    /** Autoload index [i.e: class name => script declaring it] */
+    SyHash hAutoload;
+
+    /** Preloaded script contents [i.e: file path => SyString] */
+    SyHash hPreload;
+
     /** Host-application and user defined constants container */
     SyHash hConstant;
 
@@ -2166,6 +2467,16 @@ struct ph7_vm
     /** Compiled functions */
     SyHash hFunction;
 
+    /** Function tables epoch [i.e: Bumped each time hFunction or hHostFunction change] */
+    sxu32 nFuncEpoch;
+
+    /** Functions and classes compiled from the built-in library [i.e: skipped by ph7_vm_dump_v2()] */
+    sxu32 nBuiltinFunc;
+    sxu32 nBuiltinClass;
+
+    /** TRUE to dump user functions, class methods and peephole statistics [refer to PH7_VM_CONFIG_DUMP_FULL] */
+    int bDumpFull;
+
     /** Super-globals hashtable */
     SyHash hSuper;
 
@@ -2232,6 +2543,36 @@ struct ph7_vm
     /** Maximum allowed recusion depth */
     int nMaxDepth;
 
+    /** Number of threads used by the builtin sort functions [refer to sort(),asort(),ksort()...] */
+    sxu32 nSortThread;
+
+    /** Minimum number of entries before a sort is split across threads */
+    sxu32 nSortThreshold;
+
+    /** Compiled chunk cache [refer to VmEvalChunk()] */
+    SyHash hEvalCache;
+
+    /** Most recently used compiled chunk */
+    VmEvalEntry* pEvalFirst;
+
+    /** Least recently used compiled chunk */
+    VmEvalEntry* pEvalLast;
+
+    /** Maximum number of cached chunks, zero disables the cache */
+    sxu32 nEvalMax;
+
+    /** Memory cap in bytes of the compiled chunk cache */
+    sxu32 nEvalMaxByte;
+
+    /** Memory currently charged to the compiled chunk cache */
+    sxu32 nEvalByte;
+
+    /** Number of functions, classes and constants installed so far */
+    sxu32 nDeclared;
+
+    /** Compiled strtr() replacement tables, most recently used first */
+    ph7_strtr_table* apStrtr[PH7_STRTR_CACHE_ENTRIES];
+
     /** OB depth */
     int nObDepth;
 
@@ -2637,6 +2978,9 @@ enum ph7_vm_op
 
     /** Error control */
     PH7_OP_ERR_CTRL,
+
+    /** Load an argument of an inlined function body */
+    PH7_OP_LOAD_ARG,
 };
 
 /**
@@ -3250,6 +3594,17 @@ PH7_PRIVATE sxi32 PH7_TokenizeRawText(char const* zInput, sxu32 nLen, SySet* pOu
 
 PH7_PRIVATE sxi32 PH7_TokenizePHP(char const* zInput, sxu32 nLen, sxu32 nLineStart, SySet* pOut);
 
+PH7_PRIVATE sxi32 PH7_TokenStreamInit(
+    ph7_token_stream* pStream,
+    char const* zInput,
+    sxu32 nLen,
+    sxu32 nLineStart,
+    SySet* pOut);
+
+PH7_PRIVATE sxi32 PH7_TokenStreamNext(ph7_token_stream* pStream);
+
+PH7_PRIVATE sxi32 PH7_TokenStreamRelease(ph7_token_stream* pStream);
+
 /* todo: vm.c function prototypes */
 
 PH7_PRIVATE void PH7_VmReleaseContextValue(ph7_context* pCtx, ph7_value* pValue);
@@ -3271,6 +3626,14 @@ PH7_PRIVATE sxi32 PH7_VmCreateClassInstanceFrame(
     ph7_vm* pVm,
     ph7_class_instance* pObj);
 
+PH7_PRIVATE sxi32 PH7_VmResetClassInstanceFrame(
+    ph7_vm* pVm,
+    ph7_class_instance* pObj);
+
+PH7_PRIVATE sxi32 PH7_VmRecycleClassInstanceFrame(
+    ph7_vm* pVm,
+    ph7_class_instance* pObj);
+
 PH7_PRIVATE sxi32 PH7_VmRefObjRemove(
     ph7_vm* pVm,
     sxu32 nIdx,
@@ -3298,11 +3661,18 @@ PH7_PRIVATE ph7_class* PH7_VmExtractClass(
     sxi32 iLoadable,
     sxi32 iNest);
 
+PH7_PRIVATE ph7_class* PH7_VmLookupClass(
+    ph7_vm* pVm,
+    char const* zName,
+    sxu32 nByte,
+    sxi32 iLoadable);
+
 PH7_PRIVATE sxi32 PH7_VmRegisterConstant(
     ph7_vm* pVm,
     const SyString* pName,
     ProcConstant xExpand,
-    void* pUserData);
+    void* pUserData,
+    sxi32 iFlags);
 
 PH7_PRIVATE sxi32 PH7_VmInstallForeignFunction(
     ph7_vm* pVm,
@@ -3359,6 +3729,8 @@ PH7_PRIVATE VmInstr* PH7_VmPeekInstr(ph7_vm* pVm);
 
 PH7_PRIVATE VmInstr* PH7_VmPeekNextInstr(ph7_vm* pVm);
 
+PH7_PRIVATE sxi32 PH7_VmEvalInstr(ph7_vm* pVm, sxu32 nStart, ph7_value* pResult);
+
 PH7_PRIVATE VmInstr* PH7_VmGetInstr(ph7_vm* pVm, sxu32 nIndex);
 
 PH7_PRIVATE SySet* PH7_VmGetByteCodeContainer(ph7_vm* pVm);
@@ -3443,7 +3815,9 @@ PH7_PRIVATE void PH7_DelimitNestedTokens(
 
 PH7_PRIVATE const ph7_expr_op* PH7_ExprExtractOperator(SyString* pStr, SyToken* pLast);
 
-PH7_PRIVATE sxi32 PH7_ExprFreeTree(ph7_gen_state* pGen, SySet* pNodeSet);
+PH7_PRIVATE void PH7_ExprArenaSave(ph7_gen_state* pGen, GenArenaMark* pMark);
+
+PH7_PRIVATE void PH7_ExprArenaRestore(ph7_gen_state* pGen, const GenArenaMark* pMark);
 
 /* todo: compile.c function prototypes */
 
@@ -3477,6 +3851,10 @@ PH7_PRIVATE sxi32 PH7_GenCompileError(
 
 PH7_PRIVATE sxi32 PH7_CompileScript(ph7_vm* pVm, SyString* pScript, sxi32 iFlags);
 
+PH7_PRIVATE sxi32 PH7_OptimizeByteCode(ph7_vm* pVm, SySet* pByteCode);
+
+PH7_PRIVATE sxi32 PH7_GenPeepholeDump(ph7_gen_state* pGen, ProcConsumer xConsumer, void* pUserData);
+
 /* todo: constant.c function prototypes */
 
 PH7_PRIVATE void PH7_RegisterBuiltInConstant(ph7_vm* pVm);
@@ -3488,7 +3866,10 @@ PH7_PRIVATE void PH7_RegisterBuiltInFunction(ph7_vm* pVm);
 PH7_PRIVATE ph7_hashmap* PH7_NewHashmap(
     ph7_vm* pVm,
     sxu32 (* xIntHash)(sxi64),
-    sxu32 (* xBlobHash)(const void*, sxu32));
+    sxu32 (* xBlobHash)(const void*, sxu32),
+    sxu32 nHint);
+
+PH7_PRIVATE sxi32 PH7_HashmapReserve(ph7_hashmap* pMap, sxu32 nEntry);
 
 PH7_PRIVATE sxi32 PH7_HashmapCreateSuper(ph7_vm* pVm);
 
@@ -3510,6 +3891,9 @@ PH7_PRIVATE sxi32 PH7_HashmapUnion(ph7_hashmap* pLeft, ph7_hashmap* pRight);
 PH7_PRIVATE void PH7_HashmapUnlinkNode(ph7_hashmap_node* pNode, int bRestore);
 
 PH7_PRIVATE sxi32 PH7_HashmapDup(ph7_hashmap* pSrc, ph7_hashmap* pDest);
+PH7_PRIVATE ph7_hashmap* PH7_HashmapDupLiteral(ph7_vm* pVm, ph7_hashmap* pSrc);
+PH7_PRIVATE ph7_hashmap* PH7_HashmapShareLiteral(ph7_vm* pVm, ph7_hashmap* pLiteral);
+PH7_PRIVATE sxi32 PH7_HashmapUnshare(ph7_hashmap* pMap);
 
 PH7_PRIVATE sxi32 PH7_HashmapCmp(ph7_hashmap* pLeft, ph7_hashmap* pRight, int bStrict);
 
@@ -3621,6 +4005,8 @@ PH7_PRIVATE sxi32 PH7_ClassInherit(ph7_gen_state* pGen, ph7_class* pSub, ph7_cla
 PH7_PRIVATE sxi32 PH7_ClassInterfaceInherit(ph7_class* pSub, ph7_class* pBase);
 
 PH7_PRIVATE sxi32 PH7_ClassImplement(ph7_class* pMain, ph7_class* pInterface);
+PH7_PRIVATE sxi32 PH7_ClassBuildAncestry(ph7_class* pClass);
+PH7_PRIVATE void PH7_ClassResolveMagicMethods(ph7_class* pClass);
 
 PH7_PRIVATE ph7_class_instance* PH7_NewClassInstance(
     ph7_vm* pVm,
@@ -3649,8 +4035,7 @@ PH7_PRIVATE sxi32 PH7_ClassInstanceCallMagicMethod(
     ph7_vm* pVm,
     ph7_class* pClass,
     ph7_class_instance* pThis,
-    char const* zMethod,
-    sxu32 nByte,
+    sxi32 iMagic,
     const SyString* pAttrName,
     ph7_value* pKey);
 
@@ -3670,6 +4055,9 @@ PH7_PRIVATE sxi32 PH7_ClassInstanceWalk(
 PH7_PRIVATE ph7_value* PH7_ClassInstanceFetchAttr(
     ph7_class_instance* pThis, const SyString* pName);
 
+PH7_PRIVATE VmClassAttr* PH7_ClassInstanceLookupAttr(
+    ph7_class_instance* pThis, const SyString* pName);
+
 /* todo: vfs.c function prototypes */
 
 #ifndef PH7_DISABLE_BUILTIN_FUNC
@@ -3682,7 +4070,8 @@ PH7_PRIVATE void* PH7_StreamOpenHandle(
     int use_include,
     ph7_value* pResource,
     int bPushInclude,
-    int* pNew);
+    int* pNew,
+    SyBlob* pOpened);
 
 PH7_PRIVATE sxi32 PH7_StreamReadWholeFile(
     void* pHandle,
@@ -4012,4 +4401,6 @@ PH7_PRIVATE sxi32 SyMemBackendMakeThreadSafe(SyMemBackend* pBackend, const SyMut
 
 PH7_PRIVATE sxi32 SyMemBackendDisbaleMutexing(SyMemBackend* pBackend);
 
+PH7_PRIVATE void SyThreadRunTasks(ProcThreadTask xTask, void* pTask, sxu32 nTaskSize, sxu32 nTask);
+
 #endif
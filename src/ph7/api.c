@@ -1238,6 +1238,8 @@ int ph7_delete_function(ph7_vm* pVm, const char* zName)
     rc = SyHashDeleteEntry(&pVm->hHostFunction, (const void*)zName, SyStrlen(zName), (void**)&pFunc);
     if (rc == PH7_OK)
     {
+        /* Unbind call sites referring to this function */
+        pVm->nFuncEpoch++;
         /* Release internal fields */
         SySetRelease(&pFunc->aAux);
         SyMemBackendFree(&pVm->sAllocator, (void*)SyStringData(&pFunc->sName));
@@ -1288,7 +1290,7 @@ int ph7_create_constant(ph7_vm* pVm, const char* zName, void (* xExpand)(ph7_val
     }
 #endif
     /* Perform the registration */
-    rc = PH7_VmRegisterConstant(&(*pVm), &sName, xExpand, pUserData);
+    rc = PH7_VmRegisterConstant(&(*pVm), &sName, xExpand, pUserData, 0);
 #if defined(PH7_ENABLE_THREADS)
     /* Leave VM mutex */
     SyMutexLeave(sMPGlobal.pMutexMethods,
@@ -1373,7 +1375,7 @@ ph7_value* ph7_new_array(ph7_vm* pVm)
         return 0;
     }
     /* Create a new hashmap first */
-    pMap = PH7_NewHashmap(&(*pVm), 0, 0);
+    pMap = PH7_NewHashmap(&(*pVm), 0, 0, 0);
     if (pMap == 0)
     {
         return 0;
@@ -1797,6 +1799,8 @@ ph7_value* ph7_array_fetch(ph7_value* pArray, const char* zKey, int nByte)
     {
         nByte = (int)SyStrlen(zKey);
     }
+    /* The caller may modify the returned value,make sure it does not belong to a shared literal */
+    PH7_HashmapUnshare((ph7_hashmap*)pArray->x.pOther);
     /* Convert the key to a ph7_value  */
     PH7_MemObjInit(pArray->pVm, &skey);
     PH7_MemObjStringAppend(&skey, zKey, (sxu32)nByte);
@@ -1917,6 +1921,25 @@ unsigned int ph7_array_count(ph7_value* pArray)
     return pMap->nEntry;
 }
 
+/*
+ * [CAPIREF: ph7_array_reserve()]
+ * Please refer to the official documentation for function purpose and expected parameters.
+ */
+int ph7_array_reserve(ph7_value* pArray, unsigned int nEntry)
+{
+    ph7_hashmap* pMap;
+    sxi32 rc;
+    /* Make sure we are dealing with a valid hashmap */
+    if ((pArray->iFlags & MEMOBJ_HASHMAP) == 0)
+    {
+        return PH7_CORRUPT;
+    }
+    /* Point to the internal representation of the hashmap */
+    pMap = (ph7_hashmap*)pArray->x.pOther;
+    rc = PH7_HashmapReserve(pMap, (sxu32)nEntry);
+    return rc;
+}
+
 /*
  * [CAPIREF: ph7_object_walk()]
  * Please refer to the official documentation for function purpose and expected parameters.
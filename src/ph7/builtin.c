@@ -2938,6 +2938,21 @@ static int PH7_builtin_explode(ph7_context* pCtx, int nArg, ph7_value** apArg)
         }
         iLimit--;
     }
+    if (nDelim == 1)
+    {
+        /* Single byte delimiter [i.e: ',',' ','\n'...]: The number of entries can
+         * be cheaply computed up front,so presize the array.
+         */
+        int nEntry = 1;
+        for (zCur = zString; zCur < zEnd && nEntry <= iLimit; zCur++)
+        {
+            if (zCur[0] == zDelim[0])
+            {
+                nEntry++;
+            }
+        }
+        ph7_array_reserve(pArray, (unsigned int)nEntry);
+    }
     /* Start exploding */
     for (;;)
     {
@@ -7037,86 +7052,205 @@ static int PH7_builtin_str_pad(ph7_context* pCtx, int nArg, ph7_value** apArg)
 typedef struct str_replace_data str_replace_data;
 struct str_replace_data
 {
-    /* The following two fields are only used by the strtr function */
-    SyBlob* pWorker;         /* Working buffer */
-    ProcStringMatch xMatch;  /* Pattern match routine */
-    /* The following two fields are only used by the str_replace function */
     SySet* pCollector;  /* Argument collector*/
     ph7_context* pCtx;  /* Call context */
 };
+
+/*
+ * Hash a trie edge [i.e: parent node and input byte] into a slot of the edge table.
+ */
+#define STRTR_EDGE_HASH(NODE, C, SHIFT) (((((NODE) << 8) | (C)) * 0x9E3779B1) >> (32 - (SHIFT)))
+
 /*
- * Remove a substring.
+ * Return the child of the given trie node reached through the byte c.
+ * Zero if no key continues that way.
  */
-#define STRDEL(SRC, SLEN, OFFT, ILEN){\
-    for(;;){\
-        if( OFFT + ILEN >= SLEN ) break; SRC[OFFT] = SRC[OFFT+ILEN]; ++OFFT;\
-    }\
+static sxu32 StrtrTableChild(ph7_strtr_table* pTable, sxu32 iNode, sxu32 c)
+{
+    sxu32 nMask = (1u << pTable->nEdgeShift) - 1;
+    sxu32 h = STRTR_EDGE_HASH(iNode, c, pTable->nEdgeShift);
+    ph7_strtr_edge* pEdge;
+    for (;;)
+    {
+        pEdge = &pTable->aEdge[h];
+        if (pEdge->iChild == 0 || (pEdge->iNode == iNode && pEdge->c == c))
+        {
+            return pEdge->iChild;
+        }
+        h = (h + 1) & nMask;
+    }
 }
+
 /*
- * Shift right and insert algorithm.
+ * Release a compiled strtr() replacement table.
  */
-#define SHIFTRANDINSERT(SRC, LEN, OFFT, ENTRY, ELEN){\
-    sxu32 INLEN = LEN - OFFT;\
-    for(;;){\
-      if( LEN > 0 ){ LEN--; } if(INLEN < 1 ) break; SRC[LEN + ELEN] = SRC[LEN] ; --INLEN; \
-    }\
-    for(;;){\
-        if(ELEN < 1)break; SRC[OFFT] = ENTRY[0]; OFFT++; ENTRY++; --ELEN;\
-    }\
+static void StrtrTableRelease(ph7_vm* pVm, ph7_strtr_table* pTable)
+{
+    SyBlobRelease(&pTable->sPairs);
+    SyMemBackendFree(&pVm->sAllocator, pTable->aEdge);
+    SyMemBackendFree(&pVm->sAllocator, pTable->aValue);
+    SyMemBackendFree(&pVm->sAllocator, pTable);
 }
 
 /*
- * Replace all occurrences of the search string at offset (nOfft) with the given
- * replacement string [i.e: zReplace].
+ * Compile the serialized replacement pairs collected by StrtrCollectWalker()
+ * into a trie of the search keys. Each key byte adds at most one node so the
+ * tables are sized up front from the total key length.
+ * Return the new table on success. NULL when running out of memory.
  */
-static int StringReplace(SyBlob* pWorker, sxu32 nOfft, int nLen, const char* zReplace, int nReplen)
+static ph7_strtr_table* StrtrTableBuild(ph7_vm* pVm, SyBlob* pPairs)
 {
-    char* zInput = (char*)SyBlobData(pWorker);
-    sxu32 n, m;
-    n = SyBlobLength(pWorker);
-    m = nOfft;
-    /* Delete the old entry */
-    STRDEL(zInput, n, m, nLen);
-    SyBlobLength(pWorker) -= nLen;
-    if (nReplen > 0)
+    const unsigned char* zPairs, * zEnd, * zKey;
+    ph7_strtr_table* pTable;
+    sxu32 nKeyByte, nShift, nKey, n;
+    /* Total key length */
+    zPairs = (const unsigned char*)SyBlobData(pPairs);
+    zEnd = &zPairs[SyBlobLength(pPairs)];
+    nKeyByte = 0;
+    while (zPairs < zEnd)
     {
-        sxi32 iRep = nReplen;
-        sxi32 rc;
-        /*
-         * Make sure the working buffer is big enough to hold the replacement
-         * string.
-         */
-        rc = SyBlobAppend(pWorker, 0/* Grow without an append operation*/, (sxu32)nReplen);
-        if (rc != SXRET_OK)
+        SyMemcpy((const void*)zPairs, &n, sizeof(sxu32));
+        nKeyByte += n;
+        zPairs += sizeof(sxu32) + n;
+        SyMemcpy((const void*)zPairs, &n, sizeof(sxu32));
+        zPairs += sizeof(sxu32) + n;
+    }
+    /* Keep the edge table at most half full */
+    nShift = 4;
+    while ((1u << nShift) < 2 * nKeyByte)
+    {
+        nShift++;
+    }
+    pTable = (ph7_strtr_table*)SyMemBackendAlloc(&pVm->sAllocator, sizeof(ph7_strtr_table));
+    if (pTable == 0)
+    {
+        return 0;
+    }
+    SyZero(pTable, sizeof(ph7_strtr_table));
+    SyBlobInit(&pTable->sPairs, &pVm->sAllocator);
+    pTable->nEdgeShift = nShift;
+    pTable->aEdge = (ph7_strtr_edge*)SyMemBackendAlloc(&pVm->sAllocator, (1u << nShift) * sizeof(ph7_strtr_edge));
+    pTable->aValue = (sxu32*)SyMemBackendAlloc(&pVm->sAllocator, (nKeyByte + 1) * sizeof(sxu32));
+    if (pTable->aEdge == 0 || pTable->aValue == 0 || SyBlobDup(pPairs, &pTable->sPairs) != SXRET_OK)
+    {
+        StrtrTableRelease(&(*pVm), pTable);
+        return 0;
+    }
+    SyZero(pTable->aEdge, (1u << nShift) * sizeof(ph7_strtr_edge));
+    SyZero(pTable->aValue, (nKeyByte + 1) * sizeof(sxu32));
+    pTable->nNode = 1; /* Root */
+    /* Insert the keys */
+    zPairs = (const unsigned char*)SyBlobData(&pTable->sPairs);
+    zEnd = &zPairs[SyBlobLength(&pTable->sPairs)];
+    while (zPairs < zEnd)
+    {
+        sxu32 iNode = 0;
+        SyMemcpy((const void*)zPairs, &nKey, sizeof(sxu32));
+        zKey = &zPairs[sizeof(sxu32)];
+        for (n = 0; n < nKey; ++n)
         {
-            /* Simply ignore any memory failure problem */
-            return SXRET_OK;
+            sxu32 c = zKey[n];
+            if (iNode == 0)
+            {
+                if (pTable->aRoot[c] == 0)
+                {
+                    pTable->aRoot[c] = pTable->nNode++;
+                }
+                iNode = pTable->aRoot[c];
+            }
+            else
+            {
+                sxu32 nMask = (1u << nShift) - 1;
+                sxu32 h = STRTR_EDGE_HASH(iNode, c, nShift);
+                ph7_strtr_edge* pEdge;
+                for (;;)
+                {
+                    pEdge = &pTable->aEdge[h];
+                    if (pEdge->iChild == 0)
+                    {
+                        /* New edge */
+                        pEdge->iNode = iNode;
+                        pEdge->iChild = pTable->nNode++;
+                        pEdge->c = c;
+                        break;
+                    }
+                    if (pEdge->iNode == iNode && pEdge->c == c)
+                    {
+                        break;
+                    }
+                    h = (h + 1) & nMask;
+                }
+                iNode = pEdge->iChild;
+            }
         }
-        /* Perform the insertion now */
-        zInput = (char*)SyBlobData(pWorker);
-        n = SyBlobLength(pWorker);
-        SHIFTRANDINSERT(zInput, n, nOfft, zReplace, iRep);
-        SyBlobLength(pWorker) += nReplen;
+        zPairs = &zKey[nKey];
+        /* Attach the value to the last node of the key */
+        pTable->aValue[iNode] = (sxu32)(zPairs - (const unsigned char*)SyBlobData(&pTable->sPairs)) + 1;
+        SyMemcpy((const void*)zPairs, &n, sizeof(sxu32));
+        zPairs += sizeof(sxu32) + n;
     }
-    return SXRET_OK;
+    return pTable;
+}
+
+/*
+ * Return the compiled replacement table for the given serialized pairs.
+ * Templates tend to translate many strings with the same pairs so the
+ * most recently used tables are kept by the VM.
+ */
+static ph7_strtr_table* StrtrTableFetch(ph7_vm* pVm, SyBlob* pPairs)
+{
+    ph7_strtr_table* pTable;
+    sxu32 n;
+    for (n = 0; n < PH7_STRTR_CACHE_ENTRIES; ++n)
+    {
+        pTable = pVm->apStrtr[n];
+        if (pTable == 0)
+        {
+            break;
+        }
+        if (SyBlobLength(&pTable->sPairs) == SyBlobLength(pPairs) &&
+            SyMemcmp(SyBlobData(&pTable->sPairs), SyBlobData(pPairs), SyBlobLength(pPairs)) == 0)
+        {
+            /* Cache hit,move to the front */
+            for (; n > 0; --n)
+            {
+                pVm->apStrtr[n] = pVm->apStrtr[n - 1];
+            }
+            pVm->apStrtr[0] = pTable;
+            return pTable;
+        }
+    }
+    pTable = StrtrTableBuild(&(*pVm), pPairs);
+    if (pTable == 0)
+    {
+        return 0;
+    }
+    /* Evict the least recently used table */
+    n = PH7_STRTR_CACHE_ENTRIES - 1;
+    if (pVm->apStrtr[n])
+    {
+        StrtrTableRelease(&(*pVm), pVm->apStrtr[n]);
+    }
+    for (; n > 0; --n)
+    {
+        pVm->apStrtr[n] = pVm->apStrtr[n - 1];
+    }
+    pVm->apStrtr[0] = pTable;
+    return pTable;
 }
 
 /*
  * String replacement walker callback.
  * The following callback is invoked for each array entry that hold
- * the replace string.
+ * the replace string and serialize the pair in the given blob.
  * Refer to the strtr() implementation for more information.
  */
-static int StringReplaceWalker(ph7_value* pKey, ph7_value* pData, void* pUserData)
+static int StrtrCollectWalker(ph7_value* pKey, ph7_value* pData, void* pUserData)
 {
-    str_replace_data* pRepData = (str_replace_data*)pUserData;
+    SyBlob* pPairs = (SyBlob*)pUserData;
     const char* zTarget, * zReplace;
-    SyBlob* pWorker;
     int tLen, nLen;
-    sxu32 nOfft;
-    sxi32 rc;
-    /* Point to the working buffer */
-    pWorker = pRepData->pWorker;
+    sxu32 n;
     if (!ph7_value_is_string(pKey))
     {
         /* Target and replace must be a string */
@@ -7126,21 +7260,16 @@ static int StringReplaceWalker(ph7_value* pKey, ph7_value* pData, void* pUserDat
     zTarget = ph7_value_to_string(pKey, &tLen);
     if (tLen < 1)
     {
-        /* Empty target,return immediately */
+        /* Empty target,ignore */
         return PH7_OK;
     }
-    /* Perform a pattern search */
-    rc = pRepData->xMatch(SyBlobData(pWorker), SyBlobLength(pWorker), (const void*)zTarget, (sxu32)tLen, &nOfft);
-    if (rc != SXRET_OK)
-    {
-        /* Pattern not found */
-        return PH7_OK;
-    }
-    /* Extract the replace string */
     zReplace = ph7_value_to_string(pData, &nLen);
-    /* Perform the replace process */
-    StringReplace(pWorker, nOfft, tLen, zReplace, nLen);
-    /* All done */
+    n = (sxu32)tLen;
+    SyBlobAppend(pPairs, (const void*)&n, sizeof(sxu32));
+    SyBlobAppend(pPairs, (const void*)zTarget, n);
+    n = (sxu32)nLen;
+    SyBlobAppend(pPairs, (const void*)&n, sizeof(sxu32));
+    SyBlobAppend(pPairs, (const void*)zReplace, n);
     return PH7_OK;
 }
 
@@ -7214,7 +7343,7 @@ static int PH7_builtin_str_replace(ph7_context* pCtx, int nArg, ph7_value** apAr
     ProcStringMatch xMatch;
     const char* zIn, * zFunc;
     str_replace_data sRep;
-    SyBlob sWorker;
+    SyBlob sWorker, sOut, sTmp;
     SySet sReplace;
     SySet sSearch;
     int rep_str;
@@ -7230,6 +7359,7 @@ static int PH7_builtin_str_replace(ph7_context* pCtx, int nArg, ph7_value** apAr
     SySetInit(&sSearch, &pCtx->pVm->sAllocator, sizeof(SyString));
     SySetInit(&sReplace, &pCtx->pVm->sAllocator, sizeof(SyString));
     SyBlobInit(&sWorker, &pCtx->pVm->sAllocator);
+    SyBlobInit(&sOut, &pCtx->pVm->sAllocator);
     SyZero(&sRep, sizeof(str_replace_data));
     sRep.pCtx = pCtx;
     sRep.pCollector = &sSearch;
@@ -7323,7 +7453,11 @@ static int PH7_builtin_str_replace(ph7_context* pCtx, int nArg, ph7_value** apAr
             /* Use an empty string instead */
             pReplace = &sTemp;
         }
-        nOfft = nCount = 0;
+        /* Stream the subject into the output buffer,copying the untouched chunks
+         * and the replacement string in place of each match.
+         */
+        SyBlobReset(&sOut);
+        nCount = 0;
         for (;;)
         {
             if (nCount >= SyBlobLength(&sWorker))
@@ -7339,10 +7473,21 @@ static int PH7_builtin_str_replace(ph7_context* pCtx, int nArg, ph7_value** apAr
                 /* Pattern not found */
                 break;
             }
-            /* Perform the replace operation */
-            StringReplace(&sWorker, nCount + nOfft, (int)pSearch->nByte, pReplace->zString, (int)pReplace->nByte);
+            SyBlobAppend(&sOut, SyBlobDataAt(&sWorker, nCount), nOfft);
+            SyBlobAppend(&sOut, (const void*)pReplace->zString, pReplace->nByte);
             /* Increment offset counter */
-            nCount += nOfft + pReplace->nByte;
+            nCount += nOfft + pSearch->nByte;
+        }
+        if (nCount > 0)
+        {
+            /* Copy the tail and make the output the subject of the next search string */
+            if (nCount < SyBlobLength(&sWorker))
+            {
+                SyBlobAppend(&sOut, SyBlobDataAt(&sWorker, nCount), SyBlobLength(&sWorker) - nCount);
+            }
+            sTmp = sWorker;
+            sWorker = sOut;
+            sOut = sTmp;
         }
     }
     /* All done,clean-up the mess left behind */
@@ -7350,6 +7495,7 @@ static int PH7_builtin_str_replace(ph7_context* pCtx, int nArg, ph7_value** apAr
     SySetRelease(&sSearch);
     SySetRelease(&sReplace);
     SyBlobRelease(&sWorker);
+    SyBlobRelease(&sOut);
     return PH7_OK;
 }
 
@@ -7390,22 +7536,73 @@ static int PH7_builtin_strtr(ph7_context* pCtx, int nArg, ph7_value** apArg)
     }
     if (nArg == 2 && ph7_value_is_array(apArg[1]))
     {
-        str_replace_data sRepData;
-        SyBlob sWorker;
-        /* Initilaize the working buffer */
-        SyBlobInit(&sWorker, &pCtx->pVm->sAllocator);
-        /* Copy raw string */
-        SyBlobAppend(&sWorker, (const void*)zIn, (sxu32)nLen);
-        /* Init our replace data instance */
-        sRepData.pWorker = &sWorker;
-        sRepData.xMatch = SyBlobSearch;
-        /* Iterate throw array entries and perform the replace operation.*/
-        ph7_array_walk(apArg[1], StringReplaceWalker, &sRepData);
-        /* All done, return the result string */
-        ph7_result_string(pCtx, (const char*)SyBlobData(&sWorker),
-                          (int)SyBlobLength(&sWorker)); /* Will make it's own copy */
-        /* Clean-up */
-        SyBlobRelease(&sWorker);
+        const char* zEnd, * zCur, * zRaw;
+        ph7_strtr_table* pTable;
+        SyBlob sPairs;
+        /* Serialize the replace pairs and fetch their compiled table */
+        SyBlobInit(&sPairs, &pCtx->pVm->sAllocator);
+        ph7_array_walk(apArg[1], StrtrCollectWalker, &sPairs);
+        pTable = 0;
+        if (SyBlobLength(&sPairs) > 0)
+        {
+            pTable = StrtrTableFetch(pCtx->pVm, &sPairs);
+        }
+        SyBlobRelease(&sPairs);
+        if (pTable == 0)
+        {
+            /* Nothing to replace */
+            ph7_result_string(pCtx, zIn, nLen);
+            return PH7_OK;
+        }
+        /* Translate in a single pass: the longest key starting at the current position
+         * is replaced and the scan resumes right after it,so replaced text is never
+         * translated again.
+         */
+        ph7_result_string(pCtx, "", 0);
+        zCur = zRaw = zIn;
+        zEnd = &zIn[nLen];
+        while (zCur < zEnd)
+        {
+            const char* zPtr = zCur, * zMatch = 0;
+            sxu32 iNode = pTable->aRoot[(unsigned char)zCur[0]];
+            sxu32 iValue = 0;
+            while (iNode != 0)
+            {
+                zPtr++;
+                if (pTable->aValue[iNode] != 0)
+                {
+                    /* Longest key so far */
+                    iValue = pTable->aValue[iNode];
+                    zMatch = zPtr;
+                }
+                if (zPtr >= zEnd)
+                {
+                    break;
+                }
+                iNode = StrtrTableChild(pTable, iNode, (unsigned char)zPtr[0]);
+            }
+            if (iValue == 0)
+            {
+                zCur++;
+                continue;
+            }
+            if (zCur > zRaw)
+            {
+                /* Untouched chunk */
+                ph7_result_string(pCtx, zRaw, (int)(zCur - zRaw));
+            }
+            zPtr = (const char*)SyBlobDataAt(&pTable->sPairs, iValue - 1);
+            SyMemcpy((const void*)zPtr, &iValue, sizeof(sxu32));
+            if (iValue > 0)
+            {
+                ph7_result_string(pCtx, &zPtr[sizeof(sxu32)], (int)iValue);
+            }
+            zCur = zRaw = zMatch;
+        }
+        if (zEnd > zRaw)
+        {
+            ph7_result_string(pCtx, zRaw, (int)(zEnd - zRaw));
+        }
     }
     else
     {
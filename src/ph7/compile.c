@@ -123,6 +123,8 @@ struct LangConstruct
 #define EXPR_FLAG_LOAD_IDX_STORE    0x001 /* Set the iP2 flag when dealing with the LOAD_IDX instruction */
 #define EXPR_FLAG_RDONLY_LOAD       0x002 /* Read-only load, refer to the 'PH7_OP_LOAD' VM instruction for more information */
 #define EXPR_FLAG_COMMA_STATEMENT   0x004 /* Treat comma expression as a single statement (used by class attributes) */
+#define EXPR_FLAG_NO_RESOLVE        0x008 /* Do not resolve static class members at compile time (callee,reference target) */
+#define EXPR_FLAG_MEMBER_NAME       0x010 /* Member name [i.e: Foo::BAR,$a->bar],do not inline built-in constants */
 
 /* Forward declaration */
 static sxi32
@@ -427,6 +429,460 @@ static sxi32 GenStateFixGoto(ph7_gen_state* pGen, sxu32 nOfft)
     return SXRET_OK;
 }
 
+/*
+ * Bytecode optimizer.
+ * The following routines operate on a fully generated instruction stream
+ * [i.e: the main script, an eval()'ed chunk or a function body] once every
+ * forward jump and goto is resolved. Branches on literal conditions are
+ * folded, jump chains are threaded and unreachable instructions and NOOPs
+ * are dropped. Instructions carry no line information [compile-time errors
+ * are already reported and run-time errors refer to names], so jump
+ * destinations are the only thing that has to be remapped.
+ */
+#define GEN_INSTR_REACHED  0x01  /* Instruction is reachable from the entry point */
+#define GEN_INSTR_TARGET   0x02  /* Instruction is a jump destination */
+#define GEN_INSTR_KEEP     0x04  /* Instruction survives the compaction */
+#define GEN_MAX_THREAD     32    /* Longest jump chain followed while threading */
+#define GEN_MAX_PASS       4     /* Maximum number of optimization passes */
+/*
+ * Collect the jump destinations of a given instruction. That is,
+ * every field holding an absolute instruction index.
+ */
+static sxi32 GenStateCollectJumps(VmInstr* pInstr, SySet* pSlot)
+{
+    sxu32* pDest;
+    sxi32 rc;
+    switch (pInstr->iOp)
+    {
+        case PH7_OP_JMP:
+        case PH7_OP_JZ:
+        case PH7_OP_JNZ:
+        case PH7_OP_THROW:
+        case PH7_OP_LOAD_EXCEPTION:
+        case PH7_OP_FOREACH_INIT:
+        case PH7_OP_FOREACH_STEP:
+            pDest = &pInstr->iP2;
+            return SySetPut(&(*pSlot), (const void*)&pDest);
+        case PH7_OP_LT:
+        case PH7_OP_LE:
+        case PH7_OP_GT:
+        case PH7_OP_GE:
+        case PH7_OP_EQ:
+        case PH7_OP_NEQ:
+        case PH7_OP_TEQ:
+        case PH7_OP_TNE:
+        case PH7_OP_SEQ:
+        case PH7_OP_SNE:
+            /* Comparison operators jump only when P2 is set */
+            if (pInstr->iP2 > 0)
+            {
+                pDest = &pInstr->iP2;
+                return SySetPut(&(*pSlot), (const void*)&pDest);
+            }
+            break;
+        case PH7_OP_SWITCH:
+        {
+            ph7_switch* pSwitch = (ph7_switch*)pInstr->p3;
+            ph7_case_expr* aCase;
+            sxu32 n;
+            aCase = (ph7_case_expr*)SySetBasePtr(&pSwitch->aCaseExpr);
+            for (n = 0; n < SySetUsed(&pSwitch->aCaseExpr); ++n)
+            {
+                pDest = &aCase[n].nStart;
+                rc = SySetPut(&(*pSlot), (const void*)&pDest);
+                if (rc != SXRET_OK)
+                {
+                    return rc;
+                }
+            }
+            if (pSwitch->nDefault > 0)
+            {
+                pDest = &pSwitch->nDefault;
+                rc = SySetPut(&(*pSlot), (const void*)&pDest);
+                if (rc != SXRET_OK)
+                {
+                    return rc;
+                }
+            }
+            pDest = &pSwitch->nOut;
+            return SySetPut(&(*pSlot), (const void*)&pDest);
+        }
+        default:
+            break;
+    }
+    return SXRET_OK;
+}
+/*
+ * Follow a chain of NOOP and unconditional jumps starting at a given
+ * destination and return the first instruction that does real work.
+ */
+static sxu32 GenStateThreadJump(VmInstr* aInstr, sxu32 nInstr, sxu32 nDest)
+{
+    sxu32 n;
+    for (n = 0; n < GEN_MAX_THREAD && nDest < nInstr; ++n)
+    {
+        if (aInstr[nDest].iOp == PH7_OP_NOOP)
+        {
+            nDest++;
+        }
+        else if (aInstr[nDest].iOp == PH7_OP_JMP)
+        {
+            nDest = aInstr[nDest].iP2;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return nDest;
+}
+/*
+ * Peephole optimizer.
+ * Each rule matches a window of two adjacent instructions and rewrites it
+ * in place. Discarded instructions are turned into NOOPs which are dropped
+ * by the optimization pass. The SWAP and PULL stack shuffling instructions are
+ * never emitted by this code generator, so no rule deals with them.
+ */
+typedef struct GenPeephole GenPeephole;
+struct GenPeephole
+{
+    const char* zName;  /* Rule name [i.e: as reported by ph7_vm_dump_v2()] */
+    sxi32 iOp;          /* Opcode of the first instruction */
+    sxi32 iNextOp;      /* Opcode of the second instruction */
+    int (* xRewrite)(VmInstr*, VmInstr*); /* Rewrite callback, return TRUE if the window was rewritten */
+};
+/*
+ * Drop one entry from a POP instruction.
+ */
+static void GenPeepholeShrinkPop(VmInstr* pPop)
+{
+    if (pPop->iP1 > 1)
+    {
+        pPop->iP1--;
+    }
+    else
+    {
+        pPop->iOp = PH7_OP_NOOP;
+    }
+}
+/*
+ * LOADC + POP: A literal loaded and popped right away [i.e: 5;].
+ */
+static int GenPeepholeLoadPop(VmInstr* pInstr, VmInstr* pPop)
+{
+    if (pInstr->iP1 != 0 /* Subject to constant expansion */ || pPop->iP1 < 1)
+    {
+        return FALSE;
+    }
+    pInstr->iOp = PH7_OP_NOOP;
+    GenPeepholeShrinkPop(pPop);
+    return TRUE;
+}
+/*
+ * STORE + POP: Assignment used as a statement [i.e: $a = 10;].
+ * The store instruction discards its result when P1 is set.
+ */
+static int GenPeepholeStorePop(VmInstr* pInstr, VmInstr* pPop)
+{
+    if (pInstr->iP1 != 0 || pPop->iP1 < 1)
+    {
+        return FALSE;
+    }
+    pInstr->iP1 = 1;
+    GenPeepholeShrinkPop(pPop);
+    return TRUE;
+}
+/*
+ * INCR/DECR + POP: Pre-increment used as a statement [i.e: ++$i;].
+ * The post-increment form does not copy the new value back to the stack.
+ */
+static int GenPeepholeIncrPop(VmInstr* pInstr, VmInstr* pPop)
+{
+    if (pInstr->iP1 == 0 || pPop->iP1 < 1)
+    {
+        return FALSE;
+    }
+    pInstr->iP1 = 0;
+    return TRUE;
+}
+/*
+ * POP + POP: Merge consecutive pops.
+ */
+static int GenPeepholePopPop(VmInstr* pInstr, VmInstr* pPop)
+{
+    pInstr->iP1 += pPop->iP1;
+    pPop->iOp = PH7_OP_NOOP;
+    return TRUE;
+}
+/* Peephole rewrite rules */
+static const GenPeephole aPeephole[] = {
+    {"loadc-pop",     PH7_OP_LOADC,     PH7_OP_POP, GenPeepholeLoadPop},
+    {"store-pop",     PH7_OP_STORE,     PH7_OP_POP, GenPeepholeStorePop},
+    {"add-store-pop", PH7_OP_ADD_STORE, PH7_OP_POP, GenPeepholeStorePop},
+    {"sub-store-pop", PH7_OP_SUB_STORE, PH7_OP_POP, GenPeepholeStorePop},
+    {"cat-store-pop", PH7_OP_CAT_STORE, PH7_OP_POP, GenPeepholeStorePop},
+    {"incr-pop",      PH7_OP_INCR,      PH7_OP_POP, GenPeepholeIncrPop},
+    {"decr-pop",      PH7_OP_DECR,      PH7_OP_POP, GenPeepholeIncrPop},
+    {"pop-pop",       PH7_OP_POP,       PH7_OP_POP, GenPeepholePopPop}
+};
+/*
+ * Apply the peephole rules to the given instruction stream.
+ * A window is rewritten only if its second instruction is not a jump destination.
+ */
+static void GenStatePeephole(ph7_gen_state* pGen, VmInstr* aInstr, sxu32 nInstr, const sxu8* aFlag)
+{
+    const GenPeephole* pRule;
+    sxu32 n, i;
+    for (n = 0; n + 1 < nInstr; ++n)
+    {
+        if (aFlag[n + 1] & GEN_INSTR_TARGET)
+        {
+            continue;
+        }
+        for (i = 0; i < SX_ARRAYSIZE(aPeephole); ++i)
+        {
+            pRule = &aPeephole[i];
+            if (aInstr[n].iOp == pRule->iOp && aInstr[n + 1].iOp == pRule->iNextOp &&
+                pRule->xRewrite(&aInstr[n], &aInstr[n + 1]))
+            {
+                pGen->aPeephole[i]++;
+                break;
+            }
+        }
+    }
+}
+/*
+ * Dump the number of times each peephole rule was applied.
+ */
+PH7_PRIVATE sxi32 PH7_GenPeepholeDump(ph7_gen_state* pGen, ProcConsumer xConsumer, void* pUserData)
+{
+    sxi32 rc;
+    sxu32 n;
+    rc = SyProcFormat(xConsumer, pUserData, "---- Peephole rewrites (%s) ----\n",
+                      pGen->bPeephole ? "enabled" : "disabled");
+    for (n = 0; rc == SXRET_OK && n < SX_ARRAYSIZE(aPeephole); ++n)
+    {
+        rc = SyProcFormat(xConsumer, pUserData, "%-16s %8u\n", aPeephole[n].zName, pGen->aPeephole[n]);
+    }
+    return rc;
+}
+/*
+ * Perform a single optimization pass over the given instruction stream.
+ * Store the number of discarded instructions in pRemoved.
+ */
+static sxi32 GenStateOptimizePass(ph7_vm* pVm, SySet* pByteCode, sxu32* pRemoved)
+{
+    VmInstr* aInstr, * pInstr;
+    sxu32 nInstr, nNew, n, i;
+    sxu32* aFirst, * aMap;
+    sxu32** apSlot;
+    SySet aSlot, aWork;
+    ph7_value* pObj;
+    ph7_value sCond;
+    sxi32 iNext, iJump;
+    sxu8* aFlag;
+    sxi32 rc;
+    *pRemoved = 0;
+    aInstr = (VmInstr*)SySetBasePtr(pByteCode);
+    nInstr = SySetUsed(pByteCode);
+    if (nInstr < 2 || aInstr[nInstr - 1].iOp != PH7_OP_DONE)
+    {
+        /* Nothing to optimize */
+        return SXRET_OK;
+    }
+    aFirst = (sxu32*)SyMemBackendAlloc(&pVm->sAllocator, 2 * (nInstr + 1) * sizeof(sxu32) + nInstr);
+    if (aFirst == 0)
+    {
+        return SXERR_MEM;
+    }
+    aMap = &aFirst[nInstr + 1];
+    aFlag = (sxu8*)&aMap[nInstr + 1];
+    SyZero(aFlag, nInstr);
+    SySetInit(&aSlot, &pVm->sAllocator, sizeof(sxu32*));
+    SySetInit(&aWork, &pVm->sAllocator, sizeof(sxu32));
+    /* Collect the jump destinations of each instruction */
+    for (n = 0; n < nInstr; ++n)
+    {
+        aFirst[n] = SySetUsed(&aSlot);
+        rc = GenStateCollectJumps(&aInstr[n], &aSlot);
+        if (rc != SXRET_OK)
+        {
+            goto Cleanup;
+        }
+    }
+    aFirst[nInstr] = SySetUsed(&aSlot);
+    apSlot = (sxu32**)SySetBasePtr(&aSlot);
+    for (i = 0; i < SySetUsed(&aSlot); ++i)
+    {
+        if (*apSlot[i] > nInstr)
+        {
+            /* Unresolved jump, leave the stream untouched */
+            rc = SXRET_OK;
+            goto Cleanup;
+        }
+        if (*apSlot[i] < nInstr)
+        {
+            aFlag[*apSlot[i]] |= GEN_INSTR_TARGET;
+        }
+    }
+    /* Fold conditional jumps on a literal [i.e: if( false ){ } or while( true ){ }] */
+    for (n = 0; n + 1 < nInstr; ++n)
+    {
+        pInstr = &aInstr[n + 1];
+        if (aInstr[n].iOp != PH7_OP_LOADC || aInstr[n].iP1 != 0 /* Subject to constant expansion */ ||
+            (pInstr->iOp != PH7_OP_JZ && pInstr->iOp != PH7_OP_JNZ) || pInstr->iP1 != 0 /* Value kept on the stack */ ||
+            (aFlag[n + 1] & GEN_INSTR_TARGET))
+        {
+            continue;
+        }
+        pObj = (ph7_value*)SySetAt(&pVm->aLitObj, aInstr[n].iP2);
+        if (pObj == 0 || (pObj->iFlags & (MEMOBJ_HASHMAP | MEMOBJ_OBJ)))
+        {
+            continue;
+        }
+        PH7_MemObjInit(pVm, &sCond);
+        PH7_MemObjLoad(pObj, &sCond);
+        PH7_MemObjToBool(&sCond);
+        iJump = (sCond.x.iVal != 0) == (pInstr->iOp == PH7_OP_JNZ);
+        PH7_MemObjRelease(&sCond);
+        aInstr[n].iOp = PH7_OP_NOOP;
+        pInstr->iOp = iJump ? PH7_OP_JMP : PH7_OP_NOOP;
+    }
+    /* Thread jump chains */
+    for (i = 0; i < SySetUsed(&aSlot); ++i)
+    {
+        *apSlot[i] = GenStateThreadJump(aInstr, nInstr, *apSlot[i]);
+    }
+    for (n = 0; n + 1 < nInstr; ++n)
+    {
+        if (aInstr[n].iOp == PH7_OP_JMP && aInstr[n].iP2 == GenStateThreadJump(aInstr, nInstr, n + 1))
+        {
+            /* Jump to the next instruction */
+            aInstr[n].iOp = PH7_OP_NOOP;
+        }
+    }
+    if (pVm->sCodeGen.bPeephole)
+    {
+        /* Refresh the jump destinations now the chains are threaded */
+        for (n = 0; n < nInstr; ++n)
+        {
+            aFlag[n] &= ~GEN_INSTR_TARGET;
+        }
+        for (i = 0; i < SySetUsed(&aSlot); ++i)
+        {
+            if (*apSlot[i] < nInstr)
+            {
+                aFlag[*apSlot[i]] |= GEN_INSTR_TARGET;
+            }
+        }
+        GenStatePeephole(&pVm->sCodeGen, aInstr, nInstr, aFlag);
+    }
+    /* Mark the instructions reachable from the entry point */
+    n = 0;
+    aFlag[0] |= GEN_INSTR_REACHED;
+    rc = SySetPut(&aWork, (const void*)&n);
+    while (rc == SXRET_OK && SySetUsed(&aWork) > 0)
+    {
+        n = *(sxu32*)SySetPop(&aWork);
+        switch (aInstr[n].iOp)
+        {
+            case PH7_OP_DONE:
+            case PH7_OP_HALT:
+                iNext = iJump = FALSE;
+                break;
+            case PH7_OP_JMP:
+            case PH7_OP_THROW:
+                iNext = FALSE;
+                iJump = TRUE;
+                break;
+            case PH7_OP_NOOP:
+                /* Possibly a folded conditional jump */
+                iNext = TRUE;
+                iJump = FALSE;
+                break;
+            default:
+                iNext = iJump = TRUE;
+                break;
+        }
+        if (iNext && n + 1 < nInstr && (aFlag[n + 1] & GEN_INSTR_REACHED) == 0)
+        {
+            aFlag[n + 1] |= GEN_INSTR_REACHED;
+            i = n + 1;
+            rc = SySetPut(&aWork, (const void*)&i);
+        }
+        for (i = aFirst[n]; iJump && rc == SXRET_OK && i < aFirst[n + 1]; ++i)
+        {
+            sxu32 nDest = *apSlot[i];
+            if (nDest < nInstr && (aFlag[nDest] & GEN_INSTR_REACHED) == 0)
+            {
+                aFlag[nDest] |= GEN_INSTR_REACHED;
+                rc = SySetPut(&aWork, (const void*)&nDest);
+            }
+        }
+    }
+    if (rc != SXRET_OK)
+    {
+        goto Cleanup;
+    }
+    /* The final DONE is always kept */
+    aFlag[nInstr - 1] |= GEN_INSTR_REACHED;
+    /* Compute the new index of each instruction */
+    nNew = 0;
+    for (n = 0; n < nInstr; ++n)
+    {
+        aMap[n] = nNew;
+        if ((aFlag[n] & GEN_INSTR_REACHED) && (aInstr[n].iOp != PH7_OP_NOOP || n == nInstr - 1))
+        {
+            aFlag[n] |= GEN_INSTR_KEEP;
+            nNew++;
+        }
+    }
+    aMap[nInstr] = nNew;
+    if (nNew < nInstr)
+    {
+        /* Relocate jump destinations, then discard the dead instructions */
+        for (i = 0; i < SySetUsed(&aSlot); ++i)
+        {
+            *apSlot[i] = aMap[*apSlot[i]];
+        }
+        nNew = 0;
+        for (n = 0; n < nInstr; ++n)
+        {
+            if (aFlag[n] & GEN_INSTR_KEEP)
+            {
+                aInstr[nNew++] = aInstr[n];
+            }
+        }
+        SySetTruncate(pByteCode, nNew);
+        *pRemoved = nInstr - nNew;
+    }
+Cleanup:
+    SySetRelease(&aWork);
+    SySetRelease(&aSlot);
+    SyMemBackendFree(&pVm->sAllocator, aFirst);
+    return rc;
+}
+/*
+ * Optimize a fully generated instruction stream. Passes are repeated
+ * while they shrink the stream since dropping dead code may turn jumps
+ * into jumps to the next instruction.
+ */
+PH7_PRIVATE sxi32 PH7_OptimizeByteCode(ph7_vm* pVm, SySet* pByteCode)
+{
+    sxu32 nRemoved;
+    sxu32 nPass;
+    sxi32 rc;
+    for (nPass = 0; nPass < GEN_MAX_PASS; ++nPass)
+    {
+        rc = GenStateOptimizePass(&(*pVm), &(*pByteCode), &nRemoved);
+        if (rc != SXRET_OK || nRemoved < 1)
+        {
+            return rc;
+        }
+    }
+    return SXRET_OK;
+}
+
 /*
  * Check if a given token value is installed in the literal table.
  */
@@ -1229,6 +1685,118 @@ static sxi32 GenStateArrayNodeValidator(ph7_gen_state* pGen, ph7_expr_node* pRoo
     }
     return rc;
 }
+/*
+ * Fold a constant array literal [i.e: array('a' => 1,2,-3.5,array(4,5))].
+ * If every key and value compiled since the instruction at index nStart is
+ * a plain literal (optionally negated) or an already folded array,the array is
+ * built once here and stored in the literal table. The entries bytecodes are
+ * then replaced by a single LOAD_MAP instruction referencing it.
+ * Return SXRET_OK if the array was folded. Any other return value indicates
+ * that the generic LOAD_MAP instruction must be emitted instead.
+ */
+static sxi32 GenStateFoldArrayLiteral(ph7_gen_state* pGen, sxu32 nStart, sxi32 nPair)
+{
+    ph7_vm* pVm = pGen->pVm;
+    ph7_value aEntry[2], * pObj, * pEntry;
+    ph7_hashmap* pMap;
+    VmInstr* pInstr;
+    sxu32 nLen, nIdx, n;
+    int bNested;
+    sxi32 nVal;
+    nLen = PH7_VmInstrLength(pVm);
+    /* Make sure we are dealing with constant entries only */
+    bNested = FALSE;
+    nVal = 0;
+    for (n = nStart; n < nLen; ++n)
+    {
+        pInstr = PH7_VmGetInstr(pVm, n);
+        if (pInstr->iOp == PH7_OP_LOADC && pInstr->iP1 == 0 /* Not subject to constant expansion */)
+        {
+            pObj = (ph7_value*)SySetAt(&pVm->aLitObj, pInstr->iP2);
+            if (pObj == 0)
+            {
+                return SXERR_NOTFOUND;
+            }
+            if (n + 1 < nLen && PH7_VmGetInstr(pVm, n + 1)->iOp == PH7_OP_UMINUS)
+            {
+                if ((pObj->iFlags & (MEMOBJ_INT | MEMOBJ_REAL)) == 0)
+                {
+                    return SXERR_NOTFOUND;
+                }
+                n++; /* Negative number [i.e: -1] */
+            }
+        }
+        else if (pInstr->iOp != PH7_OP_LOAD_MAP || pInstr->iP2 < 1 || (nVal & 1) == 0 /* Array used as key */)
+        {
+            return SXERR_NOTFOUND;
+        }
+        else
+        {
+            bNested = TRUE;
+        }
+        nVal++;
+    }
+    if (nVal != nPair * 2)
+    {
+        return SXERR_NOTFOUND;
+    }
+    /* Build the array exactly as the LOAD_MAP instruction would do at run-time */
+    pMap = PH7_NewHashmap(pVm, 0, 0, (sxu32)nPair);
+    if (pMap == 0)
+    {
+        return SXERR_MEM;
+    }
+    nVal = 0;
+    for (n = nStart; n < nLen; ++n)
+    {
+        pInstr = PH7_VmGetInstr(pVm, n);
+        pEntry = &aEntry[nVal & 1];
+        PH7_MemObjInit(pVm, pEntry);
+        pObj = (ph7_value*)SySetAt(&pVm->aLitObj, pInstr->iP2);
+        PH7_MemObjLoad(pObj, pEntry);
+        if (n + 1 < nLen && PH7_VmGetInstr(pVm, n + 1)->iOp == PH7_OP_UMINUS)
+        {
+            PH7_MemObjToNumeric(pEntry);
+            if (pEntry->iFlags & MEMOBJ_REAL)
+            {
+                pEntry->rVal = -pEntry->rVal;
+            }
+            if (pEntry->iFlags & MEMOBJ_INT)
+            {
+                pEntry->x.iVal = -pEntry->x.iVal;
+            }
+            n++;
+        }
+        if (nVal & 1)
+        {
+            PH7_HashmapInsert(pMap, (aEntry[0].iFlags & MEMOBJ_NULL) ? 0 /* Automatic index assign */ : &aEntry[0],
+                              &aEntry[1]);
+            PH7_MemObjRelease(&aEntry[0]);
+            PH7_MemObjRelease(&aEntry[1]);
+        }
+        nVal++;
+    }
+    /* Install the array in the literal table */
+    pObj = PH7_ReserveConstObj(pVm, &nIdx);
+    if (pObj == 0)
+    {
+        PH7_HashmapRelease(pMap, TRUE);
+        return SXERR_MEM;
+    }
+    PH7_MemObjInitFromArray(pVm, pObj, pMap);
+    if (!bNested)
+    {
+        /* Scalar values only,loaded as a shared view rather than copied */
+        pMap->iFlags |= HASHMAP_LITERAL;
+    }
+    /* Discard the entries bytecodes */
+    while (PH7_VmInstrLength(pVm) > nStart)
+    {
+        (void)PH7_VmPopInstr(pVm);
+    }
+    PH7_VmEmitInstr(pVm, PH7_OP_LOAD_MAP, 0, nIdx, 0, 0);
+    return SXRET_OK;
+}
 /*
  * Compile the 'array' language construct.
  *     According to the PHP language reference manual
@@ -1244,10 +1812,12 @@ PH7_PRIVATE sxi32 PH7_CompileArray(ph7_gen_state* pGen, sxi32 iCompileFlag)
     SyToken* pKey, * pCur;
     sxi32 iEmitRef = 0;
     sxi32 nPair = 0;
+    sxu32 nStart;
     sxi32 iNest;
     sxi32 rc;
     /* Jump the 'array' keyword,the leading left parenthesis and the trailing parenthesis.
      */
+    nStart = PH7_VmInstrLength(pGen->pVm);
     pGen->pIn += 2;
     pGen->pEnd--;
     xValidator = 0;
@@ -1363,6 +1933,11 @@ PH7_PRIVATE sxi32 PH7_CompileArray(ph7_gen_state* pGen, sxi32 iCompileFlag)
         iEmitRef = 0;
         nPair++;
     }
+    if (nPair > 0 && GenStateFoldArrayLiteral(&(*pGen), nStart, nPair) == SXRET_OK)
+    {
+        /* Constant array,built once at compile-time */
+        return SXRET_OK;
+    }
     /* Emit the load map instruction */
     PH7_VmEmitInstr(pGen->pVm, PH7_OP_LOAD_MAP, nPair * 2, 0, 0, 0);
     /* Node successfully compiled */
@@ -1764,7 +2339,7 @@ PH7_PRIVATE sxi32 PH7_CompileVariable(ph7_gen_state* pGen, sxi32 iCompileFlag)
 /*
  * Load a literal.
  */
-static sxi32 GenStateLoadLiteral(ph7_gen_state* pGen)
+static sxi32 GenStateLoadLiteral(ph7_gen_state* pGen, sxi32 iCompileFlag)
 {
     SyToken* pToken = pGen->pIn;
     ph7_value* pObj;
@@ -1851,6 +2426,60 @@ static sxi32 GenStateLoadLiteral(ph7_gen_state* pGen)
         }
         return SXRET_OK;
     }
+    if (pStr->nByte <= 64 && (iCompileFlag & EXPR_FLAG_MEMBER_NAME) == 0)
+    {
+        SyHashEntry* pEntry;
+        /* Immutable built-in constants are expanded once and inlined in the literal table */
+        pEntry = SyHashGet(&pGen->pVm->hConstant, (const void*)pStr->zString, pStr->nByte);
+        if (pEntry != 0)
+        {
+            ph7_constant* pCons = (ph7_constant*)pEntry->pUserData;
+            if (pCons->iFlags & PH7_CONSTANT_IMMUTABLE)
+            {
+                if (pCons->nLitIdx == 0)
+                {
+                    ph7_value sValue;
+                    PH7_MemObjInit(pGen->pVm, &sValue);
+                    pCons->xExpand(&sValue, pCons->pUserData);
+                    if (sValue.iFlags & (MEMOBJ_HASHMAP | MEMOBJ_OBJ | MEMOBJ_RES))
+                    {
+                        /* Not a scalar value,leave it to the run-time */
+                        PH7_MemObjRelease(&sValue);
+                        pCons->iFlags &= ~PH7_CONSTANT_IMMUTABLE;
+                    }
+                    else if (sValue.iFlags & MEMOBJ_NULL)
+                    {
+                        /* NULL constant is always indexed at 0 */
+                        PH7_MemObjRelease(&sValue);
+                        PH7_VmEmitInstr(pGen->pVm, PH7_OP_LOADC, 0, 0, 0, 0);
+                        return SXRET_OK;
+                    }
+                    else
+                    {
+                        pObj = PH7_ReserveConstObj(pGen->pVm, &nIdx);
+                        if (pObj == 0)
+                        {
+                            PH7_MemObjRelease(&sValue);
+                            PH7_GenCompileError(&(*pGen), E_ERROR, 1, "PH7 engine is running out of memory");
+                            return SXERR_ABORT;
+                        }
+                        PH7_MemObjInit(pGen->pVm, pObj);
+                        PH7_MemObjStore(&sValue, pObj);
+                        PH7_MemObjRelease(&sValue);
+                        pCons->nLitIdx = nIdx;
+                        /* The slot is shared by every use of the constant */
+                        pGen->nLitKeep = nIdx + 1;
+                    }
+                }
+                if (pCons->iFlags & PH7_CONSTANT_IMMUTABLE)
+                {
+                    /* Emit the load constant instruction */
+                    PH7_VmEmitInstr(pGen->pVm, PH7_OP_LOADC, 0, pCons->nLitIdx, 0, 0);
+                    return SXRET_OK;
+                }
+            }
+        }
+    }
     /* Query literal table */
     if (SXRET_OK != GenStateFindLiteral(&(*pGen), &pToken->sData, &nIdx))
     {
@@ -1876,7 +2505,7 @@ static sxi32 GenStateLoadLiteral(ph7_gen_state* pGen)
  * a working version that implement namespace,please contact
  * symisc systems via contact@symisc.net
  */
-static sxi32 GenStateResolveNamespaceLiteral(ph7_gen_state* pGen)
+static sxi32 GenStateResolveNamespaceLiteral(ph7_gen_state* pGen, sxi32 iCompileFlag)
 {
     int emit = 0;
     sxi32 rc;
@@ -1894,7 +2523,7 @@ static sxi32 GenStateResolveNamespaceLiteral(ph7_gen_state* pGen)
         pGen->pIn++; /* Ignore the token */
     }
     /* Load literal */
-    rc = GenStateLoadLiteral(&(*pGen));
+    rc = GenStateLoadLiteral(&(*pGen), iCompileFlag);
     return rc;
 }
 /*
@@ -1903,10 +2532,9 @@ static sxi32 GenStateResolveNamespaceLiteral(ph7_gen_state* pGen)
 PH7_PRIVATE sxi32 PH7_CompileLiteral(ph7_gen_state* pGen, sxi32 iCompileFlag)
 {
     sxi32 rc;
-    rc = GenStateResolveNamespaceLiteral(&(*pGen));
+    rc = GenStateResolveNamespaceLiteral(&(*pGen), iCompileFlag);
     if (rc != SXRET_OK)
     {
-        SXUNUSED(iCompileFlag); /* cc warning */
         return rc;
     }
     /* Node successfully compiled */
@@ -2048,7 +2676,7 @@ static sxi32 PH7_CompileConstant(ph7_gen_state* pGen)
     }
     SySetSetUserData(pConsCode, pGen->pVm);
     /* Register the constant */
-    rc = PH7_VmRegisterConstant(pGen->pVm, pName, PH7_VmExpandConstantValue, pConsCode);
+    rc = PH7_VmRegisterConstant(pGen->pVm, pName, PH7_VmExpandConstantValue, pConsCode, 0);
     if (rc != SXRET_OK)
     {
         SySetRelease(pConsCode);
@@ -2373,9 +3001,28 @@ static sxi32 PH7_CompileGoto(ph7_gen_state* pGen)
     pGen->pIn++; /* Jump the label name */
     if (pGen->pIn < pGen->pEnd && (pGen->pIn->nType & PH7_TK_SEMI) == 0)
     {
-        PH7_GenCompileError(&(*pGen), E_ERROR, pGen->pIn->nLine, "Expected semi-colon ';' after 'goto' statement");
+        PH7_GenCompileError(&(*pGen), E_ERROR, pGen->pIn->nLine, "Expected semi-colon ';' after 'goto' statement");
+    }
+    /* Statement successfully compiled */
+    return SXRET_OK;
+}
+
+/*
+ * Point the code generator to the next statement window of the PHP chunk
+ * being tokenized incrementally [refer to PH7_TokenStreamNext()].
+ * Return SXRET_OK on success. SXERR_EOF when the chunk is exhausted.
+ */
+static sxi32 GenStateNextStatement(ph7_gen_state* pGen)
+{
+    ph7_token_stream* pStream = pGen->pTokStream;
+    SyToken* aToken;
+    if (pStream == 0 || PH7_TokenStreamNext(pStream) != SXRET_OK)
+    {
+        return SXERR_EOF;
     }
-    /* Statement successfully compiled */
+    aToken = (SyToken*)SySetBasePtr(pGen->pTokenSet);
+    pGen->pIn = &aToken[pStream->nStart];
+    pGen->pEnd = &aToken[pStream->nEnd];
     return SXRET_OK;
 }
 
@@ -2389,6 +3036,11 @@ static sxi32 GenStateNextChunk(ph7_gen_state* pGen)
     ph7_value* pRawObj; /* Raw chunk [i.e: HTML,XML...] */
     sxu32 nRawObj;
     sxu32 nObjIdx;
+    if (GenStateNextStatement(&(*pGen)) == SXRET_OK)
+    {
+        /* More statements in the current PHP chunk */
+        return SXRET_OK;
+    }
     /* Consume raw chunks verbatim without any processing until we get
      * a PHP block.
      */
@@ -2416,14 +3068,28 @@ static sxi32 GenStateNextChunk(ph7_gen_state* pGen)
     if (pGen->pRawIn < pGen->pRawEnd)
     {
         SySet* pTokenSet = pGen->pTokenSet;
-        /* Reset the token set */
-        SySetReset(pTokenSet);
-        /* Tokenize input */
-        PH7_TokenizePHP(SyStringData(&pGen->pRawIn->sData), SyStringLength(&pGen->pRawIn->sData),
-                        pGen->pRawIn->nLine, pTokenSet);
-        /* Point to the fresh token stream */
-        pGen->pIn = (SyToken*)SySetBasePtr(pTokenSet);
-        pGen->pEnd = &pGen->pIn[SySetUsed(pTokenSet)];
+        if (pGen->pTokStream)
+        {
+            /* Tokenize the next PHP chunk one statement at a time */
+            PH7_TokenStreamInit(pGen->pTokStream, SyStringData(&pGen->pRawIn->sData),
+                                SyStringLength(&pGen->pRawIn->sData), pGen->pRawIn->nLine, pTokenSet);
+            if (GenStateNextStatement(&(*pGen)) != SXRET_OK)
+            {
+                /* Empty chunk */
+                pGen->pIn = pGen->pEnd = (SyToken*)SySetBasePtr(pTokenSet);
+            }
+        }
+        else
+        {
+            /* Reset the token set */
+            SySetReset(pTokenSet);
+            /* Tokenize input */
+            PH7_TokenizePHP(SyStringData(&pGen->pRawIn->sData), SyStringLength(&pGen->pRawIn->sData),
+                            pGen->pRawIn->nLine, pTokenSet);
+            /* Point to the fresh token stream */
+            pGen->pIn = (SyToken*)SySetBasePtr(pTokenSet);
+            pGen->pEnd = &pGen->pIn[SySetUsed(pTokenSet)];
+        }
         /* Advance the stream cursor */
         pGen->pRawIn++;
         /* TICKET 1433-011 */
@@ -4436,6 +5102,11 @@ static sxi32 GenStateCompileFuncBody(
         rc = SXERR_ABORT;
     }
     SySetTruncate(&pGen->aGoto, nGotoOfft);
+    if (rc != SXERR_ABORT)
+    {
+        /* Optimize the function body */
+        PH7_OptimizeByteCode(pGen->pVm, &pFunc->aByteCode);
+    }
     /* Restore the default container */
     PH7_VmSetByteCodeContainer(pGen->pVm, pInstrContainer);
     /* Leave function block */
@@ -5299,7 +5970,7 @@ static sxi32 PH7_CompileClassInterface(ph7_gen_state* pGen)
                 return SXRET_OK;
             }
             pBaseName = &pGen->pIn->sData;
-            pBase = PH7_VmExtractClass(pGen->pVm, pBaseName->zString, pBaseName->nByte, FALSE, 0);
+            pBase = PH7_VmLookupClass(pGen->pVm, pBaseName->zString, pBaseName->nByte, FALSE);
             /* Only interfaces is allowed */
             while (pBase && (pBase->iFlags & PH7_CLASS_INTERFACE) == 0)
             {
@@ -5484,6 +6155,10 @@ static sxi32 PH7_CompileClassInterface(ph7_gen_state* pGen)
         /* Inherit from the base interface */
         rc = PH7_ClassInterfaceInherit(pClass, pBase);
     }
+    if (rc == SXRET_OK)
+    {
+        rc = PH7_ClassBuildAncestry(pClass);
+    }
     if (rc != SXRET_OK)
     {
         PH7_GenCompileError(pGen, E_ERROR, nLine, "Fatal, PH7 is running out of memory");
@@ -5578,7 +6253,7 @@ static sxi32 GenStateCompileClass(ph7_gen_state* pGen, sxi32 iFlags)
             /* Extract base class name */
             pBaseName = &pGen->pIn->sData;
             /* Perform the query */
-            pBase = PH7_VmExtractClass(pGen->pVm, pBaseName->zString, pBaseName->nByte, FALSE, 0);
+            pBase = PH7_VmLookupClass(pGen->pVm, pBaseName->zString, pBaseName->nByte, FALSE);
             /* Interfaces are not allowed */
             while (pBase && (pBase->iFlags & PH7_CLASS_INTERFACE))
             {
@@ -5638,7 +6313,7 @@ static sxi32 GenStateCompileClass(ph7_gen_state* pGen, sxi32 iFlags)
                 /* Extract interface name */
                 pIntName = &pGen->pIn->sData;
                 /* Make sure the interface is already defined */
-                pInterface = PH7_VmExtractClass(pGen->pVm, pIntName->zString, pIntName->nByte, FALSE, 0);
+                pInterface = PH7_VmLookupClass(pGen->pVm, pIntName->zString, pIntName->nByte, FALSE);
                 /* Only interfaces are allowed */
                 while (pInterface && (pInterface->iFlags & PH7_CLASS_INTERFACE) == 0)
                 {
@@ -5983,6 +6658,13 @@ static sxi32 GenStateCompileClass(ph7_gen_state* pGen, sxi32 iFlags)
                 break;
             }
         }
+        if (rc == SXRET_OK)
+        {
+            /* Flatten the class hierarchy for fast [instanceof] queries */
+            rc = PH7_ClassBuildAncestry(pClass);
+            /* Inherited methods are now installed,cache the magic ones */
+            PH7_ClassResolveMagicMethods(pClass);
+        }
     }
     SySetRelease(&aInterfaces);
     if (rc != SXRET_OK)
@@ -6761,6 +7443,527 @@ static sxi32 PH7_CompileSwitch(ph7_gen_state* pGen)
     return SXRET_OK;
 }
 
+/*
+ * Resolve a static member access [i.e: Foo::BAR,Foo::$bar,self::BAR] at compile time.
+ * The target class must be either a named class already compiled (and not shadowed
+ * by another class with the same name) or the enclosing class when 'self' or 'static'
+ * are used inside a final class. These two keywords are late-bound by the VM and
+ * would otherwise expand to the class of the called object.
+ * A class constant whose value is a plain literal is replaced by that literal while
+ * a static attribute is bound to the MEMBER instruction so that the VM loads it by
+ * index rather than looking up the class and the attribute on each access.
+ * Return SXRET_OK if the member access was emitted. Any other return value indicates
+ * that the generic MEMBER instruction must be emitted instead.
+ */
+static sxi32 GenStateResolveStaticMember(ph7_gen_state* pGen, ph7_expr_node* pNode, void* p3, sxi32 iFlags)
+{
+    ph7_vm* pVm = pGen->pVm;
+    VmInstr* pClassInstr, * aInstr;
+    ph7_class_attr* pAttr;
+    ph7_class* pClass;
+    SyString sClass, sName;
+    ph7_value* pObj;
+    sxu32 nLen, nInstr, n;
+    int bSelf;
+    if (pNode->pLeft == 0 || pNode->pRight == 0 || pNode->pLeft->xCode != PH7_CompileLiteral)
+    {
+        /* Dynamic class name [i.e: $obj::BAR] */
+        return SXERR_NOTFOUND;
+    }
+    nLen = PH7_VmInstrLength(pVm);
+    if (p3)
+    {
+        /* Static attribute [i.e: Foo::$bar] */
+        if (pNode->pRight->xCode != PH7_CompileVariable || nLen < 1)
+        {
+            return SXERR_NOTFOUND;
+        }
+        SyStringInitFromBuf(&sName, p3, SyStrlen((const char*)p3));
+        pClassInstr = PH7_VmGetInstr(pVm, nLen - 1);
+    }
+    else
+    {
+        /* Class constant [i.e: Foo::BAR] which cannot be the target of an assignment */
+        if ((iFlags & EXPR_FLAG_LOAD_IDX_STORE) || pNode->pRight->xCode != PH7_CompileLiteral || nLen < 2)
+        {
+            return SXERR_NOTFOUND;
+        }
+        pClassInstr = PH7_VmGetInstr(pVm, nLen - 1);
+        if (pClassInstr->iOp != PH7_OP_LOADC || pClassInstr->iP1 != 1)
+        {
+            return SXERR_NOTFOUND;
+        }
+        pObj = (ph7_value*)SySetAt(&pVm->aLitObj, pClassInstr->iP2);
+        if (pObj == 0 || (pObj->iFlags & MEMOBJ_STRING) == 0)
+        {
+            return SXERR_NOTFOUND;
+        }
+        SyStringInitFromBuf(&sName, SyBlobData(&pObj->sBlob), SyBlobLength(&pObj->sBlob));
+        pClassInstr = PH7_VmGetInstr(pVm, nLen - 2);
+    }
+    /* Extract the class name */
+    if (pClassInstr->iOp != PH7_OP_LOADC || pClassInstr->iP1 != 1 || sName.nByte < 1)
+    {
+        return SXERR_NOTFOUND;
+    }
+    pObj = (ph7_value*)SySetAt(&pVm->aLitObj, pClassInstr->iP2);
+    if (pObj == 0 || (pObj->iFlags & MEMOBJ_STRING) == 0)
+    {
+        return SXERR_NOTFOUND;
+    }
+    SyStringInitFromBuf(&sClass, SyBlobData(&pObj->sBlob), SyBlobLength(&pObj->sBlob));
+    bSelf = FALSE;
+    if ((sClass.nByte == sizeof("self") - 1 && SyMemcmp(sClass.zString, "self", sizeof("self") - 1) == 0) ||
+        (sClass.nByte == sizeof("static") - 1 && SyMemcmp(sClass.zString, "static", sizeof("static") - 1) == 0))
+    {
+        GenBlock* pBlock = pGen->pCurrent;
+        ph7_vm_func* pFunc;
+        /* Extract the enclosing method */
+        while (pBlock && (pBlock->iFlags & GEN_BLOCK_FUNC) == 0)
+        {
+            pBlock = pBlock->pParent;
+        }
+        if (pBlock == 0)
+        {
+            return SXERR_NOTFOUND;
+        }
+        pFunc = (ph7_vm_func*)pBlock->pUserData;
+        if ((pFunc->iFlags & VM_FUNC_CLASS_METHOD) == 0)
+        {
+            return SXERR_NOTFOUND;
+        }
+        pClass = (ph7_class*)pFunc->pUserData;
+        if (pClass == 0 || (pClass->iFlags & PH7_CLASS_FINAL) == 0)
+        {
+            /* Late-bound,subclasses may override the member */
+            return SXERR_NOTFOUND;
+        }
+        bSelf = TRUE;
+    }
+    else
+    {
+        if (SyHashGet(&pVm->hConstant, (const void*)sClass.zString, sClass.nByte) != 0)
+        {
+            /* Subject to constant expansion */
+            return SXERR_NOTFOUND;
+        }
+        pClass = PH7_VmLookupClass(pVm, sClass.zString, sClass.nByte, FALSE);
+        if (pClass == 0 || pClass->pNextName)
+        {
+            /* Not yet declared or ambiguous class */
+            return SXERR_NOTFOUND;
+        }
+    }
+    pAttr = PH7_ClassExtractAttribute(pClass, sName.zString, sName.nByte);
+    if (pAttr == 0 || (!bSelf && pAttr->iProtection != PH7_CLASS_PROT_PUBLIC))
+    {
+        /* Let the VM report the error or check the access */
+        return SXERR_NOTFOUND;
+    }
+    if (p3)
+    {
+        if ((pAttr->iFlags & PH7_CLASS_ATTR_STATIC) == 0)
+        {
+            return SXERR_NOTFOUND;
+        }
+        /* Pop the class name and bind the attribute */
+        (void)PH7_VmPopInstr(pVm);
+        PH7_VmEmitInstr(pVm, PH7_OP_MEMBER, 2, 0, pAttr, 0);
+        return SXRET_OK;
+    }
+    if ((pAttr->iFlags & PH7_CLASS_ATTR_CONSTANT) == 0)
+    {
+        return SXERR_NOTFOUND;
+    }
+    /* Expected bytecodes: LOADC [UMINUS] DONE */
+    aInstr = (VmInstr*)SySetBasePtr(&pAttr->aByteCode);
+    nInstr = SySetUsed(&pAttr->aByteCode);
+    if (nInstr < 2 || nInstr > 3 || aInstr[nInstr - 1].iOp != PH7_OP_DONE ||
+        aInstr[0].iOp != PH7_OP_LOADC || aInstr[0].iP1 != 0 /* Subject to constant expansion */)
+    {
+        return SXERR_NOTFOUND;
+    }
+    pObj = (ph7_value*)SySetAt(&pVm->aLitObj, aInstr[0].iP2);
+    if (pObj == 0 || (pObj->iFlags & MEMOBJ_HASHMAP) ||
+        (nInstr == 3 && (aInstr[1].iOp != PH7_OP_UMINUS || (pObj->iFlags & (MEMOBJ_INT | MEMOBJ_REAL)) == 0)))
+    {
+        return SXERR_NOTFOUND;
+    }
+    /* Pop the class and constant names and load the literal value instead */
+    (void)PH7_VmPopInstr(pVm);
+    (void)PH7_VmPopInstr(pVm);
+    for (n = 0; n < nInstr - 1; ++n)
+    {
+        PH7_VmEmitInstr(pVm, aInstr[n].iOp, aInstr[n].iP1, aInstr[n].iP2, aInstr[n].p3, 0);
+    }
+    return SXRET_OK;
+}
+/*
+ * Side-effect free foreign functions whose calls on literal arguments
+ * are evaluated at compile time [i.e: strlen('x'),md5('secret')].
+ */
+static const struct
+{
+    const char* zName; /* Function name */
+    sxu32 nByte;       /* Name length */
+    sxi32 nMinArg;     /* Minimum number of arguments */
+    sxi32 nMaxArg;     /* Maximum number of arguments */
+} aPureFunc[] = {
+    {"strlen",     sizeof("strlen") - 1,     1, 1},
+    {"strtolower", sizeof("strtolower") - 1, 1, 1},
+    {"strtoupper", sizeof("strtoupper") - 1, 1, 1},
+    {"ucfirst",    sizeof("ucfirst") - 1,    1, 1},
+    {"lcfirst",    sizeof("lcfirst") - 1,    1, 1},
+    {"trim",       sizeof("trim") - 1,       1, 2},
+    {"ltrim",      sizeof("ltrim") - 1,      1, 2},
+    {"rtrim",      sizeof("rtrim") - 1,      1, 2},
+    {"strrev",     sizeof("strrev") - 1,     1, 1},
+    {"ord",        sizeof("ord") - 1,        1, 1},
+    {"chr",        sizeof("chr") - 1,        1, 1},
+    {"intval",     sizeof("intval") - 1,     1, 1},
+    {"floatval",   sizeof("floatval") - 1,   1, 1},
+    {"strval",     sizeof("strval") - 1,     1, 1},
+    {"abs",        sizeof("abs") - 1,        1, 1},
+    {"floor",      sizeof("floor") - 1,      1, 1},
+    {"ceil",       sizeof("ceil") - 1,       1, 1},
+    {"dechex",     sizeof("dechex") - 1,     1, 1},
+    {"hexdec",     sizeof("hexdec") - 1,     1, 1},
+    {"md5",        sizeof("md5") - 1,        1, 1},
+    {"sha1",       sizeof("sha1") - 1,       1, 1},
+    {"crc32",      sizeof("crc32") - 1,      1, 1}
+};
+/*
+ * Check if one of the given PHP chunks declares a function with the same name as
+ * one of the pure built-ins. Since function declarations are installed at compile
+ * time,such a function would shadow the built-in for calls that appear before it.
+ * The chunks are tokenized one statement at a time and the name following each
+ * 'function' keyword is checked. Chunks where the keyword does not appear are skipped.
+ * A false positive [i.e: a class method named strlen] only disables the folding of calls.
+ */
+static int GenStateShadowsPureFunc(SySet* pRawToken, SySet* pTokenSet)
+{
+    SyToken* pRaw = (SyToken*)SySetBasePtr(pRawToken);
+    SyToken* pEnd = &pRaw[SySetUsed(pRawToken)];
+    ph7_token_stream sStream;
+    SyToken* aToken, * pTok;
+    const char* zIn, * zEnd;
+    sxu32 n, i;
+    int rc = FALSE;
+    for (; pRaw < pEnd && !rc; ++pRaw)
+    {
+        if ((pRaw->nType & PH7_TOKEN_PHP) == 0)
+        {
+            continue;
+        }
+        /* Cheap check first */
+        zIn = SyStringData(&pRaw->sData);
+        zEnd = &zIn[SyStringLength(&pRaw->sData)];
+        while (zIn + sizeof("function") - 1 <= zEnd && SyStrnicmp(zIn, "function", sizeof("function") - 1) != 0)
+        {
+            zIn++;
+        }
+        if (zIn + sizeof("function") - 1 > zEnd)
+        {
+            continue;
+        }
+        PH7_TokenStreamInit(&sStream, SyStringData(&pRaw->sData), SyStringLength(&pRaw->sData), pRaw->nLine,
+                            &(*pTokenSet));
+        while (!rc && PH7_TokenStreamNext(&sStream) == SXRET_OK)
+        {
+            aToken = (SyToken*)SySetBasePtr(pTokenSet);
+            for (n = sStream.nStart; n < sStream.nEnd && !rc; ++n)
+            {
+                if ((aToken[n].nType & PH7_TK_KEYWORD) == 0 ||
+                    SX_PTR_TO_INT(aToken[n].pUserData) != PH7_TKWRD_FUNCTION)
+                {
+                    continue;
+                }
+                /* Skip the reference operator */
+                pTok = &aToken[n + 1];
+                if (pTok < &aToken[SySetUsed(pTokenSet)] && (pTok->nType & PH7_TK_AMPER))
+                {
+                    pTok++;
+                }
+                if (pTok >= &aToken[SySetUsed(pTokenSet)])
+                {
+                    continue;
+                }
+                for (i = 0; i < SX_ARRAYSIZE(aPureFunc); ++i)
+                {
+                    if (aPureFunc[i].nByte == SyStringLength(&pTok->sData) &&
+                        SyStrnicmp(aPureFunc[i].zName, SyStringData(&pTok->sData), aPureFunc[i].nByte) == 0)
+                    {
+                        rc = TRUE;
+                        break;
+                    }
+                }
+            }
+        }
+        PH7_TokenStreamRelease(&sStream);
+    }
+    SySetReset(&(*pTokenSet));
+    return rc;
+}
+/*
+ * Check if the given function name refer to a side-effect free foreign function
+ * that can be called at compile time with nArg arguments.
+ * A user-defined function with the same name shadows the foreign one.
+ */
+static int GenStateIsPureFunc(ph7_gen_state* pGen, ph7_value* pName, sxi32 nArg)
+{
+    ph7_vm* pVm = pGen->pVm;
+    const char* zName;
+    sxu32 nByte, n;
+    if (!pGen->bPureCall || (pName->iFlags & MEMOBJ_STRING) == 0)
+    {
+        return FALSE;
+    }
+    zName = (const char*)SyBlobData(&pName->sBlob);
+    nByte = SyBlobLength(&pName->sBlob);
+    for (n = 0; n < SX_ARRAYSIZE(aPureFunc); ++n)
+    {
+        if (aPureFunc[n].nByte == nByte && SyMemcmp(aPureFunc[n].zName, zName, nByte) == 0)
+        {
+            if (nArg < aPureFunc[n].nMinArg || nArg > aPureFunc[n].nMaxArg)
+            {
+                return FALSE;
+            }
+            return SyHashGet(&pVm->hFunction, (const void*)zName, nByte) == 0 &&
+                   SyHashGet(&pVm->hHostFunction, (const void*)zName, nByte) != 0;
+        }
+    }
+    return FALSE;
+}
+/*
+ * Release the literals installed while compiling the operands of a folded node
+ * [i.e: literals indexed at nLit or above]. Nothing is released unless each of
+ * these literals is loaded by the discarded instructions,so a literal that may be
+ * referenced from elsewhere is never reclaimed. Literals below the nLitKeep mark
+ * [i.e: inlined constants] are kept as well.
+ */
+static void GenStateReclaimLiterals(ph7_gen_state* pGen, sxu32 nStart, sxu32 nLit)
+{
+    ph7_vm* pVm = pGen->pVm;
+    SyHashEntry* pEntry;
+    VmInstr* pInstr;
+    ph7_value* pObj;
+    sxu32 nLen, nUsed, i, n;
+    if (nLit < pGen->nLitKeep)
+    {
+        nLit = pGen->nLitKeep;
+    }
+    nLen = PH7_VmInstrLength(pVm);
+    nUsed = SySetUsed(&pVm->aLitObj);
+    for (i = nLit; i < nUsed; ++i)
+    {
+        for (n = nStart; n < nLen; ++n)
+        {
+            pInstr = PH7_VmGetInstr(pVm, n);
+            if (pInstr->iOp == PH7_OP_LOADC && pInstr->iP2 == i)
+            {
+                break;
+            }
+        }
+        if (n >= nLen)
+        {
+            /* Not an operand literal */
+            return;
+        }
+    }
+    while (nUsed > nLit)
+    {
+        nUsed--;
+        pObj = (ph7_value*)SySetPeek(&pVm->aLitObj);
+        if (SyBlobLength(&pObj->sBlob) > 0)
+        {
+            /* The literal table does not own its keys,remove the entry first */
+            pEntry = SyHashGet(&pGen->hLiteral, SyBlobData(&pObj->sBlob), SyBlobLength(&pObj->sBlob));
+            if (pEntry && (sxu32)SX_PTR_TO_INT(pEntry->pUserData) == nUsed)
+            {
+                SyHashDeleteEntry2(pEntry);
+            }
+        }
+        PH7_MemObjRelease(pObj);
+        (void)SySetPop(&pVm->aLitObj);
+    }
+}
+/*
+ * Fold the operator node which generated the instructions starting at nStart.
+ * The node is folded when each of its operands was compiled to a single literal
+ * load [i.e: 60*60*24,'a'.'b',-1,!true,(int)'12',strlen('x')]. Since operands
+ * are folded first,nested constant expressions collapse bottom-up to a single
+ * value. The instructions are evaluated by the VM itself so that the result is
+ * exactly what would have been computed at run-time,then replaced by a
+ * single LOADC instruction referencing the result in the literal table.
+ * nLit and nDeclared are the size of the literal table and the number of
+ * compile-time declarations when the node started. If nothing was declared
+ * meanwhile [i.e: a lambda body],the operand literals are reclaimed.
+ * Return SXRET_OK if the node was folded. Any other return value indicates
+ * that the generated instructions were left untouched.
+ */
+static sxi32 GenStateFoldExpr(ph7_gen_state* pGen, sxu32 nStart, sxu32 nLit, sxu32 nDeclared)
+{
+    ph7_vm* pVm = pGen->pVm;
+    ph7_value sResult, sDiv, * pObj;
+    VmInstr* pInstr, * pLast;
+    sxu32 nLen, nIdx, n;
+    sxi32 nOperand, nLoad;
+    nLen = PH7_VmInstrLength(pVm);
+    if (nLen < nStart + 2)
+    {
+        return SXERR_NOTFOUND;
+    }
+    pLast = PH7_VmGetInstr(pVm, nLen - 1);
+    switch (pLast->iOp)
+    {
+        case PH7_OP_UMINUS:
+        case PH7_OP_UPLUS:
+        case PH7_OP_BITNOT:
+        case PH7_OP_LNOT:
+        case PH7_OP_CVT_INT:
+        case PH7_OP_CVT_STR:
+        case PH7_OP_CVT_REAL:
+        case PH7_OP_CVT_BOOL:
+            nOperand = 1;
+            break;
+        case PH7_OP_CAT:
+        case PH7_OP_MUL:
+        case PH7_OP_DIV:
+        case PH7_OP_MOD:
+        case PH7_OP_ADD:
+        case PH7_OP_SUB:
+        case PH7_OP_SHL:
+        case PH7_OP_SHR:
+        case PH7_OP_LT:
+        case PH7_OP_LE:
+        case PH7_OP_GT:
+        case PH7_OP_GE:
+        case PH7_OP_EQ:
+        case PH7_OP_NEQ:
+        case PH7_OP_TEQ:
+        case PH7_OP_TNE:
+        case PH7_OP_SEQ:
+        case PH7_OP_SNE:
+        case PH7_OP_BAND:
+        case PH7_OP_BXOR:
+        case PH7_OP_BOR:
+        case PH7_OP_LAND:
+        case PH7_OP_LOR:
+        case PH7_OP_LXOR:
+            nOperand = 2;
+            break;
+        case PH7_OP_CALL:
+            /* Function name plus the given arguments */
+            nOperand = pLast->iP1 + 1;
+            break;
+        default:
+            /* Not a pure operator */
+            return SXERR_NOTFOUND;
+    }
+    /* Make sure we are dealing with literal operands only */
+    nLoad = 0;
+    for (n = nStart; n < nLen - 1; ++n)
+    {
+        pInstr = PH7_VmGetInstr(pVm, n);
+        if (pInstr->iOp == PH7_OP_LOADC && pInstr->iP1 == 0 /* Not subject to constant expansion */)
+        {
+            pObj = (ph7_value*)SySetAt(&pVm->aLitObj, pInstr->iP2);
+            if (pObj == 0 || (pObj->iFlags & MEMOBJ_HASHMAP))
+            {
+                return SXERR_NOTFOUND;
+            }
+            nLoad++;
+        }
+        else if ((pInstr->iOp == PH7_OP_JZ || pInstr->iOp == PH7_OP_JNZ) && pInstr->iP1 &&
+                 (pLast->iOp == PH7_OP_LAND || pLast->iOp == PH7_OP_LOR) && pInstr->iP2 == nLen)
+        {
+            /* Short-circuit jump of the logical and/or operator */
+            continue;
+        }
+        else
+        {
+            return SXERR_NOTFOUND;
+        }
+    }
+    if (nLoad != nOperand)
+    {
+        return SXERR_NOTFOUND;
+    }
+    pInstr = PH7_VmGetInstr(pVm, nLen - 2);
+    pObj = (ph7_value*)SySetAt(&pVm->aLitObj, pInstr->iP2);
+    if (pLast->iOp == PH7_OP_CALL)
+    {
+        /* The function name is the last loaded literal */
+        if (!GenStateIsPureFunc(&(*pGen), pObj, pLast->iP1))
+        {
+            return SXERR_NOTFOUND;
+        }
+    }
+    else if (pLast->iOp == PH7_OP_DIV || pLast->iOp == PH7_OP_MOD)
+    {
+        sxi32 iZero;
+        /* Leave the division by zero error to the run-time */
+        PH7_MemObjInit(pVm, &sDiv);
+        PH7_MemObjLoad(pObj, &sDiv);
+        if (pLast->iOp == PH7_OP_DIV)
+        {
+            PH7_MemObjToReal(&sDiv);
+            iZero = sDiv.rVal == 0;
+        }
+        else
+        {
+            PH7_MemObjToInteger(&sDiv);
+            iZero = sDiv.x.iVal == 0;
+        }
+        PH7_MemObjRelease(&sDiv);
+        if (iZero)
+        {
+            return SXERR_NOTFOUND;
+        }
+    }
+    /* Evaluate the expression */
+    PH7_MemObjInit(pVm, &sResult);
+    if (PH7_VmEvalInstr(pVm, nStart, &sResult) != SXRET_OK ||
+        (sResult.iFlags & (MEMOBJ_HASHMAP | MEMOBJ_OBJ | MEMOBJ_RES)))
+    {
+        PH7_MemObjRelease(&sResult);
+        return SXERR_NOTFOUND;
+    }
+    if (pVm->nDeclared == nDeclared)
+    {
+        GenStateReclaimLiterals(&(*pGen), nStart, nLit);
+    }
+    if (sResult.iFlags & MEMOBJ_NULL)
+    {
+        /* NULL constant are always indexed at 0 */
+        nIdx = 0;
+    }
+    else if (sResult.iFlags & MEMOBJ_BOOL)
+    {
+        /* TRUE and FALSE constants are always indexed at 1 and 2 */
+        nIdx = sResult.x.iVal ? 1 : 2;
+    }
+    else
+    {
+        /* Install the result in the literal table */
+        pObj = PH7_ReserveConstObj(pVm, &nIdx);
+        if (pObj == 0)
+        {
+            PH7_MemObjRelease(&sResult);
+            return SXERR_MEM;
+        }
+        PH7_MemObjInit(pVm, pObj);
+        PH7_MemObjStore(&sResult, pObj);
+    }
+    PH7_MemObjRelease(&sResult);
+    /* Discard the operands and the operator */
+    while (PH7_VmInstrLength(pVm) > nStart)
+    {
+        (void)PH7_VmPopInstr(pVm);
+    }
+    PH7_VmEmitInstr(pVm, PH7_OP_LOADC, 0, nIdx, 0, 0);
+    return SXRET_OK;
+}
 /*
  * Generate bytecode for a given expression tree.
  * If something goes wrong while generating bytecode
@@ -6779,6 +7982,7 @@ static sxi32 GenStateEmitExprCode(
     sxi32 iP1 = 0;
     sxu32 iP2 = 0;
     void* p3 = 0;
+    sxu32 nStart, nLit, nDeclared;
     sxi32 iVmOp;
     sxi32 rc;
     if (pNode->xCode)
@@ -6797,6 +8001,9 @@ static sxi32 GenStateEmitExprCode(
         return SXERR_ABORT;
     }
     iVmOp = pNode->pOp->iVmOp;
+    nStart = PH7_VmInstrLength(pGen->pVm);
+    nLit = SySetUsed(&pGen->pVm->aLitObj);
+    nDeclared = pGen->pVm->nDeclared;
     if (pNode->pOp->iOp == EXPR_OP_QUESTY)
     {
         sxu32 nJz, nJmp;
@@ -6872,7 +8079,8 @@ static sxi32 GenStateEmitExprCode(
             /* Remove stale flags now */
             iFlags &= ~EXPR_FLAG_RDONLY_LOAD;
         }
-        rc = GenStateEmitExprCode(&(*pGen), pNode->pLeft, iFlags);
+        rc = GenStateEmitExprCode(&(*pGen), pNode->pLeft,
+                                  iVmOp == PH7_OP_CALL ? (iFlags | EXPR_FLAG_NO_RESOLVE) : iFlags);
         if (rc != SXRET_OK)
         {
             return rc;
@@ -6902,7 +8110,8 @@ static sxi32 GenStateEmitExprCode(
             apNode = (ph7_expr_node**)SySetBasePtr(&pNode->aNodeArgs);
             for (n = 0; n < (sxi32)SySetUsed(&pNode->aNodeArgs); ++n)
             {
-                rc = GenStateEmitExprCode(&(*pGen), apNode[n], iFlags & ~EXPR_FLAG_LOAD_IDX_STORE);
+                rc = GenStateEmitExprCode(&(*pGen), apNode[n],
+                                          iFlags & ~(EXPR_FLAG_LOAD_IDX_STORE | EXPR_FLAG_NO_RESOLVE));
                 if (rc != SXRET_OK)
                 {
                     return rc;
@@ -6943,6 +8152,16 @@ static sxi32 GenStateEmitExprCode(
         {
             iFlags |= EXPR_FLAG_LOAD_IDX_STORE;
         }
+        else if (iVmOp == PH7_OP_STORE_REF)
+        {
+            /* The reference target is taken from the last load instruction */
+            iFlags |= EXPR_FLAG_NO_RESOLVE;
+        }
+        else if (iVmOp == PH7_OP_MEMBER)
+        {
+            /* The member name is looked up by the VM */
+            iFlags |= EXPR_FLAG_MEMBER_NAME;
+        }
         rc = GenStateEmitExprCode(&(*pGen), pNode->pRight, iFlags);
         if (iVmOp == PH7_OP_STORE)
         {
@@ -7035,6 +8254,12 @@ static sxi32 GenStateEmitExprCode(
                     p3 = pInstr->p3;
                     (void)PH7_VmPopInstr(pGen->pVm);
                 }
+                if ((iFlags & EXPR_FLAG_NO_RESOLVE) == 0 &&
+                    GenStateResolveStaticMember(&(*pGen), pNode, p3, iFlags) == SXRET_OK)
+                {
+                    /* Member access resolved at compile time */
+                    return SXRET_OK;
+                }
             }
         }
         /* Finally,emit the VM instruction associated with this operator */
@@ -7048,6 +8273,11 @@ static sxi32 GenStateEmitExprCode(
                 pInstr->iP2 = PH7_VmInstrLength(pGen->pVm);
             }
         }
+        if (rc == SXRET_OK)
+        {
+            /* Fold constant expressions */
+            GenStateFoldExpr(&(*pGen), nStart, nLit, nDeclared);
+        }
     }
     return rc;
 }
@@ -7070,6 +8300,7 @@ static sxi32 PH7_CompileExpr(
 )
 {
     ph7_expr_node* pRoot;
+    GenArenaMark sMark;
     SySet sExprNode;
     SyToken* pEnd;
     sxi32 nExpr;
@@ -7078,8 +8309,8 @@ static sxi32 PH7_CompileExpr(
     /* Initialize worker variables */
     nExpr = 0;
     pRoot = 0;
-    SySetInit(&sExprNode, &pGen->pVm->sAllocator, sizeof(ph7_expr_node*));
-    SySetAlloc(&sExprNode, 0x10);
+    /* Node pointers are stored in the expression arena,hence no memory backend */
+    SySetInit(&sExprNode, 0, sizeof(ph7_expr_node*));
     rc = SXRET_OK;
     /* Delimit the expression */
     pEnd = pGen->pIn;
@@ -7138,6 +8369,8 @@ static sxi32 PH7_CompileExpr(
         SyToken* pTmp = pGen->pEnd;
         /* Swap delimiter */
         pGen->pEnd = pEnd;
+        /* Nodes are allocated from the expression arena */
+        PH7_ExprArenaSave(&(*pGen), &sMark);
         /* Try to get an expression tree */
         rc = PH7_ExprMakeTree(&(*pGen), &sExprNode, &pRoot);
         if (rc == SXRET_OK && pRoot)
@@ -7156,17 +8389,15 @@ static sxi32 PH7_CompileExpr(
             nExpr = 1;
         }
         /* Release the whole tree */
-        PH7_ExprFreeTree(&(*pGen), &sExprNode);
+        PH7_ExprArenaRestore(&(*pGen), &sMark);
         /* Synchronize token stream */
         pGen->pEnd = pTmp;
         pGen->pIn = pEnd;
         if (rc == SXERR_ABORT)
         {
-            SySetRelease(&sExprNode);
             return SXERR_ABORT;
         }
     }
-    SySetRelease(&sExprNode);
     return nExpr > 0 ? SXRET_OK : SXERR_EMPTY;
 }
 /*
@@ -7429,6 +8660,7 @@ static sxi32 PH7_CompilePHP(
 )
 {
     SyToken* pScript = pGen->pRawIn; /* Script to compile */
+    ph7_token_stream sStream;        /* Incremental tokenizer */
     sxi32 rc;
     /* Reset the token set */
     SySetReset(&(*pTokenSet));
@@ -7436,13 +8668,14 @@ static sxi32 PH7_CompilePHP(
     pGen->pTokenSet = &(*pTokenSet);
     /* Advance the stream cursor */
     pGen->pRawIn++;
-    /* Tokenize the PHP chunk first */
-    PH7_TokenizePHP(SyStringData(&pScript->sData), SyStringLength(&pScript->sData), pScript->nLine, &(*pTokenSet));
-    /* Point to the head and tail of the token stream. */
-    pGen->pIn = (SyToken*)SySetBasePtr(pTokenSet);
-    pGen->pEnd = &pGen->pIn[SySetUsed(pTokenSet)];
     if (is_expr)
     {
+        /* Tokenize the whole expression */
+        PH7_TokenizePHP(SyStringData(&pScript->sData), SyStringLength(&pScript->sData), pScript->nLine,
+                        &(*pTokenSet));
+        /* Point to the head and tail of the token stream. */
+        pGen->pIn = (SyToken*)SySetBasePtr(pTokenSet);
+        pGen->pEnd = &pGen->pIn[SySetUsed(pTokenSet)];
         rc = SXERR_EMPTY;
         if (pGen->pIn < pGen->pEnd)
         {
@@ -7453,6 +8686,17 @@ static sxi32 PH7_CompilePHP(
         PH7_VmEmitInstr(pGen->pVm, PH7_OP_DONE, (rc != SXERR_EMPTY ? 1 : 0), 0, 0, 0);
         return SXRET_OK;
     }
+    /* Tokenize the PHP chunk one top-level statement at a time so that the token set
+     * never holds more than the statement being compiled.
+     */
+    PH7_TokenStreamInit(&sStream, SyStringData(&pScript->sData), SyStringLength(&pScript->sData), pScript->nLine,
+                        &(*pTokenSet));
+    pGen->pTokStream = &sStream;
+    if (GenStateNextStatement(&(*pGen)) != SXRET_OK)
+    {
+        /* Empty chunk */
+        pGen->pIn = pGen->pEnd = (SyToken*)SySetBasePtr(pTokenSet);
+    }
     if (pGen->pIn < pGen->pEnd && (pGen->pIn->nType & PH7_TK_EQUAL))
     {
         static const sxu32 nKeyID = PH7_TKWRD_ECHO;
@@ -7477,10 +8721,21 @@ static sxi32 PH7_CompilePHP(
         {
             PH7_VmEmitInstr(pGen->pVm, PH7_OP_POP, 1, 0, 0, 0);
         }
+        pGen->pTokStream = 0;
+        PH7_TokenStreamRelease(&sStream);
         return SXRET_OK;
     }
     /* Compile the PHP chunk */
-    rc = GenStateCompileChunk(pGen, 0);
+    for (;;)
+    {
+        rc = GenStateCompileChunk(pGen, 0);
+        if (rc == SXERR_ABORT || GenStateNextStatement(&(*pGen)) != SXRET_OK)
+        {
+            break;
+        }
+    }
+    pGen->pTokStream = 0;
+    PH7_TokenStreamRelease(&sStream);
     /* Fix exceptions jumps */
     GenStateFixJumps(pGen->pCurrent, PH7_OP_THROW, PH7_VmInstrLength(pGen->pVm));
     /* Fix gotos now, the jump destination is resolved */
@@ -7544,6 +8799,18 @@ PH7_PRIVATE sxi32 PH7_CompileScript(
         PH7_TokenizeRawText(pScript->zString, pScript->nByte, &aRawToken);
     }
     pCodeGen = &pVm->sCodeGen;
+    /* Calls to pure built-ins are folded unless the script shadows them */
+    pCodeGen->bPureCall = !GenStateShadowsPureFunc(&aRawToken, &aPhpToken);
+    if (iFlags & PH7_PHP_PEEPHOLE)
+    {
+        /* Sticky: chunks compiled later by include/eval are optimized the same way */
+        pCodeGen->bPeephole = TRUE;
+    }
+    if (iFlags & PH7_PHP_INLINE)
+    {
+        /* Sticky as well */
+        pCodeGen->bInline = TRUE;
+    }
     /* Process high-level tokens */
     pCodeGen->pRawIn = (SyToken*)SySetBasePtr(&aRawToken);
     pCodeGen->pRawEnd = &pCodeGen->pRawIn[SySetUsed(&aRawToken)];
@@ -2073,210 +2073,210 @@ static void PH7_parent_Const(ph7_value* pVal, void* pUserData)
  * Table of built-in constants.
  */
 static const ph7_builtin_constant aBuiltIn[] = {
-    {"PH7_VERSION", PH7_VER_Const},
-    {"PH7_ENGINE", PH7_VER_Const},
-    {"__PH7__", PH7_VER_Const},
-    {"PHP_OS", PH7_OS_Const},
-    {"PHP_EOL", PH7_EOL_Const},
-    {"PHP_INT_MAX", PH7_INTMAX_Const},
-    {"MAXINT", PH7_INTMAX_Const},
-    {"PHP_INT_SIZE", PH7_INTSIZE_Const},
-    {"PATH_SEPARATOR", PH7_PATHSEP_Const},
-    {"DIRECTORY_SEPARATOR", PH7_DIRSEP_Const},
-    {"DIR_SEP", PH7_DIRSEP_Const},
-    {"__TIME__", PH7_TIME_Const},
-    {"__DATE__", PH7_DATE_Const},
-    {"__FILE__", PH7_FILE_Const},
-    {"__DIR__", PH7_DIR_Const},
-    {"PHP_SHLIB_SUFFIX", PH7_PHP_SHLIB_SUFFIX_Const},
-    {"E_ERROR", PH7_E_ERROR_Const},
-    {"E_WARNING", PH7_E_WARNING_Const},
-    {"E_PARSE", PH7_E_PARSE_Const},
-    {"E_NOTICE", PH7_E_NOTICE_Const},
-    {"E_CORE_ERROR", PH7_E_CORE_ERROR_Const},
-    {"E_CORE_WARNING", PH7_E_CORE_WARNING_Const},
-    {"E_COMPILE_ERROR", PH7_E_COMPILE_ERROR_Const},
-    {"E_COMPILE_WARNING", PH7_E_COMPILE_WARNING_Const},
-    {"E_USER_ERROR", PH7_E_USER_ERROR_Const},
-    {"E_USER_WARNING", PH7_E_USER_WARNING_Const},
-    {"E_USER_NOTICE ", PH7_E_USER_NOTICE_Const},
-    {"E_STRICT", PH7_E_STRICT_Const},
-    {"E_RECOVERABLE_ERROR", PH7_E_RECOVERABLE_ERROR_Const},
-    {"E_DEPRECATED", PH7_E_DEPRECATED_Const},
-    {"E_USER_DEPRECATED", PH7_E_USER_DEPRECATED_Const},
-    {"E_ALL", PH7_E_ALL_Const},
-    {"CASE_LOWER", PH7_CASE_LOWER_Const},
-    {"CASE_UPPER", PH7_CASE_UPPER_Const},
-    {"STR_PAD_LEFT", PH7_STR_PAD_LEFT_Const},
-    {"STR_PAD_RIGHT", PH7_STR_PAD_RIGHT_Const},
-    {"STR_PAD_BOTH", PH7_STR_PAD_BOTH_Const},
-    {"COUNT_NORMAL", PH7_COUNT_NORMAL_Const},
-    {"COUNT_RECURSIVE", PH7_COUNT_RECURSIVE_Const},
-    {"SORT_ASC", PH7_SORT_ASC_Const},
-    {"SORT_DESC", PH7_SORT_DESC_Const},
-    {"SORT_REGULAR", PH7_SORT_REG_Const},
-    {"SORT_NUMERIC", PH7_SORT_NUMERIC_Const},
-    {"SORT_STRING", PH7_SORT_STRING_Const},
-    {"PHP_ROUND_HALF_DOWN", PH7_PHP_ROUND_HALF_DOWN_Const},
-    {"PHP_ROUND_HALF_EVEN", PH7_PHP_ROUND_HALF_EVEN_Const},
-    {"PHP_ROUND_HALF_UP", PH7_PHP_ROUND_HALF_UP_Const},
-    {"PHP_ROUND_HALF_ODD", PH7_PHP_ROUND_HALF_ODD_Const},
-    {"DEBUG_BACKTRACE_IGNORE_ARGS", PH7_DBIA_Const},
-    {"DEBUG_BACKTRACE_PROVIDE_OBJECT", PH7_DBPO_Const},
+    {"PH7_VERSION", PH7_VER_Const, 0},
+    {"PH7_ENGINE", PH7_VER_Const, 0},
+    {"__PH7__", PH7_VER_Const, 0},
+    {"PHP_OS", PH7_OS_Const, 0},
+    {"PHP_EOL", PH7_EOL_Const, 0},
+    {"PHP_INT_MAX", PH7_INTMAX_Const, 0},
+    {"MAXINT", PH7_INTMAX_Const, 0},
+    {"PHP_INT_SIZE", PH7_INTSIZE_Const, 0},
+    {"PATH_SEPARATOR", PH7_PATHSEP_Const, 0},
+    {"DIRECTORY_SEPARATOR", PH7_DIRSEP_Const, 0},
+    {"DIR_SEP", PH7_DIRSEP_Const, 0},
+    {"__TIME__", PH7_TIME_Const, 1},
+    {"__DATE__", PH7_DATE_Const, 1},
+    {"__FILE__", PH7_FILE_Const, 1},
+    {"__DIR__", PH7_DIR_Const, 1},
+    {"PHP_SHLIB_SUFFIX", PH7_PHP_SHLIB_SUFFIX_Const, 0},
+    {"E_ERROR", PH7_E_ERROR_Const, 0},
+    {"E_WARNING", PH7_E_WARNING_Const, 0},
+    {"E_PARSE", PH7_E_PARSE_Const, 0},
+    {"E_NOTICE", PH7_E_NOTICE_Const, 0},
+    {"E_CORE_ERROR", PH7_E_CORE_ERROR_Const, 0},
+    {"E_CORE_WARNING", PH7_E_CORE_WARNING_Const, 0},
+    {"E_COMPILE_ERROR", PH7_E_COMPILE_ERROR_Const, 0},
+    {"E_COMPILE_WARNING", PH7_E_COMPILE_WARNING_Const, 0},
+    {"E_USER_ERROR", PH7_E_USER_ERROR_Const, 0},
+    {"E_USER_WARNING", PH7_E_USER_WARNING_Const, 0},
+    {"E_USER_NOTICE ", PH7_E_USER_NOTICE_Const, 0},
+    {"E_STRICT", PH7_E_STRICT_Const, 0},
+    {"E_RECOVERABLE_ERROR", PH7_E_RECOVERABLE_ERROR_Const, 0},
+    {"E_DEPRECATED", PH7_E_DEPRECATED_Const, 0},
+    {"E_USER_DEPRECATED", PH7_E_USER_DEPRECATED_Const, 0},
+    {"E_ALL", PH7_E_ALL_Const, 0},
+    {"CASE_LOWER", PH7_CASE_LOWER_Const, 0},
+    {"CASE_UPPER", PH7_CASE_UPPER_Const, 0},
+    {"STR_PAD_LEFT", PH7_STR_PAD_LEFT_Const, 0},
+    {"STR_PAD_RIGHT", PH7_STR_PAD_RIGHT_Const, 0},
+    {"STR_PAD_BOTH", PH7_STR_PAD_BOTH_Const, 0},
+    {"COUNT_NORMAL", PH7_COUNT_NORMAL_Const, 0},
+    {"COUNT_RECURSIVE", PH7_COUNT_RECURSIVE_Const, 0},
+    {"SORT_ASC", PH7_SORT_ASC_Const, 0},
+    {"SORT_DESC", PH7_SORT_DESC_Const, 0},
+    {"SORT_REGULAR", PH7_SORT_REG_Const, 0},
+    {"SORT_NUMERIC", PH7_SORT_NUMERIC_Const, 0},
+    {"SORT_STRING", PH7_SORT_STRING_Const, 0},
+    {"PHP_ROUND_HALF_DOWN", PH7_PHP_ROUND_HALF_DOWN_Const, 0},
+    {"PHP_ROUND_HALF_EVEN", PH7_PHP_ROUND_HALF_EVEN_Const, 0},
+    {"PHP_ROUND_HALF_UP", PH7_PHP_ROUND_HALF_UP_Const, 0},
+    {"PHP_ROUND_HALF_ODD", PH7_PHP_ROUND_HALF_ODD_Const, 0},
+    {"DEBUG_BACKTRACE_IGNORE_ARGS", PH7_DBIA_Const, 0},
+    {"DEBUG_BACKTRACE_PROVIDE_OBJECT", PH7_DBPO_Const, 0},
 #ifdef PH7_ENABLE_MATH_FUNC
-    {"M_PI", PH7_M_PI_Const},
-    {"M_E", PH7_M_E_Const},
-    {"M_LOG2E", PH7_M_LOG2E_Const},
-    {"M_LOG10E", PH7_M_LOG10E_Const},
-    {"M_LN2", PH7_M_LN2_Const},
-    {"M_LN10", PH7_M_LN10_Const},
-    {"M_PI_2", PH7_M_PI_2_Const},
-    {"M_PI_4", PH7_M_PI_4_Const},
-    {"M_1_PI", PH7_M_1_PI_Const},
-    {"M_2_PI", PH7_M_2_PI_Const},
-    {"M_SQRTPI", PH7_M_SQRTPI_Const},
-    {"M_2_SQRTPI", PH7_M_2_SQRTPI_Const},
-    {"M_SQRT2", PH7_M_SQRT2_Const},
-    {"M_SQRT3", PH7_M_SQRT3_Const},
-    {"M_SQRT1_2", PH7_M_SQRT1_2_Const},
-    {"M_LNPI", PH7_M_LNPI_Const},
-    {"M_EULER", PH7_M_EULER_Const},
+    {"M_PI", PH7_M_PI_Const, 0},
+    {"M_E", PH7_M_E_Const, 0},
+    {"M_LOG2E", PH7_M_LOG2E_Const, 0},
+    {"M_LOG10E", PH7_M_LOG10E_Const, 0},
+    {"M_LN2", PH7_M_LN2_Const, 0},
+    {"M_LN10", PH7_M_LN10_Const, 0},
+    {"M_PI_2", PH7_M_PI_2_Const, 0},
+    {"M_PI_4", PH7_M_PI_4_Const, 0},
+    {"M_1_PI", PH7_M_1_PI_Const, 0},
+    {"M_2_PI", PH7_M_2_PI_Const, 0},
+    {"M_SQRTPI", PH7_M_SQRTPI_Const, 0},
+    {"M_2_SQRTPI", PH7_M_2_SQRTPI_Const, 0},
+    {"M_SQRT2", PH7_M_SQRT2_Const, 0},
+    {"M_SQRT3", PH7_M_SQRT3_Const, 0},
+    {"M_SQRT1_2", PH7_M_SQRT1_2_Const, 0},
+    {"M_LNPI", PH7_M_LNPI_Const, 0},
+    {"M_EULER", PH7_M_EULER_Const, 0},
 #endif /* PH7_ENABLE_MATH_FUNC */
-    {"DATE_ATOM", PH7_DATE_ATOM_Const},
-    {"DATE_COOKIE", PH7_DATE_COOKIE_Const},
-    {"DATE_ISO8601", PH7_DATE_ISO8601_Const},
-    {"DATE_RFC822", PH7_DATE_RFC822_Const},
-    {"DATE_RFC850", PH7_DATE_RFC850_Const},
-    {"DATE_RFC1036", PH7_DATE_RFC1036_Const},
-    {"DATE_RFC1123", PH7_DATE_RFC1123_Const},
-    {"DATE_RFC2822", PH7_DATE_RFC2822_Const},
-    {"DATE_RFC3339", PH7_DATE_ATOM_Const},
-    {"DATE_RSS", PH7_DATE_RSS_Const},
-    {"DATE_W3C", PH7_DATE_W3C_Const},
-    {"ENT_COMPAT", PH7_ENT_COMPAT_Const},
-    {"ENT_QUOTES", PH7_ENT_QUOTES_Const},
-    {"ENT_NOQUOTES", PH7_ENT_NOQUOTES_Const},
-    {"ENT_IGNORE", PH7_ENT_IGNORE_Const},
-    {"ENT_SUBSTITUTE", PH7_ENT_SUBSTITUTE_Const},
-    {"ENT_DISALLOWED", PH7_ENT_DISALLOWED_Const},
-    {"ENT_HTML401", PH7_ENT_HTML401_Const},
-    {"ENT_XML1", PH7_ENT_XML1_Const},
-    {"ENT_XHTML", PH7_ENT_XHTML_Const},
-    {"ENT_HTML5", PH7_ENT_HTML5_Const},
-    {"ISO-8859-1", PH7_ISO88591_Const},
-    {"ISO_8859_1", PH7_ISO88591_Const},
-    {"UTF-8", PH7_UTF8_Const},
-    {"UTF8", PH7_UTF8_Const},
-    {"HTML_ENTITIES", PH7_HTML_ENTITIES_Const},
-    {"HTML_SPECIALCHARS", PH7_HTML_SPECIALCHARS_Const},
-    {"PHP_URL_SCHEME", PH7_PHP_URL_SCHEME_Const},
-    {"PHP_URL_HOST", PH7_PHP_URL_HOST_Const},
-    {"PHP_URL_PORT", PH7_PHP_URL_PORT_Const},
-    {"PHP_URL_USER", PH7_PHP_URL_USER_Const},
-    {"PHP_URL_PASS", PH7_PHP_URL_PASS_Const},
-    {"PHP_URL_PATH", PH7_PHP_URL_PATH_Const},
-    {"PHP_URL_QUERY", PH7_PHP_URL_QUERY_Const},
-    {"PHP_URL_FRAGMENT", PH7_PHP_URL_FRAGMENT_Const},
-    {"PHP_QUERY_RFC1738", PH7_PHP_QUERY_RFC1738_Const},
-    {"PHP_QUERY_RFC3986", PH7_PHP_QUERY_RFC3986_Const},
-    {"FNM_NOESCAPE", PH7_FNM_NOESCAPE_Const},
-    {"FNM_PATHNAME", PH7_FNM_PATHNAME_Const},
-    {"FNM_PERIOD", PH7_FNM_PERIOD_Const},
-    {"FNM_CASEFOLD", PH7_FNM_CASEFOLD_Const},
-    {"PATHINFO_DIRNAME", PH7_PATHINFO_DIRNAME_Const},
-    {"PATHINFO_BASENAME", PH7_PATHINFO_BASENAME_Const},
-    {"PATHINFO_EXTENSION", PH7_PATHINFO_EXTENSION_Const},
-    {"PATHINFO_FILENAME", PH7_PATHINFO_FILENAME_Const},
-    {"ASSERT_ACTIVE", PH7_ASSERT_ACTIVE_Const},
-    {"ASSERT_WARNING", PH7_ASSERT_WARNING_Const},
-    {"ASSERT_BAIL", PH7_ASSERT_BAIL_Const},
-    {"ASSERT_QUIET_EVAL", PH7_ASSERT_QUIET_EVAL_Const},
-    {"ASSERT_CALLBACK", PH7_ASSERT_CALLBACK_Const},
-    {"SEEK_SET", PH7_SEEK_SET_Const},
-    {"SEEK_CUR", PH7_SEEK_CUR_Const},
-    {"SEEK_END", PH7_SEEK_END_Const},
-    {"LOCK_EX", PH7_LOCK_EX_Const},
-    {"LOCK_SH", PH7_LOCK_SH_Const},
-    {"LOCK_NB", PH7_LOCK_NB_Const},
-    {"LOCK_UN", PH7_LOCK_UN_Const},
-    {"FILE_USE_INCLUDE_PATH", PH7_FILE_USE_INCLUDE_PATH_Const},
-    {"FILE_IGNORE_NEW_LINES", PH7_FILE_IGNORE_NEW_LINES_Const},
-    {"FILE_SKIP_EMPTY_LINES", PH7_FILE_SKIP_EMPTY_LINES_Const},
-    {"FILE_APPEND", PH7_FILE_APPEND_Const},
-    {"SCANDIR_SORT_ASCENDING", PH7_SCANDIR_SORT_ASCENDING_Const},
-    {"SCANDIR_SORT_DESCENDING", PH7_SCANDIR_SORT_DESCENDING_Const},
-    {"SCANDIR_SORT_NONE", PH7_SCANDIR_SORT_NONE_Const},
-    {"GLOB_MARK", PH7_GLOB_MARK_Const},
-    {"GLOB_NOSORT", PH7_GLOB_NOSORT_Const},
-    {"GLOB_NOCHECK", PH7_GLOB_NOCHECK_Const},
-    {"GLOB_NOESCAPE", PH7_GLOB_NOESCAPE_Const},
-    {"GLOB_BRACE", PH7_GLOB_BRACE_Const},
-    {"GLOB_ONLYDIR", PH7_GLOB_ONLYDIR_Const},
-    {"GLOB_ERR", PH7_GLOB_ERR_Const},
-    {"STDIN", PH7_STDIN_Const},
-    {"stdin", PH7_STDIN_Const},
-    {"STDOUT", PH7_STDOUT_Const},
-    {"stdout", PH7_STDOUT_Const},
-    {"STDERR", PH7_STDERR_Const},
-    {"stderr", PH7_STDERR_Const},
-    {"INI_SCANNER_NORMAL", PH7_INI_SCANNER_NORMAL_Const},
-    {"INI_SCANNER_RAW", PH7_INI_SCANNER_RAW_Const},
-    {"EXTR_OVERWRITE", PH7_EXTR_OVERWRITE_Const},
-    {"EXTR_SKIP", PH7_EXTR_SKIP_Const},
-    {"EXTR_PREFIX_SAME", PH7_EXTR_PREFIX_SAME_Const},
-    {"EXTR_PREFIX_ALL", PH7_EXTR_PREFIX_ALL_Const},
-    {"EXTR_PREFIX_INVALID", PH7_EXTR_PREFIX_INVALID_Const},
-    {"EXTR_IF_EXISTS", PH7_EXTR_IF_EXISTS_Const},
-    {"EXTR_PREFIX_IF_EXISTS", PH7_EXTR_PREFIX_IF_EXISTS_Const},
+    {"DATE_ATOM", PH7_DATE_ATOM_Const, 0},
+    {"DATE_COOKIE", PH7_DATE_COOKIE_Const, 0},
+    {"DATE_ISO8601", PH7_DATE_ISO8601_Const, 0},
+    {"DATE_RFC822", PH7_DATE_RFC822_Const, 0},
+    {"DATE_RFC850", PH7_DATE_RFC850_Const, 0},
+    {"DATE_RFC1036", PH7_DATE_RFC1036_Const, 0},
+    {"DATE_RFC1123", PH7_DATE_RFC1123_Const, 0},
+    {"DATE_RFC2822", PH7_DATE_RFC2822_Const, 0},
+    {"DATE_RFC3339", PH7_DATE_ATOM_Const, 0},
+    {"DATE_RSS", PH7_DATE_RSS_Const, 0},
+    {"DATE_W3C", PH7_DATE_W3C_Const, 0},
+    {"ENT_COMPAT", PH7_ENT_COMPAT_Const, 0},
+    {"ENT_QUOTES", PH7_ENT_QUOTES_Const, 0},
+    {"ENT_NOQUOTES", PH7_ENT_NOQUOTES_Const, 0},
+    {"ENT_IGNORE", PH7_ENT_IGNORE_Const, 0},
+    {"ENT_SUBSTITUTE", PH7_ENT_SUBSTITUTE_Const, 0},
+    {"ENT_DISALLOWED", PH7_ENT_DISALLOWED_Const, 0},
+    {"ENT_HTML401", PH7_ENT_HTML401_Const, 0},
+    {"ENT_XML1", PH7_ENT_XML1_Const, 0},
+    {"ENT_XHTML", PH7_ENT_XHTML_Const, 0},
+    {"ENT_HTML5", PH7_ENT_HTML5_Const, 0},
+    {"ISO-8859-1", PH7_ISO88591_Const, 0},
+    {"ISO_8859_1", PH7_ISO88591_Const, 0},
+    {"UTF-8", PH7_UTF8_Const, 0},
+    {"UTF8", PH7_UTF8_Const, 0},
+    {"HTML_ENTITIES", PH7_HTML_ENTITIES_Const, 0},
+    {"HTML_SPECIALCHARS", PH7_HTML_SPECIALCHARS_Const, 0},
+    {"PHP_URL_SCHEME", PH7_PHP_URL_SCHEME_Const, 0},
+    {"PHP_URL_HOST", PH7_PHP_URL_HOST_Const, 0},
+    {"PHP_URL_PORT", PH7_PHP_URL_PORT_Const, 0},
+    {"PHP_URL_USER", PH7_PHP_URL_USER_Const, 0},
+    {"PHP_URL_PASS", PH7_PHP_URL_PASS_Const, 0},
+    {"PHP_URL_PATH", PH7_PHP_URL_PATH_Const, 0},
+    {"PHP_URL_QUERY", PH7_PHP_URL_QUERY_Const, 0},
+    {"PHP_URL_FRAGMENT", PH7_PHP_URL_FRAGMENT_Const, 0},
+    {"PHP_QUERY_RFC1738", PH7_PHP_QUERY_RFC1738_Const, 0},
+    {"PHP_QUERY_RFC3986", PH7_PHP_QUERY_RFC3986_Const, 0},
+    {"FNM_NOESCAPE", PH7_FNM_NOESCAPE_Const, 0},
+    {"FNM_PATHNAME", PH7_FNM_PATHNAME_Const, 0},
+    {"FNM_PERIOD", PH7_FNM_PERIOD_Const, 0},
+    {"FNM_CASEFOLD", PH7_FNM_CASEFOLD_Const, 0},
+    {"PATHINFO_DIRNAME", PH7_PATHINFO_DIRNAME_Const, 0},
+    {"PATHINFO_BASENAME", PH7_PATHINFO_BASENAME_Const, 0},
+    {"PATHINFO_EXTENSION", PH7_PATHINFO_EXTENSION_Const, 0},
+    {"PATHINFO_FILENAME", PH7_PATHINFO_FILENAME_Const, 0},
+    {"ASSERT_ACTIVE", PH7_ASSERT_ACTIVE_Const, 0},
+    {"ASSERT_WARNING", PH7_ASSERT_WARNING_Const, 0},
+    {"ASSERT_BAIL", PH7_ASSERT_BAIL_Const, 0},
+    {"ASSERT_QUIET_EVAL", PH7_ASSERT_QUIET_EVAL_Const, 0},
+    {"ASSERT_CALLBACK", PH7_ASSERT_CALLBACK_Const, 0},
+    {"SEEK_SET", PH7_SEEK_SET_Const, 0},
+    {"SEEK_CUR", PH7_SEEK_CUR_Const, 0},
+    {"SEEK_END", PH7_SEEK_END_Const, 0},
+    {"LOCK_EX", PH7_LOCK_EX_Const, 0},
+    {"LOCK_SH", PH7_LOCK_SH_Const, 0},
+    {"LOCK_NB", PH7_LOCK_NB_Const, 0},
+    {"LOCK_UN", PH7_LOCK_UN_Const, 0},
+    {"FILE_USE_INCLUDE_PATH", PH7_FILE_USE_INCLUDE_PATH_Const, 0},
+    {"FILE_IGNORE_NEW_LINES", PH7_FILE_IGNORE_NEW_LINES_Const, 0},
+    {"FILE_SKIP_EMPTY_LINES", PH7_FILE_SKIP_EMPTY_LINES_Const, 0},
+    {"FILE_APPEND", PH7_FILE_APPEND_Const, 0},
+    {"SCANDIR_SORT_ASCENDING", PH7_SCANDIR_SORT_ASCENDING_Const, 0},
+    {"SCANDIR_SORT_DESCENDING", PH7_SCANDIR_SORT_DESCENDING_Const, 0},
+    {"SCANDIR_SORT_NONE", PH7_SCANDIR_SORT_NONE_Const, 0},
+    {"GLOB_MARK", PH7_GLOB_MARK_Const, 0},
+    {"GLOB_NOSORT", PH7_GLOB_NOSORT_Const, 0},
+    {"GLOB_NOCHECK", PH7_GLOB_NOCHECK_Const, 0},
+    {"GLOB_NOESCAPE", PH7_GLOB_NOESCAPE_Const, 0},
+    {"GLOB_BRACE", PH7_GLOB_BRACE_Const, 0},
+    {"GLOB_ONLYDIR", PH7_GLOB_ONLYDIR_Const, 0},
+    {"GLOB_ERR", PH7_GLOB_ERR_Const, 0},
+    {"STDIN", PH7_STDIN_Const, 1},
+    {"stdin", PH7_STDIN_Const, 1},
+    {"STDOUT", PH7_STDOUT_Const, 1},
+    {"stdout", PH7_STDOUT_Const, 1},
+    {"STDERR", PH7_STDERR_Const, 1},
+    {"stderr", PH7_STDERR_Const, 1},
+    {"INI_SCANNER_NORMAL", PH7_INI_SCANNER_NORMAL_Const, 0},
+    {"INI_SCANNER_RAW", PH7_INI_SCANNER_RAW_Const, 0},
+    {"EXTR_OVERWRITE", PH7_EXTR_OVERWRITE_Const, 0},
+    {"EXTR_SKIP", PH7_EXTR_SKIP_Const, 0},
+    {"EXTR_PREFIX_SAME", PH7_EXTR_PREFIX_SAME_Const, 0},
+    {"EXTR_PREFIX_ALL", PH7_EXTR_PREFIX_ALL_Const, 0},
+    {"EXTR_PREFIX_INVALID", PH7_EXTR_PREFIX_INVALID_Const, 0},
+    {"EXTR_IF_EXISTS", PH7_EXTR_IF_EXISTS_Const, 0},
+    {"EXTR_PREFIX_IF_EXISTS", PH7_EXTR_PREFIX_IF_EXISTS_Const, 0},
 #ifndef PH7_DISABLE_BUILTIN_FUNC
-    {"XML_ERROR_NONE", PH7_XML_ERROR_NONE_Const},
-    {"XML_ERROR_NO_MEMORY", PH7_XML_ERROR_NO_MEMORY_Const},
-    {"XML_ERROR_SYNTAX", PH7_XML_ERROR_SYNTAX_Const},
-    {"XML_ERROR_NO_ELEMENTS", PH7_XML_ERROR_NO_ELEMENTS_Const},
-    {"XML_ERROR_INVALID_TOKEN", PH7_XML_ERROR_INVALID_TOKEN_Const},
-    {"XML_ERROR_UNCLOSED_TOKEN", PH7_XML_ERROR_UNCLOSED_TOKEN_Const},
-    {"XML_ERROR_PARTIAL_CHAR", PH7_XML_ERROR_PARTIAL_CHAR_Const},
-    {"XML_ERROR_TAG_MISMATCH", PH7_XML_ERROR_TAG_MISMATCH_Const},
-    {"XML_ERROR_DUPLICATE_ATTRIBUTE", PH7_XML_ERROR_DUPLICATE_ATTRIBUTE_Const},
-    {"XML_ERROR_JUNK_AFTER_DOC_ELEMENT", PH7_XML_ERROR_JUNK_AFTER_DOC_ELEMENT_Const},
-    {"XML_ERROR_PARAM_ENTITY_REF", PH7_XML_ERROR_PARAM_ENTITY_REF_Const},
-    {"XML_ERROR_UNDEFINED_ENTITY", PH7_XML_ERROR_UNDEFINED_ENTITY_Const},
-    {"XML_ERROR_RECURSIVE_ENTITY_REF", PH7_XML_ERROR_RECURSIVE_ENTITY_REF_Const},
-    {"XML_ERROR_ASYNC_ENTITY", PH7_XML_ERROR_ASYNC_ENTITY_Const},
-    {"XML_ERROR_BAD_CHAR_REF", PH7_XML_ERROR_BAD_CHAR_REF_Const},
-    {"XML_ERROR_BINARY_ENTITY_REF", PH7_XML_ERROR_BINARY_ENTITY_REF_Const},
-    {"XML_ERROR_ATTRIBUTE_EXTERNAL_ENTITY_REF", PH7_XML_ERROR_ATTRIBUTE_EXTERNAL_ENTITY_REF_Const},
-    {"XML_ERROR_MISPLACED_XML_PI", PH7_XML_ERROR_MISPLACED_XML_PI_Const},
-    {"XML_ERROR_UNKNOWN_ENCODING", PH7_XML_ERROR_UNKNOWN_ENCODING_Const},
-    {"XML_ERROR_INCORRECT_ENCODING", PH7_XML_ERROR_INCORRECT_ENCODING_Const},
-    {"XML_ERROR_UNCLOSED_CDATA_SECTION", PH7_XML_ERROR_UNCLOSED_CDATA_SECTION_Const},
-    {"XML_ERROR_EXTERNAL_ENTITY_HANDLING", PH7_XML_ERROR_EXTERNAL_ENTITY_HANDLING_Const},
-    {"XML_OPTION_CASE_FOLDING", PH7_XML_OPTION_CASE_FOLDING_Const},
-    {"XML_OPTION_TARGET_ENCODING", PH7_XML_OPTION_TARGET_ENCODING_Const},
-    {"XML_OPTION_SKIP_TAGSTART", PH7_XML_OPTION_SKIP_TAGSTART_Const},
-    {"XML_OPTION_SKIP_WHITE", PH7_XML_OPTION_SKIP_WHITE_Const},
-    {"XML_SAX_IMPL", PH7_XML_SAX_IMP_Const},
+    {"XML_ERROR_NONE", PH7_XML_ERROR_NONE_Const, 0},
+    {"XML_ERROR_NO_MEMORY", PH7_XML_ERROR_NO_MEMORY_Const, 0},
+    {"XML_ERROR_SYNTAX", PH7_XML_ERROR_SYNTAX_Const, 0},
+    {"XML_ERROR_NO_ELEMENTS", PH7_XML_ERROR_NO_ELEMENTS_Const, 0},
+    {"XML_ERROR_INVALID_TOKEN", PH7_XML_ERROR_INVALID_TOKEN_Const, 0},
+    {"XML_ERROR_UNCLOSED_TOKEN", PH7_XML_ERROR_UNCLOSED_TOKEN_Const, 0},
+    {"XML_ERROR_PARTIAL_CHAR", PH7_XML_ERROR_PARTIAL_CHAR_Const, 0},
+    {"XML_ERROR_TAG_MISMATCH", PH7_XML_ERROR_TAG_MISMATCH_Const, 0},
+    {"XML_ERROR_DUPLICATE_ATTRIBUTE", PH7_XML_ERROR_DUPLICATE_ATTRIBUTE_Const, 0},
+    {"XML_ERROR_JUNK_AFTER_DOC_ELEMENT", PH7_XML_ERROR_JUNK_AFTER_DOC_ELEMENT_Const, 0},
+    {"XML_ERROR_PARAM_ENTITY_REF", PH7_XML_ERROR_PARAM_ENTITY_REF_Const, 0},
+    {"XML_ERROR_UNDEFINED_ENTITY", PH7_XML_ERROR_UNDEFINED_ENTITY_Const, 0},
+    {"XML_ERROR_RECURSIVE_ENTITY_REF", PH7_XML_ERROR_RECURSIVE_ENTITY_REF_Const, 0},
+    {"XML_ERROR_ASYNC_ENTITY", PH7_XML_ERROR_ASYNC_ENTITY_Const, 0},
+    {"XML_ERROR_BAD_CHAR_REF", PH7_XML_ERROR_BAD_CHAR_REF_Const, 0},
+    {"XML_ERROR_BINARY_ENTITY_REF", PH7_XML_ERROR_BINARY_ENTITY_REF_Const, 0},
+    {"XML_ERROR_ATTRIBUTE_EXTERNAL_ENTITY_REF", PH7_XML_ERROR_ATTRIBUTE_EXTERNAL_ENTITY_REF_Const, 0},
+    {"XML_ERROR_MISPLACED_XML_PI", PH7_XML_ERROR_MISPLACED_XML_PI_Const, 0},
+    {"XML_ERROR_UNKNOWN_ENCODING", PH7_XML_ERROR_UNKNOWN_ENCODING_Const, 0},
+    {"XML_ERROR_INCORRECT_ENCODING", PH7_XML_ERROR_INCORRECT_ENCODING_Const, 0},
+    {"XML_ERROR_UNCLOSED_CDATA_SECTION", PH7_XML_ERROR_UNCLOSED_CDATA_SECTION_Const, 0},
+    {"XML_ERROR_EXTERNAL_ENTITY_HANDLING", PH7_XML_ERROR_EXTERNAL_ENTITY_HANDLING_Const, 0},
+    {"XML_OPTION_CASE_FOLDING", PH7_XML_OPTION_CASE_FOLDING_Const, 0},
+    {"XML_OPTION_TARGET_ENCODING", PH7_XML_OPTION_TARGET_ENCODING_Const, 0},
+    {"XML_OPTION_SKIP_TAGSTART", PH7_XML_OPTION_SKIP_TAGSTART_Const, 0},
+    {"XML_OPTION_SKIP_WHITE", PH7_XML_OPTION_SKIP_WHITE_Const, 0},
+    {"XML_SAX_IMPL", PH7_XML_SAX_IMP_Const, 0},
 #endif /* PH7_DISABLE_BUILTIN_FUNC */
-    {"JSON_HEX_TAG", PH7_JSON_HEX_TAG_Const},
-    {"JSON_HEX_AMP", PH7_JSON_HEX_AMP_Const},
-    {"JSON_HEX_APOS", PH7_JSON_HEX_APOS_Const},
-    {"JSON_HEX_QUOT", PH7_JSON_HEX_QUOT_Const},
-    {"JSON_FORCE_OBJECT", PH7_JSON_FORCE_OBJECT_Const},
-    {"JSON_NUMERIC_CHECK", PH7_JSON_NUMERIC_CHECK_Const},
-    {"JSON_BIGINT_AS_STRING", PH7_JSON_BIGINT_AS_STRING_Const},
-    {"JSON_PRETTY_PRINT", PH7_JSON_PRETTY_PRINT_Const},
-    {"JSON_UNESCAPED_SLASHES", PH7_JSON_UNESCAPED_SLASHES_Const},
-    {"JSON_UNESCAPED_UNICODE", PH7_JSON_UNESCAPED_UNICODE_Const},
-    {"JSON_ERROR_NONE", PH7_JSON_ERROR_NONE_Const},
-    {"JSON_ERROR_DEPTH", PH7_JSON_ERROR_DEPTH_Const},
-    {"JSON_ERROR_STATE_MISMATCH", PH7_JSON_ERROR_STATE_MISMATCH_Const},
-    {"JSON_ERROR_CTRL_CHAR", PH7_JSON_ERROR_CTRL_CHAR_Const},
-    {"JSON_ERROR_SYNTAX", PH7_JSON_ERROR_SYNTAX_Const},
-    {"JSON_ERROR_UTF8", PH7_JSON_ERROR_UTF8_Const},
-    {"static", PH7_static_Const},
-    {"self", PH7_self_Const},
-    {"__CLASS__", PH7_self_Const},
-    {"parent", PH7_parent_Const}
+    {"JSON_HEX_TAG", PH7_JSON_HEX_TAG_Const, 0},
+    {"JSON_HEX_AMP", PH7_JSON_HEX_AMP_Const, 0},
+    {"JSON_HEX_APOS", PH7_JSON_HEX_APOS_Const, 0},
+    {"JSON_HEX_QUOT", PH7_JSON_HEX_QUOT_Const, 0},
+    {"JSON_FORCE_OBJECT", PH7_JSON_FORCE_OBJECT_Const, 0},
+    {"JSON_NUMERIC_CHECK", PH7_JSON_NUMERIC_CHECK_Const, 0},
+    {"JSON_BIGINT_AS_STRING", PH7_JSON_BIGINT_AS_STRING_Const, 0},
+    {"JSON_PRETTY_PRINT", PH7_JSON_PRETTY_PRINT_Const, 0},
+    {"JSON_UNESCAPED_SLASHES", PH7_JSON_UNESCAPED_SLASHES_Const, 0},
+    {"JSON_UNESCAPED_UNICODE", PH7_JSON_UNESCAPED_UNICODE_Const, 0},
+    {"JSON_ERROR_NONE", PH7_JSON_ERROR_NONE_Const, 0},
+    {"JSON_ERROR_DEPTH", PH7_JSON_ERROR_DEPTH_Const, 0},
+    {"JSON_ERROR_STATE_MISMATCH", PH7_JSON_ERROR_STATE_MISMATCH_Const, 0},
+    {"JSON_ERROR_CTRL_CHAR", PH7_JSON_ERROR_CTRL_CHAR_Const, 0},
+    {"JSON_ERROR_SYNTAX", PH7_JSON_ERROR_SYNTAX_Const, 0},
+    {"JSON_ERROR_UTF8", PH7_JSON_ERROR_UTF8_Const, 0},
+    {"static", PH7_static_Const, 1},
+    {"self", PH7_self_Const, 1},
+    {"__CLASS__", PH7_self_Const, 1},
+    {"parent", PH7_parent_Const, 1}
 };
 
 /**
@@ -2286,8 +2286,14 @@ PH7_PRIVATE void PH7_RegisterBuiltInConstant(ph7_vm* pVm)
 {
     // Note that all built-in constants have access to the ph7 virtual machine
     // that trigger the constant invocation as their private data.
+    // Constants whose value does not depend on the running script are flagged
+    // immutable so that the compiler can inline them into the literal table.
     for (sxu32 n = 0; n < SX_ARRAYSIZE(aBuiltIn); ++n)
     {
-        ph7_create_constant(&(*pVm), aBuiltIn[n].zName, aBuiltIn[n].xExpand, &(*pVm));
+        SyString sName;
+        SyStringInitFromBuf(&sName, aBuiltIn[n].zName, SyStrlen(aBuiltIn[n].zName));
+        SyStringFullTrim(&sName);
+        PH7_VmRegisterConstant(&(*pVm), &sName, aBuiltIn[n].xExpand, &(*pVm),
+                               aBuiltIn[n].bDynamic ? 0 : PH7_CONSTANT_IMMUTABLE);
     }
 }
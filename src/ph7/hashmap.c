@@ -270,6 +270,75 @@ PH7_PRIVATE void PH7_HashmapUnlinkNode(ph7_hashmap_node* pNode, int bRestore)
 }
 
 #define HASHMAP_FILL_FACTOR 3
+/* Largest table [in buckets] allocated up front from a size hint,bigger arrays grow as usual */
+#define HASHMAP_RESERVE_MAX (1 << 20)
+
+/*
+ * Resize the hash-table to nNew buckets and rehash all entries.
+ * nNew must be a power of two.
+ */
+static sxi32 HashmapResizeBucket(ph7_hashmap* pMap, sxu32 nNew)
+{
+    ph7_hashmap_node** apOld = pMap->apBucket;
+    ph7_hashmap_node* pEntry, ** apNew;
+    sxu32 nBucket;
+    sxu32 n;
+    if (nNew < 1 || nNew > SXU32_HIGH / sizeof(ph7_hashmap_node*))
+    {
+        /* The table size in bytes would overflow,treat as an allocation failure */
+        apNew = 0;
+    }
+    else
+    {
+        /* Allocate a new bucket */
+        apNew = (ph7_hashmap_node**)SyMemBackendAlloc(&pMap->pVm->sAllocator, nNew * sizeof(ph7_hashmap_node*));
+    }
+    if (apNew == 0)
+    {
+        if (pMap->nSize < 1)
+        {
+            return SXERR_MEM; /* Fatal */
+        }
+        /* Not so fatal here,simply a performance hit */
+        return SXRET_OK;
+    }
+    /* Zero the table */
+    SyZero((void*)apNew, nNew * sizeof(ph7_hashmap_node*));
+    /* Reflect the change */
+    pMap->apBucket = apNew;
+    pMap->nSize = nNew;
+    if (apOld == 0)
+    {
+        /* First allocated table [i.e: no entry],return immediately */
+        return SXRET_OK;
+    }
+    /* Rehash old entries */
+    pEntry = pMap->pFirst;
+    n = 0;
+    for (;;)
+    {
+        if (n >= pMap->nEntry)
+        {
+            break;
+        }
+        /* Clear the old collision link */
+        pEntry->pNextCollide = pEntry->pPrevCollide = 0;
+        /* Link to the new bucket */
+        nBucket = pEntry->nHash & (nNew - 1);
+        if (pMap->apBucket[nBucket] != 0)
+        {
+            pEntry->pNextCollide = pMap->apBucket[nBucket];
+            pMap->apBucket[nBucket]->pPrevCollide = pEntry;
+        }
+        pMap->apBucket[nBucket] = pEntry;
+        /* Point to the next entry */
+        pEntry = pEntry->pPrev; /* Reverse link */
+        n++;
+    }
+    /* Free the old table */
+    SyMemBackendFree(&pMap->pVm->sAllocator, (void*)apOld);
+    return SXRET_OK;
+}
 
 /*
  * Grow the hash-table and rehash all entries.
@@ -278,63 +347,46 @@ static sxi32 HashmapGrowBucket(ph7_hashmap* pMap)
 {
     if (pMap->nEntry >= pMap->nSize * HASHMAP_FILL_FACTOR)
     {
-        ph7_hashmap_node** apOld = pMap->apBucket;
-        ph7_hashmap_node* pEntry, ** apNew;
         sxu32 nNew = pMap->nSize << 1;
-        sxu32 nBucket;
-        sxu32 n;
         if (nNew < 1)
         {
             nNew = 16;
         }
-        /* Allocate a new bucket */
-        apNew = (ph7_hashmap_node**)SyMemBackendAlloc(&pMap->pVm->sAllocator, nNew * sizeof(ph7_hashmap_node*));
-        if (apNew == 0)
-        {
-            if (pMap->nSize < 1)
-            {
-                return SXERR_MEM; /* Fatal */
-            }
-            /* Not so fatal here,simply a performance hit */
-            return SXRET_OK;
-        }
-        /* Zero the table */
-        SyZero((void*)apNew, nNew * sizeof(ph7_hashmap_node*));
-        /* Reflect the change */
-        pMap->apBucket = apNew;
-        pMap->nSize = nNew;
-        if (apOld == 0)
-        {
-            /* First allocated table [i.e: no entry],return immediately */
-            return SXRET_OK;
-        }
-        /* Rehash old entries */
-        pEntry = pMap->pFirst;
-        n = 0;
-        for (;;)
+        return HashmapResizeBucket(&(*pMap), nNew);
+    }
+    return SXRET_OK;
+}
+
+/*
+ * Make sure the hash-table is big enough to hold nEntry entries without
+ * growing again. Called when the final size of an array is known up front
+ * [i.e: array literals,array_fill(),range(),array_combine()...] so that the
+ * table is allocated once instead of being doubled and rehashed log2(n) times.
+ */
+PH7_PRIVATE sxi32 PH7_HashmapReserve(ph7_hashmap* pMap, sxu32 nEntry)
+{
+    sxu32 nNew;
+    if (pMap->pLiteral)
+    {
+        /* Literal view,copy the entries first */
+        PH7_HashmapUnshare(&(*pMap));
+    }
+    nNew = pMap->nSize > 0 ? pMap->nSize : 16;
+    while (nNew * HASHMAP_FILL_FACTOR < nEntry)
+    {
+        if (nNew >= HASHMAP_RESERVE_MAX)
         {
-            if (n >= pMap->nEntry)
-            {
-                break;
-            }
-            /* Clear the old collision link */
-            pEntry->pNextCollide = pEntry->pPrevCollide = 0;
-            /* Link to the new bucket */
-            nBucket = pEntry->nHash & (nNew - 1);
-            if (pMap->apBucket[nBucket] != 0)
-            {
-                pEntry->pNextCollide = pMap->apBucket[nBucket];
-                pMap->apBucket[nBucket]->pPrevCollide = pEntry;
-            }
-            pMap->apBucket[nBucket] = pEntry;
-            /* Point to the next entry */
-            pEntry = pEntry->pPrev; /* Reverse link */
-            n++;
+            /* Unreasonable size hint [i.e: range(0,2000000000)],let the table grow normally */
+            break;
         }
-        /* Free the old table */
-        SyMemBackendFree(&pMap->pVm->sAllocator, (void*)apOld);
+        nNew <<= 1;
     }
-    return SXRET_OK;
+    if (nNew <= pMap->nSize)
+    {
+        /* Already big enough */
+        return SXRET_OK;
+    }
+    return HashmapResizeBucket(&(*pMap), nNew);
 }
 
 /*
@@ -1008,6 +1060,7 @@ static int HashmapFindValue(
     ph7_hashmap_node* pEntry;
     ph7_value sVal, * pVal;
     ph7_value sNeedle;
+    sxi32 iNeedle, iType;
     sxi32 rc;
     sxu32 n;
     /* Perform a linear search since we cannot sort the hashmap based on values */
@@ -1015,6 +1068,65 @@ static int HashmapFindValue(
     n = pMap->nEntry;
     PH7_MemObjInit(pMap->pVm, &sVal);
     PH7_MemObjInit(pMap->pVm, &sNeedle);
+    iNeedle = pNeedle->iFlags & ~MEMOBJ_AUX;
+    if (iNeedle == MEMOBJ_INT || (bStrict && (iNeedle == MEMOBJ_REAL || iNeedle == MEMOBJ_STRING)))
+    {
+        /* Fast path: Compare values of the same type in place,without duplicating them */
+        for (; n > 0; n--)
+        {
+            pVal = HashmapExtractNodeValue(pEntry);
+            if (pVal)
+            {
+                iType = pVal->iFlags & ~MEMOBJ_AUX;
+                if (iType == iNeedle)
+                {
+                    if (iType == MEMOBJ_INT)
+                    {
+                        rc = pVal->x.iVal != pNeedle->x.iVal;
+                    }
+                    else if (iType == MEMOBJ_REAL)
+                    {
+                        rc = pVal->rVal < pNeedle->rVal || pVal->rVal > pNeedle->rVal;
+                    }
+                    else
+                    {
+                        rc = SyBlobCmp(&pVal->sBlob, &pNeedle->sBlob);
+                    }
+                    if (rc == 0)
+                    {
+                        if (ppNode)
+                        {
+                            *ppNode = pEntry;
+                        }
+                        /* Match found*/
+                        return SXRET_OK;
+                    }
+                }
+                else if (!bStrict)
+                {
+                    /* Integer needle against a value of another type,use the standard comparison */
+                    PH7_MemObjLoad(pVal, &sVal);
+                    PH7_MemObjLoad(pNeedle, &sNeedle);
+                    rc = PH7_MemObjCmp(&sNeedle, &sVal, FALSE, 0);
+                    PH7_MemObjRelease(&sVal);
+                    PH7_MemObjRelease(&sNeedle);
+                    if (rc == 0)
+                    {
+                        if (ppNode)
+                        {
+                            *ppNode = pEntry;
+                        }
+                        /* Match found*/
+                        return SXRET_OK;
+                    }
+                }
+            }
+            /* Point to the next entry */
+            pEntry = pEntry->pPrev; /* Reverse link */
+        }
+        /* No such entry */
+        return SXERR_NOTFOUND;
+    }
     for (;;)
     {
         if (n < 1)
@@ -1414,6 +1526,157 @@ PH7_PRIVATE sxi32 PH7_HashmapDup(ph7_hashmap* pSrc, ph7_hashmap* pDest)
     }
     return SXRET_OK;
 }
+/*
+ * Return a fresh copy of a constant array literal folded at compile time
+ * [i.e: $a = array('a' => 1,'b' => array(2,3))].
+ * The source map lives in the literal table and must never be visible to
+ * user code since PH7 arrays are shared by reference rather than copied on
+ * write. Nested literals are therefore copied recursively unlike
+ * PH7_HashmapDup() which share them.
+ * Keys are already unique and normalized, so nodes are linked directly
+ * without going through the key conversion and lookup of PH7_HashmapInsert().
+ */
+PH7_PRIVATE ph7_hashmap* PH7_HashmapDupLiteral(ph7_vm* pVm, ph7_hashmap* pSrc)
+{
+    ph7_hashmap_node* pEntry;
+    ph7_hashmap* pDest;
+    ph7_value sValue, * pVal;
+    sxi32 rc = SXRET_OK;
+    sxu32 n;
+    /* Allocate the target map large enough to hold all the entries */
+    pDest = PH7_NewHashmap(&(*pVm), 0, 0, pSrc->nEntry);
+    if (pDest == 0)
+    {
+        return 0;
+    }
+    pEntry = pSrc->pFirst;
+    for (n = 0; n < pSrc->nEntry; ++n)
+    {
+        /* Extract the node value.
+         * Work on a local copy since the insertion below may grow the VM memory
+         * object table where the source value lives.
+         */
+        PH7_MemObjInit(&(*pVm), &sValue);
+        pVal = HashmapExtractNodeValue(pEntry);
+        if (pVal && (pVal->iFlags & MEMOBJ_HASHMAP))
+        {
+            ph7_hashmap* pNested;
+            /* Nested literal,copy it too */
+            pNested = PH7_HashmapDupLiteral(&(*pVm), (ph7_hashmap*)pVal->x.pOther);
+            if (pNested == 0)
+            {
+                rc = SXERR_MEM;
+                break;
+            }
+            PH7_MemObjInitFromArray(&(*pVm), &sValue, pNested);
+        }
+        else if (pVal)
+        {
+            PH7_MemObjLoad(pVal, &sValue);
+        }
+        if (pEntry->iType == HASHMAP_BLOB_NODE)
+        {
+            rc = HashmapInsertBlobKey(&(*pDest), SyBlobData(&pEntry->xKey.sKey), SyBlobLength(&pEntry->xKey.sKey),
+                                      &sValue, 0, FALSE);
+        }
+        else
+        {
+            rc = HashmapInsertIntKey(&(*pDest), pEntry->xKey.iKey, &sValue, 0, FALSE);
+        }
+        /* The node hold its own copy now */
+        PH7_MemObjRelease(&sValue);
+        if (rc != SXRET_OK)
+        {
+            break;
+        }
+        /* Point to the next entry */
+        pEntry = pEntry->pPrev; /* Reverse link */
+    }
+    if (rc != SXRET_OK)
+    {
+        PH7_HashmapRelease(pDest, TRUE);
+        return 0;
+    }
+    /* Next automatic index */
+    pDest->iNextIdx = pSrc->iNextIdx;
+    return pDest;
+}
+/*
+ * Return a view of a constant array literal of scalar values
+ * [i.e: $a = array('a' => 1,'b' => 2);].
+ * The view share the entries of the literal but has its own reference count
+ * and loop cursor,so that loading the literal does not copy it. Like a fresh
+ * copy,the view is shared by reference between the variables it is assigned to.
+ * It must be turned into a regular array by PH7_HashmapUnshare() before any
+ * modification of its entries.
+ */
+PH7_PRIVATE ph7_hashmap* PH7_HashmapShareLiteral(ph7_vm* pVm, ph7_hashmap* pLiteral)
+{
+    ph7_hashmap* pMap;
+    /* Allocate a new instance */
+    pMap = (ph7_hashmap*)SyMemBackendPoolAlloc(&pVm->sAllocator, sizeof(ph7_hashmap));
+    if (pMap == 0)
+    {
+        return 0;
+    }
+    /* Point to the literal entries */
+    SyMemcpy((const void*)pLiteral, (void*)pMap, sizeof(ph7_hashmap));
+    pMap->pCur = pMap->pFirst;
+    pMap->iRef = 1;
+    pMap->iFlags = 0;
+    pMap->pLiteral = pLiteral;
+    pLiteral->iRef++;
+    return pMap;
+}
+/*
+ * Give a view created by PH7_HashmapShareLiteral() its own copy of the literal
+ * entries. The copy is made in place so that every variable holding the view
+ * see the modification that follow. This is a no-op for regular arrays.
+ */
+PH7_PRIVATE sxi32 PH7_HashmapUnshare(ph7_hashmap* pMap)
+{
+    ph7_hashmap* pLiteral = pMap->pLiteral;
+    ph7_hashmap_node* pEntry, * pNode, * pCur;
+    ph7_hashmap* pCopy;
+    sxu32 n;
+    if (pLiteral == 0)
+    {
+        /* Not a view */
+        return SXRET_OK;
+    }
+    pCopy = PH7_HashmapDupLiteral(pMap->pVm, pLiteral);
+    if (pCopy == 0)
+    {
+        PH7_VmThrowError(pMap->pVm, 0, PH7_CTX_ERR, "PH7 is running out of memory while copying array");
+        return SXERR_MEM;
+    }
+    /* Take ownership of the copied entries and move the loop cursor to the matching entry */
+    pCur = 0;
+    pEntry = pLiteral->pFirst;
+    pNode = pCopy->pFirst;
+    for (n = 0; n < pCopy->nEntry; ++n)
+    {
+        if (pEntry == pMap->pCur)
+        {
+            pCur = pNode;
+        }
+        pNode->pMap = pMap;
+        /* Point to the next entry */
+        pEntry = pEntry->pPrev; /* Reverse link */
+        pNode = pNode->pPrev;
+    }
+    pMap->pCur = pCur;
+    pMap->apBucket = pCopy->apBucket;
+    pMap->pFirst = pCopy->pFirst;
+    pMap->pLast = pCopy->pLast;
+    pMap->nSize = pCopy->nSize;
+    pMap->nEntry = pCopy->nEntry;
+    pMap->iNextIdx = pCopy->iNextIdx;
+    pMap->pLiteral = 0;
+    SyMemBackendPoolFree(&pMap->pVm->sAllocator, pCopy);
+    PH7_HashmapUnref(pLiteral);
+    return SXRET_OK;
+}
 /*
  * Perform the union of two hashmaps.
  * This operation is performed only if the user uses the '+' operator
@@ -1519,7 +1782,8 @@ PH7_PRIVATE sxi32 PH7_HashmapUnion(ph7_hashmap* pLeft, ph7_hashmap* pRight)
 PH7_PRIVATE ph7_hashmap* PH7_NewHashmap(
     ph7_vm* pVm,              /* VM that trigger the hashmap creation */
     sxu32 (* xIntHash)(sxi64), /* Hash function for int keys.NULL otherwise*/
-    sxu32 (* xBlobHash)(const void*, sxu32) /* Hash function for BLOB keys.NULL otherwise */
+    sxu32 (* xBlobHash)(const void*, sxu32), /* Hash function for BLOB keys.NULL otherwise */
+    sxu32 nHint               /* Expected number of entries if known,zero otherwise */
 )
 {
     ph7_hashmap* pMap;
@@ -1537,6 +1801,11 @@ PH7_PRIVATE ph7_hashmap* PH7_NewHashmap(
     /* Default hash functions */
     pMap->xIntHash = xIntHash ? xIntHash : IntHash;
     pMap->xBlobHash = xBlobHash ? xBlobHash : BinHash;
+    if (nHint > 0)
+    {
+        /* Presize the hash-table,failure is not fatal here */
+        PH7_HashmapReserve(pMap, nHint);
+    }
     return pMap;
 }
 /*
@@ -1579,7 +1848,7 @@ PH7_PRIVATE sxi32 PH7_HashmapCreateSuper(ph7_vm* pVm)
     sxi32 rc;
     sxu32 n;
     /* Allocate a new hashmap for the $GLOBALS array */
-    pMap = PH7_NewHashmap(&(*pVm), 0, 0);
+    pMap = PH7_NewHashmap(&(*pVm), 0, 0, 0);
     if (pMap == 0)
     {
         return SXERR_MEM;
@@ -1648,6 +1917,13 @@ PH7_PRIVATE sxi32 PH7_HashmapRelease(ph7_hashmap* pMap, int FreeDS)
         PH7_VmThrowError(pMap->pVm, 0, PH7_CTX_NOTICE, "$GLOBALS is a read-only array,deletion is forbidden");
         return SXRET_OK;
     }
+    if (pMap->pLiteral)
+    {
+        /* Shared view,the entries belong to the literal */
+        PH7_HashmapUnref(pMap->pLiteral);
+        pMap->pLiteral = 0;
+        pMap->nEntry = 0;
+    }
     /* Start the release process */
     n = 0;
     pEntry = pMap->pFirst;
@@ -1752,6 +2028,11 @@ PH7_PRIVATE sxi32 PH7_HashmapInsert(
         PH7_VmThrowError(pMap->pVm, 0, PH7_CTX_ERR, "$GLOBALS is a read-only array,insertion is forbidden");
         return SXRET_OK;
     }
+    if (pMap->pLiteral)
+    {
+        /* Literal view,copy the entries first */
+        PH7_HashmapUnshare(&(*pMap));
+    }
     rc = HashmapInsert(&(*pMap), &(*pKey), &(*pVal));
     return rc;
 }
@@ -1797,6 +2078,11 @@ PH7_PRIVATE sxi32 PH7_HashmapInsertByRef(
         PH7_VmThrowError(pMap->pVm, 0, PH7_CTX_ERR, "$GLOBALS is a read-only array,insertion is forbidden");
         return SXRET_OK;
     }
+    if (pMap->pLiteral)
+    {
+        /* Literal view,copy the entries first */
+        PH7_HashmapUnshare(&(*pMap));
+    }
     rc = HashmapInsertByRef(&(*pMap), &(*pKey), nRefIdx);
     return rc;
 }
@@ -2119,7 +2405,8 @@ static sxi32 HashmapCmpCallback2(ph7_hashmap_node* pA, ph7_hashmap_node* pB, voi
         {
             iB = pB->xKey.iKey;
         }
-        rc = (sxi32)(iA - iB);
+        /* Do not subtract, the difference may overflow a 32-bit integer */
+        rc = iA < iB ? -1 : (iA > iB ? 1 : 0);
     }
     /* Comparison result */
     return rc;
@@ -2264,7 +2551,8 @@ static sxi32 HashmapCmpCallback5(ph7_hashmap_node* pA, ph7_hashmap_node* pB, voi
         {
             iB = pB->xKey.iKey;
         }
-        rc = (sxi32)(iA - iB);
+        /* Do not subtract, the difference may overflow a 32-bit integer */
+        rc = iA < iB ? -1 : (iA > iB ? 1 : 0);
     }
     return -rc; /* Reverse result */
 }
@@ -2318,54 +2606,907 @@ static sxi32 HashmapCmpCallback6(ph7_hashmap_node* pA, ph7_hashmap_node* pB, voi
 }
 
 /*
- * Node comparison callback: Random node comparison.
- * used-by: [shuffle()]
+ * Node comparison callback: Random node comparison.
+ * used-by: [shuffle()]
+ */
+static sxi32 HashmapCmpCallback7(ph7_hashmap_node* pA, ph7_hashmap_node* pB, void* pCmpData)
+{
+    sxu32 n;
+    SXUNUSED(pB); /* cc warning */
+    SXUNUSED(pCmpData);
+    /* Grab a random number */
+    n = PH7_VmRandomNum(pA->pMap->pVm);
+    /* if the random number is odd then the first node 'pA' is greater then
+     * the second node 'pB'. Otherwise the reverse is assumed.
+     */
+    return n & 1 ? 1 : -1;
+}
+
+/*
+ * Rehash all nodes keys after a sort have been applied.
+ * Since every key is renumbered from zero, the hash bucket is rebuilt
+ * in a single pass instead of unlinking and relinking each node.
+ * Used by [sort(),usort() and rsort()].
+ */
+static void HashmapSortRehash(ph7_hashmap* pMap)
+{
+    ph7_hashmap_node* p, * pLast;
+    sxu32 nBucket;
+    sxu32 i;
+    /* Reset the hash bucket */
+    SyZero((void*)pMap->apBucket, pMap->nSize * sizeof(ph7_hashmap_node*));
+    pLast = p = pMap->pFirst;
+    pMap->iNextIdx = 0; /* Reset the automatic index */
+    for (i = 0; i < pMap->nEntry; i++)
+    {
+        if (p->iType == HASHMAP_BLOB_NODE)
+        {
+            /* Do not maintain index association as requested by the PHP specification */
+            SyBlobRelease(&p->xKey.sKey);
+            /* Change key type */
+            p->iType = HASHMAP_INT_NODE;
+        }
+        p->xKey.iKey = pMap->iNextIdx;
+        p->nHash = pMap->xIntHash(pMap->iNextIdx);
+        /* Link to the new bucket */
+        nBucket = p->nHash & (pMap->nSize - 1);
+        p->pPrevCollide = 0;
+        p->pNextCollide = pMap->apBucket[nBucket];
+        if (pMap->apBucket[nBucket])
+        {
+            pMap->apBucket[nBucket]->pPrevCollide = p;
+        }
+        pMap->apBucket[nBucket] = p;
+        /* Increment the automatic index */
+        pMap->iNextIdx++;
+        /* Point to the next entry */
+        pLast = p;
+        p = p->pPrev; /* Reverse link */
+    }
+    pMap->pLast = pLast;
+}
+
+/*
+ * Hashmap sort engine.
+ * Sorting is done on a contiguous array of nodes rather than on the linked list
+ * itself. Before sorting, each node value (or key) is cast once into a sort key
+ * [i.e: integer, real or a read-only string view]. When all keys share the same
+ * class, the array is sorted without touching a single ph7_value again:
+ *  - Integer and real keys are sorted using an LSD radix sort.
+ *  - String keys are sorted using a pattern-defeating quicksort.
+ * Mixed arrays and user supplied callbacks fall back to a merge sort that invoke
+ * the node comparison callbacks defined above.
+ * Ties are broken by the original node position, so the sort is stable.
+ */
+typedef struct HashmapSortEntry HashmapSortEntry;
+
+struct HashmapSortEntry
+{
+    ph7_hashmap_node* pNode; /* Target node */
+    union
+    {
+        sxi64 iKey;       /* Integer key */
+        ph7_real rKey;    /* Real key */
+        sxu64 uKey;       /* Radix key */
+        const char* zKey; /* String key */
+    } x;
+    sxu32 nKey;  /* String key length */
+    sxu32 nSeq;  /* Original node position [i.e: tie breaker] */
+    sxi32 iKind; /* Key class (see below) */
+};
+
+/* Sort key classes */
+#define HASHMAP_SORT_KEY_INT  1 /* 64-bit integer */
+#define HASHMAP_SORT_KEY_REAL 2 /* Floating point number */
+#define HASHMAP_SORT_KEY_STR  3 /* Non-numeric string compared as a value */
+#define HASHMAP_SORT_KEY_BLOB 4 /* String key compared as a key [i.e: length first] */
+#define HASHMAP_SORT_KEY_ANY  5 /* Anything else: use the node comparison callback */
+#define HASHMAP_SORT_KEY_RADIX 6 /* Order preserving unsigned key [i.e: converted integer or real] */
+
+/* HashmapSort() control flags */
+#define HASHMAP_SORT_BY_KEY  0x01 /* Sort by keys rather than by values */
+#define HASHMAP_SORT_DESC    0x02 /* Reverse order */
+#define HASHMAP_SORT_USER    0x04 /* User-defined comparison callback */
+#define HASHMAP_SORT_SHUFFLE 0x08 /* Random order */
+
+/* Arrays smaller than this are sorted using the comparison sort */
+#define HASHMAP_SORT_RADIX_MIN  128
+/* Partitions smaller than this are sorted using insertion sort */
+#define HASHMAP_SORT_INSERTION  24
+/* Partitions larger than this use the ninther as pivot */
+#define HASHMAP_SORT_NINTHER    128
+/* Maximum number of moves in a partial insertion sort */
+#define HASHMAP_SORT_PARTIAL    8
+
+/* Sort key comparison callback signature */
+typedef sxi32 (* ProcSortKeyCmp)(const HashmapSortEntry*, const HashmapSortEntry*);
+
+/*
+ * Classify a node value and extract its sort key.
+ * The comparison rules are the ones of [PH7_MemObjCmp()] applied on
+ * the values cast by the sort flags [i.e: SORT_REGULAR,SORT_NUMERIC,SORT_STRING].
+ */
+static void HashmapSortValueKey(ph7_value* pValue, sxi32 iCmpFlags, ph7_value* pWorker, HashmapSortEntry* pEntry)
+{
+    pEntry->iKind = HASHMAP_SORT_KEY_ANY;
+    if (pValue == 0 || (pValue->iFlags & (MEMOBJ_HASHMAP | MEMOBJ_OBJ | MEMOBJ_RES)))
+    {
+        /* Complex value */
+        return;
+    }
+    if (iCmpFlags == 0 /* SORT_REGULAR */ || iCmpFlags == 5 /* SORT_STRING */ )
+    {
+        if (pValue->iFlags & MEMOBJ_STRING)
+        {
+            if (!PH7_MemObjIsNumeric(pValue))
+            {
+                /* Non-numeric strings are compared using memcmp() */
+                pEntry->iKind = HASHMAP_SORT_KEY_STR;
+                pEntry->x.zKey = (const char*)SyBlobData(&pValue->sBlob);
+                pEntry->nKey = SyBlobLength(&pValue->sBlob);
+                return;
+            }
+            /* Numeric strings are compared numerically */
+        }
+        else if (pValue->iFlags & MEMOBJ_INT)
+        {
+            /* An integer cast to string looks like an integer */
+            pEntry->iKind = HASHMAP_SORT_KEY_INT;
+            pEntry->x.iKey = pValue->x.iVal;
+            return;
+        }
+        else if (iCmpFlags == 5 || (pValue->iFlags & MEMOBJ_REAL) == 0)
+        {
+            /* Booleans and NULL are compared as booleans while reals cast to string may lose precision */
+            return;
+        }
+    }
+    /* Numeric cast */
+    PH7_MemObjLoad(pValue, pWorker);
+    PH7_MemObjToNumeric(pWorker);
+    if (pWorker->iFlags & MEMOBJ_INT)
+    {
+        pEntry->iKind = HASHMAP_SORT_KEY_INT;
+        pEntry->x.iKey = pWorker->x.iVal;
+    }
+    else if (pWorker->iFlags & MEMOBJ_REAL)
+    {
+        ph7_real r = pWorker->rVal;
+        if (r == r /* Not a NaN */ )
+        {
+            pEntry->iKind = HASHMAP_SORT_KEY_REAL;
+            /* Zero is zero whatever its sign */
+            pEntry->x.rKey = r == 0 ? 0 : r;
+        }
+    }
+    PH7_MemObjRelease(pWorker);
+}
+
+/*
+ * Classify a node key and extract its sort key.
+ * The comparison rules are the ones of [HashmapCmpCallback2()].
+ */
+static void HashmapSortNodeKey(ph7_hashmap_node* pNode, HashmapSortEntry* pEntry)
+{
+    if (pNode->iType == HASHMAP_INT_NODE)
+    {
+        pEntry->iKind = HASHMAP_SORT_KEY_INT;
+        pEntry->x.iKey = pNode->xKey.iKey;
+    }
+    else
+    {
+        pEntry->iKind = HASHMAP_SORT_KEY_BLOB;
+        pEntry->x.zKey = (const char*)SyBlobData(&pNode->xKey.sKey);
+        pEntry->nKey = SyBlobLength(&pNode->xKey.sKey);
+    }
+}
+
+/*
+ * Sort key comparison callbacks.
+ */
+static sxi32 HashmapSortRadixCmp(const HashmapSortEntry* pA, const HashmapSortEntry* pB)
+{
+    return pA->x.uKey < pB->x.uKey ? -1 : (pA->x.uKey > pB->x.uKey ? 1 : 0);
+}
+
+/* Same semantic as the string comparison performed by [PH7_MemObjCmp()] */
+static sxi32 HashmapSortStrCmp(const HashmapSortEntry* pA, const HashmapSortEntry* pB)
+{
+    sxi32 rc;
+    rc = SyMemcmp((const void*)pA->x.zKey, (const void*)pB->x.zKey, SXMIN(pA->nKey, pB->nKey));
+    if (rc == 0 && pA->nKey != pB->nKey)
+    {
+        rc = pA->nKey < pB->nKey ? -1 : 1;
+    }
+    return rc;
+}
+
+/* Same semantic as [SyBlobCmp()] */
+static sxi32 HashmapSortBlobCmp(const HashmapSortEntry* pA, const HashmapSortEntry* pB)
+{
+    if (pA->nKey != pB->nKey)
+    {
+        return pA->nKey < pB->nKey ? -1 : 1;
+    }
+    if (pA->nKey == 0)
+    {
+        return 0;
+    }
+    return SyMemcmp((const void*)pA->x.zKey, (const void*)pB->x.zKey, pA->nKey);
+}
+
+/*
+ * Sort context for the comparison sort.
+ */
+typedef struct HashmapSortCtx HashmapSortCtx;
+
+struct HashmapSortCtx
+{
+    ProcSortKeyCmp xCmp; /* Key comparison callback */
+    int bDesc;           /* TRUE for reverse order */
+};
+
+/*
+ * Strict ordering used by the comparison sort.
+ * Equal keys are ordered by their original position.
+ */
+static int HashmapSortLess(HashmapSortCtx* pCtx, const HashmapSortEntry* pA, const HashmapSortEntry* pB)
+{
+    sxi32 rc = pCtx->xCmp(pA, pB);
+    if (rc == 0)
+    {
+        return pA->nSeq < pB->nSeq;
+    }
+    return pCtx->bDesc ? rc > 0 : rc < 0;
+}
+
+static void HashmapSortSwap(HashmapSortEntry* pA, HashmapSortEntry* pB)
+{
+    HashmapSortEntry sTmp = *pA;
+    *pA = *pB;
+    *pB = sTmp;
+}
+
+/* Sort three entries in place */
+static void HashmapSort3(HashmapSortCtx* pCtx, HashmapSortEntry* pA, HashmapSortEntry* pB, HashmapSortEntry* pC)
+{
+    if (HashmapSortLess(pCtx, pB, pA))
+    {
+        HashmapSortSwap(pA, pB);
+    }
+    if (HashmapSortLess(pCtx, pC, pB))
+    {
+        HashmapSortSwap(pB, pC);
+        if (HashmapSortLess(pCtx, pB, pA))
+        {
+            HashmapSortSwap(pA, pB);
+        }
+    }
+}
+
+static void HashmapInsertionSort(HashmapSortCtx* pCtx, HashmapSortEntry* aEntry, sxu32 nEntry)
+{
+    HashmapSortEntry sTmp;
+    sxu32 i, j;
+    for (i = 1; i < nEntry; i++)
+    {
+        if (!HashmapSortLess(pCtx, &aEntry[i], &aEntry[i - 1]))
+        {
+            continue;
+        }
+        sTmp = aEntry[i];
+        j = i;
+        do
+        {
+            aEntry[j] = aEntry[j - 1];
+            j--;
+        } while (j > 0 && HashmapSortLess(pCtx, &sTmp, &aEntry[j - 1]));
+        aEntry[j] = sTmp;
+    }
+}
+
+/*
+ * Insertion sort that gives up after a few moves.
+ * Return TRUE if the partition was successfully sorted.
+ */
+static int HashmapPartialInsertionSort(HashmapSortCtx* pCtx, HashmapSortEntry* aEntry, sxu32 nEntry)
+{
+    HashmapSortEntry sTmp;
+    sxu32 nMove = 0;
+    sxu32 i, j;
+    for (i = 1; i < nEntry; i++)
+    {
+        if (!HashmapSortLess(pCtx, &aEntry[i], &aEntry[i - 1]))
+        {
+            continue;
+        }
+        sTmp = aEntry[i];
+        j = i;
+        do
+        {
+            aEntry[j] = aEntry[j - 1];
+            j--;
+        } while (j > 0 && HashmapSortLess(pCtx, &sTmp, &aEntry[j - 1]));
+        aEntry[j] = sTmp;
+        nMove += i - j;
+        if (nMove > HASHMAP_SORT_PARTIAL)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static void HashmapSiftDown(HashmapSortCtx* pCtx, HashmapSortEntry* aEntry, sxu32 nRoot, sxu32 nEntry)
+{
+    sxu32 nChild;
+    for (;;)
+    {
+        nChild = 2 * nRoot + 1;
+        if (nChild >= nEntry)
+        {
+            break;
+        }
+        if (nChild + 1 < nEntry && HashmapSortLess(pCtx, &aEntry[nChild], &aEntry[nChild + 1]))
+        {
+            nChild++;
+        }
+        if (!HashmapSortLess(pCtx, &aEntry[nRoot], &aEntry[nChild]))
+        {
+            break;
+        }
+        HashmapSortSwap(&aEntry[nRoot], &aEntry[nChild]);
+        nRoot = nChild;
+    }
+}
+
+/* Worst case fallback of the pattern-defeating quicksort */
+static void HashmapHeapSort(HashmapSortCtx* pCtx, HashmapSortEntry* aEntry, sxu32 nEntry)
+{
+    sxu32 i;
+    for (i = nEntry / 2; i > 0; i--)
+    {
+        HashmapSiftDown(pCtx, aEntry, i - 1, nEntry);
+    }
+    for (i = nEntry - 1; i > 0; i--)
+    {
+        HashmapSortSwap(&aEntry[0], &aEntry[i]);
+        HashmapSiftDown(pCtx, aEntry, 0, i);
+    }
+}
+
+/*
+ * Partition the entries around the pivot stored in aEntry[0].
+ * Return the final pivot position and set *pSorted to TRUE if
+ * the entries were already partitioned.
+ * The median-of-three pivot selection guarantee that the scanning loops
+ * below stay in bounds.
+ */
+static sxu32 HashmapPartition(HashmapSortCtx* pCtx, HashmapSortEntry* aEntry, sxu32 nEntry, int* pSorted)
+{
+    HashmapSortEntry sPivot = aEntry[0];
+    sxu32 iFirst = 0, iLast = nEntry;
+    while (HashmapSortLess(pCtx, &aEntry[++iFirst], &sPivot));
+    if (iFirst == 1)
+    {
+        while (iFirst < iLast && !HashmapSortLess(pCtx, &aEntry[--iLast], &sPivot));
+    }
+    else
+    {
+        while (!HashmapSortLess(pCtx, &aEntry[--iLast], &sPivot));
+    }
+    *pSorted = iFirst >= iLast;
+    while (iFirst < iLast)
+    {
+        HashmapSortSwap(&aEntry[iFirst], &aEntry[iLast]);
+        while (HashmapSortLess(pCtx, &aEntry[++iFirst], &sPivot));
+        while (!HashmapSortLess(pCtx, &aEntry[--iLast], &sPivot));
+    }
+    /* Put the pivot in the right place */
+    aEntry[0] = aEntry[iFirst - 1];
+    aEntry[iFirst - 1] = sPivot;
+    return iFirst - 1;
+}
+
+/*
+ * Pattern-defeating quicksort.
+ * Based on the algorithm by Orson Peters <https://github.com/orlp/pdqsort>.
+ * Status: zlib license.
+ * Since keys never compare equal [i.e: ties are broken by position], the
+ * equal-elements partitioning of the original algorithm is not needed.
+ */
+static void HashmapQuickSort(HashmapSortCtx* pCtx, HashmapSortEntry* aEntry, sxu32 nEntry, sxu32 nBadAllowed)
+{
+    sxu32 nLeft, nRight, nHalf;
+    sxu32 iPivot;
+    int bSorted;
+    for (;;)
+    {
+        if (nEntry < HASHMAP_SORT_INSERTION)
+        {
+            HashmapInsertionSort(pCtx, aEntry, nEntry);
+            return;
+        }
+        /* Choose the pivot */
+        nHalf = nEntry / 2;
+        if (nEntry > HASHMAP_SORT_NINTHER)
+        {
+            HashmapSort3(pCtx, &aEntry[0], &aEntry[nHalf], &aEntry[nEntry - 1]);
+            HashmapSort3(pCtx, &aEntry[1], &aEntry[nHalf - 1], &aEntry[nEntry - 2]);
+            HashmapSort3(pCtx, &aEntry[2], &aEntry[nHalf + 1], &aEntry[nEntry - 3]);
+            HashmapSort3(pCtx, &aEntry[nHalf - 1], &aEntry[nHalf], &aEntry[nHalf + 1]);
+            HashmapSortSwap(&aEntry[0], &aEntry[nHalf]);
+        }
+        else
+        {
+            HashmapSort3(pCtx, &aEntry[nHalf], &aEntry[0], &aEntry[nEntry - 1]);
+        }
+        iPivot = HashmapPartition(pCtx, aEntry, nEntry, &bSorted);
+        nLeft = iPivot;
+        nRight = nEntry - (iPivot + 1);
+        if (nLeft < nEntry / 8 || nRight < nEntry / 8)
+        {
+            /* Highly unbalanced partition */
+            if (--nBadAllowed == 0)
+            {
+                HashmapHeapSort(pCtx, aEntry, nEntry);
+                return;
+            }
+            /* Break patterns that defeat the pivot selection */
+            if (nLeft >= HASHMAP_SORT_INSERTION)
+            {
+                HashmapSortSwap(&aEntry[0], &aEntry[nLeft / 4]);
+                HashmapSortSwap(&aEntry[iPivot - 1], &aEntry[iPivot - nLeft / 4]);
+            }
+            if (nRight >= HASHMAP_SORT_INSERTION)
+            {
+                HashmapSortSwap(&aEntry[iPivot + 1], &aEntry[iPivot + 1 + nRight / 4]);
+                HashmapSortSwap(&aEntry[nEntry - 1], &aEntry[nEntry - nRight / 4]);
+            }
+        }
+        else if (bSorted && HashmapPartialInsertionSort(pCtx, aEntry, nLeft)
+                 && HashmapPartialInsertionSort(pCtx, &aEntry[iPivot + 1], nRight))
+        {
+            /* Already sorted */
+            return;
+        }
+        /* Recurse on the smaller partition,loop on the larger one */
+        if (nLeft < nRight)
+        {
+            HashmapQuickSort(pCtx, aEntry, nLeft, nBadAllowed);
+            aEntry = &aEntry[iPivot + 1];
+            nEntry = nRight;
+        }
+        else
+        {
+            HashmapQuickSort(pCtx, &aEntry[iPivot + 1], nRight, nBadAllowed);
+            nEntry = nLeft;
+        }
+    }
+}
+
+/*
+ * Convert integer and real keys into unsigned keys that sort in the same order.
+ */
+static void HashmapSortRadixKeys(HashmapSortEntry* aEntry, sxu32 nEntry, int bDesc)
+{
+    static const sxu64 nSign = (sxu64)1 << 63;
+    sxu64 uKey;
+    sxu32 i;
+    for (i = 0; i < nEntry; i++)
+    {
+        if (aEntry[i].iKind == HASHMAP_SORT_KEY_REAL)
+        {
+#ifdef PH7_OMIT_FLOATING_POINT
+            uKey = (sxu64)aEntry[i].x.rKey ^ nSign;
+#else
+            /* IEEE-754: Flip all the bits of negative numbers and the sign bit of positive ones */
+            SyMemcpy((const void*)&aEntry[i].x.rKey, (void*)&uKey, sizeof(sxu64));
+            uKey = (uKey & nSign) ? ~uKey : (uKey | nSign);
+#endif
+        }
+        else
+        {
+            uKey = aEntry[i].x.uKey ^ nSign;
+        }
+        /* Complement the keys for reverse order so the sort stay stable */
+        aEntry[i].x.uKey = bDesc ? ~uKey : uKey;
+        aEntry[i].iKind = HASHMAP_SORT_KEY_RADIX;
+    }
+}
+
+/*
+ * LSD radix sort on 64-bit unsigned keys.
+ * Passes where all the keys share the same digit are skipped.
+ * Return a pointer to the sorted entries [i.e: either aEntry or aTmp].
+ */
+static HashmapSortEntry* HashmapRadixSort(HashmapSortEntry* aEntry, HashmapSortEntry* aTmp, sxu32 nEntry, sxu32* aCount)
+{
+    HashmapSortEntry* pSwap;
+    sxu32 nSum, nDigit;
+    sxu32 i, iPass;
+    /* Compute the histograms of the eight digits in a single pass */
+    SyZero((void*)aCount, 8 * 256 * sizeof(sxu32));
+    for (i = 0; i < nEntry; i++)
+    {
+        sxu64 uKey = aEntry[i].x.uKey;
+        for (iPass = 0; iPass < 8; iPass++)
+        {
+            aCount[iPass * 256 + ((uKey >> (iPass * 8)) & 0xFF)]++;
+        }
+    }
+    for (iPass = 0; iPass < 8; iPass++)
+    {
+        sxu32* pCount = &aCount[iPass * 256];
+        if (pCount[(aEntry[0].x.uKey >> (iPass * 8)) & 0xFF] == nEntry)
+        {
+            /* All keys share this digit */
+            continue;
+        }
+        /* Prefix sum */
+        nSum = 0;
+        for (i = 0; i < 256; i++)
+        {
+            nDigit = pCount[i];
+            pCount[i] = nSum;
+            nSum += nDigit;
+        }
+        /* Scatter */
+        for (i = 0; i < nEntry; i++)
+        {
+            aTmp[pCount[(aEntry[i].x.uKey >> (iPass * 8)) & 0xFF]++] = aEntry[i];
+        }
+        pSwap = aEntry;
+        aEntry = aTmp;
+        aTmp = pSwap;
+    }
+    return aEntry;
+}
+
+/*
+ * Sort entries that share the same key class.
+ * Return a pointer to the sorted entries [i.e: either aEntry or aTmp].
+ */
+static HashmapSortEntry* HashmapSortKeys(HashmapSortCtx* pCtx, HashmapSortEntry* aEntry, HashmapSortEntry* aTmp, sxu32 nEntry)
+{
+    sxu32 nBadAllowed = 1;
+    sxu32 i;
+    if (pCtx->xCmp == HashmapSortRadixCmp && nEntry >= HASHMAP_SORT_RADIX_MIN)
+    {
+        sxu32 aCount[8 * 256];
+        return HashmapRadixSort(aEntry, aTmp, nEntry, aCount);
+    }
+    /* Allow log2(n) bad partitions before switching to heapsort */
+    for (i = nEntry; i > 1; i >>= 1)
+    {
+        nBadAllowed++;
+    }
+    HashmapQuickSort(pCtx, aEntry, nEntry, nBadAllowed);
+    return aEntry;
+}
+
+#ifdef PH7_ENABLE_THREADS
+/*
+ * Parallel sort.
+ * The entries are split into one run per thread,each run is sorted independently
+ * and the sorted runs are then merged pairwise,one merge per thread,until a single
+ * run is left. Only entries that share the same key class are sorted this way,so
+ * worker threads never touch a ph7_value nor the VM memory backend.
+ */
+typedef struct HashmapSortTask HashmapSortTask;
+
+struct HashmapSortTask
+{
+    HashmapSortCtx* pCtx;     /* Key comparison context */
+    HashmapSortEntry* aEntry; /* Run to sort or runs to merge */
+    HashmapSortEntry* aTmp;   /* Scratch area or merge destination */
+    sxu32 nLeft;              /* Entries in the first run */
+    sxu32 nRight;             /* Entries in the second run [merge only] */
+};
+
+/* Minimum number of entries sorted by a single thread */
+#define HASHMAP_SORT_THREAD_MIN 4096
+
+static void HashmapSortRunTask(void* pArg)
+{
+    HashmapSortTask* pTask = (HashmapSortTask*)pArg;
+    HashmapSortEntry* aSorted;
+    aSorted = HashmapSortKeys(pTask->pCtx, pTask->aEntry, pTask->aTmp, pTask->nLeft);
+    if (aSorted != pTask->aEntry)
+    {
+        /* Keep the sorted run in place */
+        SyMemcpy((const void*)aSorted, (void*)pTask->aEntry, pTask->nLeft * sizeof(HashmapSortEntry));
+    }
+}
+
+static void HashmapSortMergeTask(void* pArg)
+{
+    HashmapSortTask* pTask = (HashmapSortTask*)pArg;
+    HashmapSortEntry* pLeft = pTask->aEntry, * pLeftEnd = &pTask->aEntry[pTask->nLeft];
+    HashmapSortEntry* pRight = pLeftEnd, * pRightEnd = &pLeftEnd[pTask->nRight];
+    HashmapSortEntry* pOut = pTask->aTmp;
+    while (pLeft < pLeftEnd && pRight < pRightEnd)
+    {
+        if (HashmapSortLess(pTask->pCtx, pRight, pLeft))
+        {
+            *pOut++ = *pRight++;
+        }
+        else
+        {
+            *pOut++ = *pLeft++;
+        }
+    }
+    while (pLeft < pLeftEnd)
+    {
+        *pOut++ = *pLeft++;
+    }
+    while (pRight < pRightEnd)
+    {
+        *pOut++ = *pRight++;
+    }
+}
+
+static HashmapSortEntry* HashmapParallelSort(
+    HashmapSortCtx* pCtx,
+    HashmapSortEntry* aEntry,
+    HashmapSortEntry* aTmp,
+    sxu32 nEntry,
+    sxu32 nThread
+)
+{
+    HashmapSortTask aTask[PH7_SORT_THREAD_MAX];
+    sxu32 aBound[PH7_SORT_THREAD_MAX + 1];
+    HashmapSortEntry* pSwap;
+    sxu32 nRun, nTask;
+    sxu32 i;
+    if (nThread > PH7_SORT_THREAD_MAX)
+    {
+        nThread = PH7_SORT_THREAD_MAX;
+    }
+    if (nThread > nEntry / HASHMAP_SORT_THREAD_MIN)
+    {
+        nThread = nEntry / HASHMAP_SORT_THREAD_MIN;
+    }
+    if (nThread < 2)
+    {
+        /* Not worth it */
+        return HashmapSortKeys(pCtx, aEntry, aTmp, nEntry);
+    }
+    /* Split into runs of equal length */
+    nRun = nThread;
+    for (i = 0; i <= nRun; i++)
+    {
+        aBound[i] = (sxu32)(((sxu64)nEntry * i) / nRun);
+    }
+    for (i = 0; i < nRun; i++)
+    {
+        aTask[i].pCtx = pCtx;
+        aTask[i].aEntry = &aEntry[aBound[i]];
+        aTask[i].aTmp = &aTmp[aBound[i]];
+        aTask[i].nLeft = aBound[i + 1] - aBound[i];
+        aTask[i].nRight = 0;
+    }
+    SyThreadRunTasks(HashmapSortRunTask, (void*)aTask, sizeof(HashmapSortTask), nRun);
+    /* Merge the sorted runs pairwise */
+    while (nRun > 1)
+    {
+        nTask = 0;
+        for (i = 0; i < nRun; i += 2)
+        {
+            aTask[nTask].pCtx = pCtx;
+            aTask[nTask].aEntry = &aEntry[aBound[i]];
+            aTask[nTask].aTmp = &aTmp[aBound[i]];
+            aTask[nTask].nLeft = aBound[i + 1] - aBound[i];
+            /* An odd run is simply copied */
+            aTask[nTask].nRight = i + 1 < nRun ? aBound[i + 2] - aBound[i + 1] : 0;
+            aBound[nTask++] = aBound[i];
+        }
+        aBound[nTask] = nEntry;
+        SyThreadRunTasks(HashmapSortMergeTask, (void*)aTask, sizeof(HashmapSortTask), nTask);
+        pSwap = aEntry;
+        aEntry = aTmp;
+        aTmp = pSwap;
+        nRun = nTask;
+    }
+    return aEntry;
+}
+#endif /* PH7_ENABLE_THREADS */
+
+/*
+ * Stable merge sort using a node comparison callback.
+ * Used for mixed arrays and user-defined comparison callbacks.
+ * Return a pointer to the sorted entries [i.e: either aEntry or aTmp].
  */
-static sxi32 HashmapCmpCallback7(ph7_hashmap_node* pA, ph7_hashmap_node* pB, void* pCmpData)
+static HashmapSortEntry* HashmapCallbackSort(
+    HashmapSortEntry* aEntry,
+    HashmapSortEntry* aTmp,
+    sxu32 nEntry,
+    ProcNodeCmp xCmp,
+    void* pCmpData
+)
 {
-    sxu32 n;
-    SXUNUSED(pB); /* cc warning */
-    SXUNUSED(pCmpData);
-    /* Grab a random number */
-    n = PH7_VmRandomNum(pA->pMap->pVm);
-    /* if the random number is odd then the first node 'pA' is greater then
-     * the second node 'pB'. Otherwise the reverse is assumed.
-     */
-    return n & 1 ? 1 : -1;
+    HashmapSortEntry* pSwap;
+    sxu32 nWidth, iLeft, iMid, iRight;
+    sxu32 i, j, k;
+    for (nWidth = 1; nWidth < nEntry; nWidth <<= 1)
+    {
+        for (iLeft = 0; iLeft < nEntry; iLeft += 2 * nWidth)
+        {
+            iMid = SXMIN(iLeft + nWidth, nEntry);
+            iRight = SXMIN(iLeft + 2 * nWidth, nEntry);
+            i = iLeft;
+            j = iMid;
+            k = iLeft;
+            while (i < iMid && j < iRight)
+            {
+                if (xCmp(aEntry[j].pNode, aEntry[i].pNode, pCmpData) < 0)
+                {
+                    aTmp[k++] = aEntry[j++];
+                }
+                else
+                {
+                    aTmp[k++] = aEntry[i++];
+                }
+            }
+            while (i < iMid)
+            {
+                aTmp[k++] = aEntry[i++];
+            }
+            while (j < iRight)
+            {
+                aTmp[k++] = aEntry[j++];
+            }
+        }
+        pSwap = aEntry;
+        aEntry = aTmp;
+        aTmp = pSwap;
+    }
+    return aEntry;
 }
 
 /*
- * Rehash all nodes keys after a merge-sort have been applied.
- * Used by [sort(),usort() and rsort()].
+ * Sort a hashmap.
+ * xCmp is the node comparison callback used for mixed arrays,user-defined
+ * callbacks or when the sort buffer cannot be allocated.
+ * The linked list is rebuilt in the sorted order,keys are left untouched.
  */
-static void HashmapSortRehash(ph7_hashmap* pMap)
+static sxi32 HashmapSort(ph7_hashmap* pMap, ProcNodeCmp xCmp, void* pCmpData, sxi32 iFlags)
 {
-    ph7_hashmap_node* p, * pLast;
+    SyMemBackend* pAllocator = &pMap->pVm->sAllocator;
+    HashmapSortEntry* aEntry, * aSorted;
+    ph7_hashmap_node* pNode;
+    sxu32 nEntry = pMap->nEntry;
+    sxi32 iKind;
     sxu32 i;
-    /* Rehash all entries */
-    pLast = p = pMap->pFirst;
-    pMap->iNextIdx = 0; /* Reset the automatic index */
-    i = 0;
-    for (;;)
+    /* Allocate the sort buffer [i.e: entries plus a scratch area] */
+    aEntry = (HashmapSortEntry*)SyMemBackendAlloc(pAllocator, 2 * nEntry * sizeof(HashmapSortEntry));
+    if (aEntry == 0)
     {
-        if (i >= pMap->nEntry)
+        /* Not so fatal here,simply a performance hit */
+        HashmapMergeSort(&(*pMap), xCmp, pCmpData);
+        /* Fix the last link broken by the merge */
+        while (pMap->pLast->pPrev)
         {
-            pMap->pLast = pLast; /* Fix the last link broken by the merge-sort */
-            break;
+            pMap->pLast = pMap->pLast->pPrev;
         }
-        if (p->iType == HASHMAP_BLOB_NODE)
+        return SXRET_OK;
+    }
+    /* Collect the nodes */
+    pNode = pMap->pFirst;
+    for (i = 0; i < nEntry; i++)
+    {
+        aEntry[i].pNode = pNode;
+        aEntry[i].nSeq = i;
+        aEntry[i].iKind = HASHMAP_SORT_KEY_ANY;
+        pNode = pNode->pPrev; /* Reverse link */
+    }
+    aSorted = aEntry;
+    if (iFlags & HASHMAP_SORT_SHUFFLE)
+    {
+        /* Fisher-Yates shuffle */
+        for (i = nEntry - 1; i > 0; i--)
         {
-            /* Do not maintain index association as requested by the PHP specification */
-            SyBlobRelease(&p->xKey.sKey);
-            /* Change key type */
-            p->iType = HASHMAP_INT_NODE;
+            HashmapSortSwap(&aEntry[i], &aEntry[PH7_VmRandomNum(pMap->pVm) % (i + 1)]);
         }
-        HashmapRehashIntNode(p);
-        /* Point to the next entry */
-        i++;
-        pLast = p;
-        p = p->pPrev; /* Reverse link */
     }
+    else
+    {
+        iKind = HASHMAP_SORT_KEY_ANY;
+        if ((iFlags & HASHMAP_SORT_USER) == 0)
+        {
+            ph7_value sWorker;
+            sxi32 iCmpFlags = SX_PTR_TO_INT(pCmpData);
+            sxu32 nMask = 0;
+            /* Extract the sort keys and collect their classes */
+            PH7_MemObjInit(pMap->pVm, &sWorker);
+            for (i = 0; i < nEntry; i++)
+            {
+                if (iFlags & HASHMAP_SORT_BY_KEY)
+                {
+                    HashmapSortNodeKey(aEntry[i].pNode, &aEntry[i]);
+                }
+                else
+                {
+                    HashmapSortValueKey(HashmapExtractNodeValue(aEntry[i].pNode), iCmpFlags, &sWorker, &aEntry[i]);
+                }
+                nMask |= 1 << aEntry[i].iKind;
+                if (aEntry[i].iKind == HASHMAP_SORT_KEY_ANY)
+                {
+                    break;
+                }
+            }
+            PH7_MemObjRelease(&sWorker);
+            if (nMask == (1 << HASHMAP_SORT_KEY_INT) || nMask == (1 << HASHMAP_SORT_KEY_REAL)
+                || nMask == (1 << HASHMAP_SORT_KEY_STR) || nMask == (1 << HASHMAP_SORT_KEY_BLOB))
+            {
+                /* All keys share the same class */
+                iKind = aEntry[0].iKind;
+            }
+            else if (nMask == ((1 << HASHMAP_SORT_KEY_INT) | (1 << HASHMAP_SORT_KEY_REAL)))
+            {
+                /* Integers mixed with reals are compared as reals */
+                static const sxi64 nExact = (sxi64)1 << 53;
+                iKind = HASHMAP_SORT_KEY_REAL;
+                for (i = 0; i < nEntry; i++)
+                {
+                    if (aEntry[i].iKind == HASHMAP_SORT_KEY_INT)
+                    {
+                        if (aEntry[i].x.iKey > nExact || aEntry[i].x.iKey < -nExact)
+                        {
+                            /* Cannot be represented exactly,compare using the callback */
+                            iKind = HASHMAP_SORT_KEY_ANY;
+                            break;
+                        }
+                        aEntry[i].iKind = HASHMAP_SORT_KEY_REAL;
+                        aEntry[i].x.rKey = (ph7_real)aEntry[i].x.iKey;
+                    }
+                }
+            }
+        }
+        if (iKind == HASHMAP_SORT_KEY_ANY)
+        {
+            /* Mixed types or user-defined callback */
+            aSorted = HashmapCallbackSort(aEntry, &aEntry[nEntry], nEntry, xCmp, pCmpData);
+        }
+        else
+        {
+            HashmapSortCtx sCtx;
+            sCtx.bDesc = iFlags & HASHMAP_SORT_DESC;
+            if (iKind == HASHMAP_SORT_KEY_INT || iKind == HASHMAP_SORT_KEY_REAL)
+            {
+                /* Order is now encoded in the keys */
+                HashmapSortRadixKeys(aEntry, nEntry, sCtx.bDesc);
+                iKind = HASHMAP_SORT_KEY_RADIX;
+                sCtx.bDesc = FALSE;
+            }
+            sCtx.xCmp = iKind == HASHMAP_SORT_KEY_RADIX ? HashmapSortRadixCmp :
+                        (iKind == HASHMAP_SORT_KEY_STR ? HashmapSortStrCmp : HashmapSortBlobCmp);
+#ifdef PH7_ENABLE_THREADS
+            if (pMap->pVm->nSortThread > 1 && nEntry >= pMap->pVm->nSortThreshold)
+            {
+                aSorted = HashmapParallelSort(&sCtx, aEntry, &aEntry[nEntry], nEntry, pMap->pVm->nSortThread);
+            }
+            else
+#endif
+            {
+                aSorted = HashmapSortKeys(&sCtx, aEntry, &aEntry[nEntry], nEntry);
+            }
+        }
+    }
+    /* Rebuild the linked list in the sorted order */
+    for (i = 0; i < nEntry; i++)
+    {
+        pNode = aSorted[i].pNode;
+        pNode->pNext = i > 0 ? aSorted[i - 1].pNode : 0;
+        pNode->pPrev = i + 1 < nEntry ? aSorted[i + 1].pNode : 0; /* Reverse link */
+    }
+    pMap->pFirst = aSorted[0].pNode;
+    pMap->pLast = aSorted[nEntry - 1].pNode;
+    /* Reset the loop cursor */
+    pMap->pCur = pMap->pFirst;
+    /* Release the sort buffer */
+    SyMemBackendFree(pAllocator, (void*)aEntry);
+    return SXRET_OK;
 }
 /*
  * Array functions implementation.
@@ -2415,8 +3556,8 @@ static int ph7_hashmap_sort(ph7_context* pCtx, int nArg, ph7_value** apArg)
                 iCmpFlags = 0; /* Standard comparison */
             }
         }
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, HashmapCmpCallback1, SX_INT_TO_PTR(iCmpFlags));
+        /* Sort the array */
+        HashmapSort(pMap, HashmapCmpCallback1, SX_INT_TO_PTR(iCmpFlags), 0);
         /* Rehash [Do not maintain index association as requested by the PHP specification] */
         HashmapSortRehash(pMap);
     }
@@ -2464,13 +3605,8 @@ static int ph7_hashmap_asort(ph7_context* pCtx, int nArg, ph7_value** apArg)
                 iCmpFlags = 0; /* Standard comparison */
             }
         }
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, HashmapCmpCallback1, SX_INT_TO_PTR(iCmpFlags));
-        /* Fix the last link broken by the merge */
-        while (pMap->pLast->pPrev)
-        {
-            pMap->pLast = pMap->pLast->pPrev;
-        }
+        /* Sort the array */
+        HashmapSort(pMap, HashmapCmpCallback1, SX_INT_TO_PTR(iCmpFlags), 0);
     }
     /* All done,return TRUE */
     ph7_result_bool(pCtx, 1);
@@ -2516,13 +3652,8 @@ static int ph7_hashmap_arsort(ph7_context* pCtx, int nArg, ph7_value** apArg)
                 iCmpFlags = 0; /* Standard comparison */
             }
         }
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, HashmapCmpCallback3, SX_INT_TO_PTR(iCmpFlags));
-        /* Fix the last link broken by the merge */
-        while (pMap->pLast->pPrev)
-        {
-            pMap->pLast = pMap->pLast->pPrev;
-        }
+        /* Sort the array */
+        HashmapSort(pMap, HashmapCmpCallback3, SX_INT_TO_PTR(iCmpFlags), HASHMAP_SORT_DESC);
     }
     /* All done,return TRUE */
     ph7_result_bool(pCtx, 1);
@@ -2568,13 +3699,8 @@ static int ph7_hashmap_ksort(ph7_context* pCtx, int nArg, ph7_value** apArg)
                 iCmpFlags = 0; /* Standard comparison */
             }
         }
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, HashmapCmpCallback2, SX_INT_TO_PTR(iCmpFlags));
-        /* Fix the last link broken by the merge */
-        while (pMap->pLast->pPrev)
-        {
-            pMap->pLast = pMap->pLast->pPrev;
-        }
+        /* Sort the array */
+        HashmapSort(pMap, HashmapCmpCallback2, SX_INT_TO_PTR(iCmpFlags), HASHMAP_SORT_BY_KEY);
     }
     /* All done,return TRUE */
     ph7_result_bool(pCtx, 1);
@@ -2620,13 +3746,8 @@ static int ph7_hashmap_krsort(ph7_context* pCtx, int nArg, ph7_value** apArg)
                 iCmpFlags = 0; /* Standard comparison */
             }
         }
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, HashmapCmpCallback5, SX_INT_TO_PTR(iCmpFlags));
-        /* Fix the last link broken by the merge */
-        while (pMap->pLast->pPrev)
-        {
-            pMap->pLast = pMap->pLast->pPrev;
-        }
+        /* Sort the array */
+        HashmapSort(pMap, HashmapCmpCallback5, SX_INT_TO_PTR(iCmpFlags), HASHMAP_SORT_BY_KEY | HASHMAP_SORT_DESC);
     }
     /* All done,return TRUE */
     ph7_result_bool(pCtx, 1);
@@ -2672,8 +3793,8 @@ static int ph7_hashmap_rsort(ph7_context* pCtx, int nArg, ph7_value** apArg)
                 iCmpFlags = 0; /* Standard comparison */
             }
         }
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, HashmapCmpCallback3, SX_INT_TO_PTR(iCmpFlags));
+        /* Sort the array */
+        HashmapSort(pMap, HashmapCmpCallback3, SX_INT_TO_PTR(iCmpFlags), HASHMAP_SORT_DESC);
         /* Rehash [Do not maintain index association as requested by the PHP specification] */
         HashmapSortRehash(pMap);
     }
@@ -2723,8 +3844,8 @@ static int ph7_hashmap_usort(ph7_context* pCtx, int nArg, ph7_value** apArg)
             /* Use the default comparison function */
             xCmp = HashmapCmpCallback1;
         }
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, xCmp, pCallback);
+        /* Sort the array */
+        HashmapSort(pMap, xCmp, pCallback, pCallback ? HASHMAP_SORT_USER : 0);
         /* Rehash [Do not maintain index association as requested by the PHP specification] */
         HashmapSortRehash(pMap);
     }
@@ -2775,13 +3896,8 @@ static int ph7_hashmap_uasort(ph7_context* pCtx, int nArg, ph7_value** apArg)
             /* Use the default comparison function */
             xCmp = HashmapCmpCallback1;
         }
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, xCmp, pCallback);
-        /* Fix the last link broken by the merge */
-        while (pMap->pLast->pPrev)
-        {
-            pMap->pLast = pMap->pLast->pPrev;
-        }
+        /* Sort the array */
+        HashmapSort(pMap, xCmp, pCallback, pCallback ? HASHMAP_SORT_USER : 0);
     }
     /* All done,return TRUE */
     ph7_result_bool(pCtx, 1);
@@ -2830,13 +3946,8 @@ static int ph7_hashmap_uksort(ph7_context* pCtx, int nArg, ph7_value** apArg)
             /* Use the default comparison function */
             xCmp = HashmapCmpCallback2;
         }
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, xCmp, pCallback);
-        /* Fix the last link broken by the merge */
-        while (pMap->pLast->pPrev)
-        {
-            pMap->pLast = pMap->pLast->pPrev;
-        }
+        /* Sort the array */
+        HashmapSort(pMap, xCmp, pCallback, pCallback ? HASHMAP_SORT_USER : HASHMAP_SORT_BY_KEY);
     }
     /* All done,return TRUE */
     ph7_result_bool(pCtx, 1);
@@ -2867,13 +3978,8 @@ static int ph7_hashmap_shuffle(ph7_context* pCtx, int nArg, ph7_value** apArg)
     pMap = (ph7_hashmap*)apArg[0]->x.pOther;
     if (pMap->nEntry > 1)
     {
-        /* Do the merge sort */
-        HashmapMergeSort(pMap, HashmapCmpCallback7, 0);
-        /* Fix the last link broken by the merge */
-        while (pMap->pLast->pPrev)
-        {
-            pMap->pLast = pMap->pLast->pPrev;
-        }
+        /* Shuffle the array */
+        HashmapSort(pMap, HashmapCmpCallback7, 0, HASHMAP_SORT_SHUFFLE);
     }
     /* All done,return TRUE */
     ph7_result_bool(pCtx, 1);
@@ -3503,6 +4609,12 @@ static int ph7_hashmap_range(ph7_context* pCtx, int nArg, ph7_value** apArg)
         ph7_result_null(pCtx);
         return PH7_OK;
     }
+    if (iOfft <= iLimit)
+    {
+        /* Presize the array,the number of elements is known up front */
+        sxu64 nCount = ((sxu64)iLimit - (sxu64)iOfft) / (sxu64)iStep + 1;
+        ph7_array_reserve(pArray, nCount > SXU32_HIGH ? SXU32_HIGH : (unsigned int)nCount);
+    }
     /* Start filling */
     while (iOfft <= iLimit)
     {
@@ -3557,6 +4669,8 @@ static int ph7_hashmap_values(ph7_context* pCtx, int nArg, ph7_value** apArg)
         ph7_result_null(pCtx);
         return PH7_OK;
     }
+    /* Presize the array */
+    ph7_array_reserve(pArray, pMap->nEntry);
     /* Perform the requested operation */
     pNode = pMap->pFirst;
     for (n = 0; n < pMap->nEntry; ++n)
@@ -5155,6 +6269,11 @@ static int ph7_hashmap_fill(ph7_context* pCtx, int nArg, ph7_value** apArg)
     }
     /* Total number of entries to insert */
     nEntry = ph7_value_to_int(apArg[1]);
+    if (nEntry > 1)
+    {
+        /* Presize the array */
+        ph7_array_reserve(pArray, (unsigned int)nEntry);
+    }
     /* Insert the first entry alone because it have it's own key */
     ph7_array_add_intkey_elem(pArray, ph7_value_to_int(apArg[0]), apArg[2]);
     /* Repeat insertion of the desired value */
@@ -5206,6 +6325,8 @@ static int ph7_hashmap_fill_keys(ph7_context* pCtx, int nArg, ph7_value** apArg)
         ph7_result_null(pCtx);
         return PH7_OK;
     }
+    /* Presize the array */
+    ph7_array_reserve(pArray, pSrc->nEntry);
     /* Perform the requested operation */
     pEntry = pSrc->pFirst;
     for (n = 0; n < pSrc->nEntry; n++)
@@ -5267,6 +6388,8 @@ static int ph7_hashmap_combine(ph7_context* pCtx, int nArg, ph7_value** apArg)
         ph7_result_bool(pCtx, 0);
         return PH7_OK;
     }
+    /* Presize the array */
+    ph7_array_reserve(pArray, pKey->nEntry);
     /* Perform the requested operation */
     pKe = pKey->pFirst;
     pVe = pValue->pFirst;
@@ -5327,6 +6450,8 @@ static int ph7_hashmap_reverse(ph7_context* pCtx, int nArg, ph7_value** apArg)
         ph7_result_null(pCtx);
         return PH7_OK;
     }
+    /* Presize the array */
+    ph7_array_reserve(pArray, pSrc->nEntry);
     /* Perform the requested operation */
     pEntry = pSrc->pLast;
     for (n = 0; n < pSrc->nEntry; n++)
@@ -5453,6 +6578,8 @@ static int ph7_hashmap_flip(ph7_context* pCtx, int nArg, ph7_value** apArg)
         ph7_result_null(pCtx);
         return PH7_OK;
     }
+    /* Presize the array [i.e: duplicate values may end up with fewer entries] */
+    ph7_array_reserve(pArray, pSrc->nEntry);
     /* Start processing */
     pEntry = pSrc->pFirst;
     for (n = 0; n < pSrc->nEntry; n++)
@@ -5488,85 +6615,207 @@ static int ph7_hashmap_flip(ph7_context* pCtx, int nArg, ph7_value** apArg)
 }
 
 /*
- * number array_sum(array $array )
- *  Calculate the sum of values in an array.
- * Parameters
- *  $array: The input array.
- * Return
- *  Returns the sum of values as an integer or float.
+ * Numeric kernels used by [array_sum(),array_product()].
+ * Node values are first cast and gathered into a contiguous block of native
+ * integers or doubles. The block is then reduced by a tight loop that does not
+ * touch the hashmap nor the VM memory object container (SSE2/AVX2 when the
+ * target support it).
  */
-static void DoubleSum(ph7_context* pCtx, ph7_hashmap* pMap)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Number of values gathered before a kernel is invoked */
+#define HASHMAP_KERNEL_BLOCK 256
+
+/*
+ * Gather up to HASHMAP_KERNEL_BLOCK node values cast to 64-bit integers.
+ * NULL,empty strings,arrays,objects and resources are skipped as a plain
+ * loop over the entries would do. *pLeft is the number of entries not yet
+ * visited,it is decremented for each visited entry and *ppEntry is advanced
+ * accordingly. Return the number of gathered values.
+ */
+static sxu32 HashmapGatherInt64(ph7_hashmap_node** ppEntry, sxu32* pLeft, sxi64* aBlock)
 {
-    ph7_hashmap_node* pEntry;
+    ph7_hashmap_node* pEntry = *ppEntry;
+    sxu32 nLeft = *pLeft;
     ph7_value* pObj;
-    double dSum = 0;
-    sxu32 n;
-    pEntry = pMap->pFirst;
-    for (n = 0; n < pMap->nEntry; n++)
+    sxu32 n = 0;
+    while (nLeft > 0 && n < HASHMAP_KERNEL_BLOCK)
     {
         pObj = HashmapExtractNodeValue(pEntry);
         if (pObj && (pObj->iFlags & (MEMOBJ_NULL | MEMOBJ_HASHMAP | MEMOBJ_OBJ | MEMOBJ_RES)) == 0)
         {
             if (pObj->iFlags & MEMOBJ_REAL)
             {
-                dSum += pObj->rVal;
+                aBlock[n++] = (sxi64)pObj->rVal;
             }
             else if (pObj->iFlags & (MEMOBJ_INT | MEMOBJ_BOOL))
             {
-                dSum += (double)pObj->x.iVal;
+                aBlock[n++] = pObj->x.iVal;
             }
-            else if (pObj->iFlags & MEMOBJ_STRING)
+            else if ((pObj->iFlags & MEMOBJ_STRING) && SyBlobLength(&pObj->sBlob) > 0)
             {
-                if (SyBlobLength(&pObj->sBlob) > 0)
-                {
-                    double dv = 0;
-                    SyStrToReal((const char*)SyBlobData(&pObj->sBlob), SyBlobLength(&pObj->sBlob), (void*)&dv, 0);
-                    dSum += dv;
-                }
+                aBlock[n] = 0;
+                SyStrToInt64((const char*)SyBlobData(&pObj->sBlob), SyBlobLength(&pObj->sBlob), (void*)&aBlock[n], 0);
+                n++;
             }
         }
         /* Point to the next entry */
         pEntry = pEntry->pPrev; /* Reverse link */
+        nLeft--;
     }
-    /* Return sum */
-    ph7_result_double(pCtx, dSum);
+    *ppEntry = pEntry;
+    *pLeft = nLeft;
+    return n;
 }
 
-static void Int64Sum(ph7_context* pCtx, ph7_hashmap* pMap)
+/*
+ * Gather up to HASHMAP_KERNEL_BLOCK node values cast to doubles.
+ * NULL,empty strings,arrays,objects and resources are skipped as a plain
+ * loop over the entries would do. *pLeft is the number of entries not yet
+ * visited,it is decremented for each visited entry and *ppEntry is advanced
+ * accordingly. Return the number of gathered values.
+ */
+static sxu32 HashmapGatherDouble(ph7_hashmap_node** ppEntry, sxu32* pLeft, double* aBlock)
 {
-    ph7_hashmap_node* pEntry;
+    ph7_hashmap_node* pEntry = *ppEntry;
+    sxu32 nLeft = *pLeft;
     ph7_value* pObj;
-    sxi64 nSum = 0;
-    sxu32 n;
-    pEntry = pMap->pFirst;
-    for (n = 0; n < pMap->nEntry; n++)
+    sxu32 n = 0;
+    while (nLeft > 0 && n < HASHMAP_KERNEL_BLOCK)
     {
         pObj = HashmapExtractNodeValue(pEntry);
         if (pObj && (pObj->iFlags & (MEMOBJ_NULL | MEMOBJ_HASHMAP | MEMOBJ_OBJ | MEMOBJ_RES)) == 0)
         {
             if (pObj->iFlags & MEMOBJ_REAL)
             {
-                nSum += (sxi64)pObj->rVal;
+                aBlock[n++] = pObj->rVal;
             }
             else if (pObj->iFlags & (MEMOBJ_INT | MEMOBJ_BOOL))
             {
-                nSum += pObj->x.iVal;
+                aBlock[n++] = (double)pObj->x.iVal;
             }
-            else if (pObj->iFlags & MEMOBJ_STRING)
+            else if ((pObj->iFlags & MEMOBJ_STRING) && SyBlobLength(&pObj->sBlob) > 0)
             {
-                if (SyBlobLength(&pObj->sBlob) > 0)
-                {
-                    sxi64 nv = 0;
-                    SyStrToInt64((const char*)SyBlobData(&pObj->sBlob), SyBlobLength(&pObj->sBlob), (void*)&nv, 0);
-                    nSum += nv;
-                }
+                aBlock[n] = 0;
+                SyStrToReal((const char*)SyBlobData(&pObj->sBlob), SyBlobLength(&pObj->sBlob), (void*)&aBlock[n], 0);
+                n++;
             }
         }
         /* Point to the next entry */
         pEntry = pEntry->pPrev; /* Reverse link */
+        nLeft--;
+    }
+    *ppEntry = pEntry;
+    *pLeft = nLeft;
+    return n;
+}
+
+/*
+ * Sum a block of 64-bit integers.
+ * Integer overflow wraps around,so the additions can be performed in any order.
+ */
+static sxu64 HashmapKernelInt64Sum(const sxi64* aBlock, sxu32 nBlock)
+{
+    sxu64 nSum = 0;
+    sxu32 n = 0;
+#if defined(__AVX2__)
+    __m256i vSum = _mm256_setzero_si256();
+    sxu64 aLane[4];
+    for (; n + 4 <= nBlock; n += 4)
+    {
+        vSum = _mm256_add_epi64(vSum, _mm256_loadu_si256((const __m256i*)&aBlock[n]));
+    }
+    _mm256_storeu_si256((__m256i*)aLane, vSum);
+    nSum = aLane[0] + aLane[1] + aLane[2] + aLane[3];
+#elif defined(__SSE2__)
+    __m128i vSum = _mm_setzero_si128();
+    sxu64 aLane[2];
+    for (; n + 2 <= nBlock; n += 2)
+    {
+        vSum = _mm_add_epi64(vSum, _mm_loadu_si128((const __m128i*)&aBlock[n]));
+    }
+    _mm_storeu_si128((__m128i*)aLane, vSum);
+    nSum = aLane[0] + aLane[1];
+#endif
+    for (; n < nBlock; n++)
+    {
+        nSum += (sxu64)aBlock[n];
+    }
+    return nSum;
+}
+
+/*
+ * Multiply a block of 64-bit integers.
+ * There is no 64-bit SIMD multiplication before AVX-512,so four independent
+ * products are kept instead. Overflow wraps around as with the sum above.
+ */
+static sxu64 HashmapKernelInt64Prod(const sxi64* aBlock, sxu32 nBlock)
+{
+    sxu64 aProd[4] = {1, 1, 1, 1};
+    sxu32 n = 0;
+    for (; n + 4 <= nBlock; n += 4)
+    {
+        aProd[0] *= (sxu64)aBlock[n];
+        aProd[1] *= (sxu64)aBlock[n + 1];
+        aProd[2] *= (sxu64)aBlock[n + 2];
+        aProd[3] *= (sxu64)aBlock[n + 3];
+    }
+    for (; n < nBlock; n++)
+    {
+        aProd[0] *= (sxu64)aBlock[n];
+    }
+    return aProd[0] * aProd[1] * aProd[2] * aProd[3];
+}
+
+/*
+ * number array_sum(array $array )
+ *  Calculate the sum of values in an array.
+ * Parameters
+ *  $array: The input array.
+ * Return
+ *  Returns the sum of values as an integer or float.
+ */
+static void DoubleSum(ph7_context* pCtx, ph7_hashmap* pMap)
+{
+    double aBlock[HASHMAP_KERNEL_BLOCK];
+    ph7_hashmap_node* pEntry;
+    double dSum = 0;
+    sxu32 nLeft, nBlock;
+    sxu32 n;
+    pEntry = pMap->pFirst;
+    nLeft = pMap->nEntry;
+    while (nLeft > 0)
+    {
+        nBlock = HashmapGatherDouble(&pEntry, &nLeft, aBlock);
+        /* Sum in order so that rounding does not depend on the block size */
+        for (n = 0; n < nBlock; n++)
+        {
+            dSum += aBlock[n];
+        }
+    }
+    /* Return sum */
+    ph7_result_double(pCtx, dSum);
+}
+
+static void Int64Sum(ph7_context* pCtx, ph7_hashmap* pMap)
+{
+    sxi64 aBlock[HASHMAP_KERNEL_BLOCK];
+    ph7_hashmap_node* pEntry;
+    sxu64 nSum = 0;
+    sxu32 nLeft, nBlock;
+    pEntry = pMap->pFirst;
+    nLeft = pMap->nEntry;
+    while (nLeft > 0)
+    {
+        nBlock = HashmapGatherInt64(&pEntry, &nLeft, aBlock);
+        nSum += HashmapKernelInt64Sum(aBlock, nBlock);
     }
     /* Return sum */
-    ph7_result_int64(pCtx, nSum);
+    ph7_result_int64(pCtx, (sxi64)nSum);
 }
 
 /* number array_sum(array $array )
@@ -5626,37 +6875,21 @@ static int ph7_hashmap_sum(ph7_context* pCtx, int nArg, ph7_value** apArg)
  */
 static void DoubleProd(ph7_context* pCtx, ph7_hashmap* pMap)
 {
+    double aBlock[HASHMAP_KERNEL_BLOCK];
     ph7_hashmap_node* pEntry;
-    ph7_value* pObj;
-    double dProd;
+    double dProd = 1;
+    sxu32 nLeft, nBlock;
     sxu32 n;
     pEntry = pMap->pFirst;
-    dProd = 1;
-    for (n = 0; n < pMap->nEntry; n++)
+    nLeft = pMap->nEntry;
+    while (nLeft > 0)
     {
-        pObj = HashmapExtractNodeValue(pEntry);
-        if (pObj && (pObj->iFlags & (MEMOBJ_NULL | MEMOBJ_HASHMAP | MEMOBJ_OBJ | MEMOBJ_RES)) == 0)
+        nBlock = HashmapGatherDouble(&pEntry, &nLeft, aBlock);
+        /* Multiply in order so that rounding does not depend on the block size */
+        for (n = 0; n < nBlock; n++)
         {
-            if (pObj->iFlags & MEMOBJ_REAL)
-            {
-                dProd *= pObj->rVal;
-            }
-            else if (pObj->iFlags & (MEMOBJ_INT | MEMOBJ_BOOL))
-            {
-                dProd *= (double)pObj->x.iVal;
-            }
-            else if (pObj->iFlags & MEMOBJ_STRING)
-            {
-                if (SyBlobLength(&pObj->sBlob) > 0)
-                {
-                    double dv = 0;
-                    SyStrToReal((const char*)SyBlobData(&pObj->sBlob), SyBlobLength(&pObj->sBlob), (void*)&dv, 0);
-                    dProd *= dv;
-                }
-            }
+            dProd *= aBlock[n];
         }
-        /* Point to the next entry */
-        pEntry = pEntry->pPrev; /* Reverse link */
     }
     /* Return product */
     ph7_result_double(pCtx, dProd);
@@ -5664,40 +6897,19 @@ static void DoubleProd(ph7_context* pCtx, ph7_hashmap* pMap)
 
 static void Int64Prod(ph7_context* pCtx, ph7_hashmap* pMap)
 {
+    sxi64 aBlock[HASHMAP_KERNEL_BLOCK];
     ph7_hashmap_node* pEntry;
-    ph7_value* pObj;
-    sxi64 nProd;
-    sxu32 n;
+    sxu64 nProd = 1;
+    sxu32 nLeft, nBlock;
     pEntry = pMap->pFirst;
-    nProd = 1;
-    for (n = 0; n < pMap->nEntry; n++)
+    nLeft = pMap->nEntry;
+    while (nLeft > 0)
     {
-        pObj = HashmapExtractNodeValue(pEntry);
-        if (pObj && (pObj->iFlags & (MEMOBJ_NULL | MEMOBJ_HASHMAP | MEMOBJ_OBJ | MEMOBJ_RES)) == 0)
-        {
-            if (pObj->iFlags & MEMOBJ_REAL)
-            {
-                nProd *= (sxi64)pObj->rVal;
-            }
-            else if (pObj->iFlags & (MEMOBJ_INT | MEMOBJ_BOOL))
-            {
-                nProd *= pObj->x.iVal;
-            }
-            else if (pObj->iFlags & MEMOBJ_STRING)
-            {
-                if (SyBlobLength(&pObj->sBlob) > 0)
-                {
-                    sxi64 nv = 0;
-                    SyStrToInt64((const char*)SyBlobData(&pObj->sBlob), SyBlobLength(&pObj->sBlob), (void*)&nv, 0);
-                    nProd *= nv;
-                }
-            }
-        }
-        /* Point to the next entry */
-        pEntry = pEntry->pPrev; /* Reverse link */
+        nBlock = HashmapGatherInt64(&pEntry, &nLeft, aBlock);
+        nProd *= HashmapKernelInt64Prod(aBlock, nBlock);
     }
     /* Return product */
-    ph7_result_int64(pCtx, nProd);
+    ph7_result_int64(pCtx, (sxi64)nProd);
 }
 
 /* number array_product(array $array )
@@ -5871,7 +7083,7 @@ static int ph7_hashmap_rand(ph7_context* pCtx, int nArg, ph7_value** apArg)
             nItem--;
         }
         /* Shuffle the array */
-        HashmapMergeSort(pDest, HashmapCmpCallback7, 0);
+        HashmapSort(pDest, HashmapCmpCallback7, 0, HASHMAP_SORT_SHUFFLE);
         /* Rehash node */
         HashmapSortRehash(pDest);
         /* Return the random array */
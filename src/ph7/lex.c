@@ -39,6 +39,88 @@
  */
 #include <ph7/ph7int.h>
 
+/*
+ * Character classes used by the tokenizers.
+ * Each input byte is classified with a single table lookup instead of the
+ * locale aware ctype routines. Bytes above 0x7F (UTF-8 streams) have no class.
+ */
+#define LEX_CLASS_SPACE   0x01 /* White space [i.e: ' ','\t','\n','\v','\f','\r'] */
+#define LEX_CLASS_DIGIT   0x02 /* Decimal digit */
+#define LEX_CLASS_ALPHA   0x04 /* ASCII letter */
+#define LEX_CLASS_IDENT   0x08 /* Identifier character [i.e: letter,digit,'_'] */
+#define LEX_CLASS_HEX     0x10 /* Hexadecimal digit */
+#define LEX_CLASS_SSTR    0x20 /* Stops a single quoted string body scan ['\'','\n'] */
+#define LEX_CLASS_DSTR    0x40 /* Stops a double quoted string body scan ['"','{','\n'] */
+#define LEX_CLASS_CHUNK   0x80 /* Stops a PHP chunk scan ['?','/','\n','<'] */
+static const unsigned char aLexClass[256] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xe1, 0x01, 0x01, 0x01, 0x00, 0x00,  /* 0x00 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 0x10 */
+    0x01, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80,  /* 0x20 */
+    0x1a, 0x1a, 0x1a, 0x1a, 0x1a, 0x1a, 0x1a, 0x1a, 0x1a, 0x1a, 0x00, 0x00, 0x80, 0x00, 0x00, 0x80,  /* 0x30 */
+    0x00, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c,  /* 0x40 */
+    0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x08,  /* 0x50 */
+    0x00, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c,  /* 0x60 */
+    0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x40, 0x00, 0x00, 0x00, 0x00,  /* 0x70 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 0x80 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 0x90 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 0xA0 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 0xB0 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 0xC0 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 0xD0 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 0xE0 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00   /* 0xF0 */
+};
+#define LexClass(c, m)    (aLexClass[(unsigned char)(c)] & (m))
+#define LexIsSpace(c)     LexClass(c, LEX_CLASS_SPACE)
+#define LexIsDigit(c)     LexClass(c, LEX_CLASS_DIGIT)
+#define LexIsAlpha(c)     LexClass(c, LEX_CLASS_ALPHA)
+#define LexIsIdent(c)     LexClass(c, LEX_CLASS_IDENT)
+#define LexIsHex(c)       LexClass(c, LEX_CLASS_HEX)
+/*
+ * Long runs of raw text,comments and string bodies are scanned eight bytes
+ * at a time. A word holds one of the searched bytes if XORing it with the
+ * byte replicated in each lane leaves a zero lane.
+ */
+#define LEX_WORD_ONES     ((sxu64)0x0101010101010101u)
+#define LEX_WORD_HIGHS    ((sxu64)0x8080808080808080u)
+#define LEX_WORD_HAS_ZERO(W) (((W) - LEX_WORD_ONES) & ~(W) & LEX_WORD_HIGHS)
+
+/*
+ * Return a pointer to the first occurrence of c1 or c2 in the given range
+ * or zEnd when neither byte is found.
+ */
+static const unsigned char* LexFindByte2(const unsigned char* zIn, const unsigned char* zEnd, int c1, int c2)
+{
+    sxu64 m1 = LEX_WORD_ONES * (sxu8)c1;
+    sxu64 m2 = LEX_WORD_ONES * (sxu8)c2;
+    /* Align the cursor on a word boundary */
+    while (zIn < zEnd && ((sxuptr)zIn & (sizeof(sxu64) - 1)) != 0)
+    {
+        if (zIn[0] == c1 || zIn[0] == c2)
+        {
+            return zIn;
+        }
+        zIn++;
+    }
+    /* Word at a time */
+    while ((sxu32)(zEnd - zIn) >= sizeof(sxu64))
+    {
+        sxu64 w = *(const sxu64*)zIn;
+        if (LEX_WORD_HAS_ZERO(w ^ m1) | LEX_WORD_HAS_ZERO(w ^ m2))
+        {
+            break;
+        }
+        zIn += sizeof(sxu64);
+    }
+    /* Locate the byte within the last word */
+    while (zIn < zEnd && zIn[0] != c1 && zIn[0] != c2)
+    {
+        zIn++;
+    }
+    return zIn;
+}
+#define LexFindByte(zIn, zEnd, c) LexFindByte2(zIn, zEnd, c, c)
+
 static sxu32 KeywordCode(const char* z, int n);
 
 static sxi32 LexExtractHeredoc(SyStream* pStream, SyToken* pToken);
@@ -53,7 +135,7 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
     SyString* pStr;
     sxi32 rc;
     /* Ignore leading white spaces */
-    while (pStream->zText < pStream->zEnd && pStream->zText[0] < 0xc0 && SyisSpace(pStream->zText[0]))
+    while (pStream->zText < pStream->zEnd && LexIsSpace(pStream->zText[0]))
     {
         /* Advance the stream cursor */
         if (pStream->zText[0] == '\n')
@@ -73,7 +155,7 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
     pToken->pUserData = 0;
     pStr = &pToken->sData;
     SyStringInitFromBuf(pStr, pStream->zText, 0);
-    if (pStream->zText[0] >= 0xc0 || SyisAlpha(pStream->zText[0]) || pStream->zText[0] == '_')
+    if (pStream->zText[0] >= 0xc0 || LexIsAlpha(pStream->zText[0]) || pStream->zText[0] == '_')
     {
         /* The following code fragment is taken verbatim from the xPP source tree.
          * xPP is a modern embeddable macro processor with advanced features useful for
@@ -102,7 +184,7 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
                 }
             }
             /* Skip alphanumeric stream */
-            while (zIn < pStream->zEnd && zIn[0] < 0xc0 && (SyisAlphaNum(zIn[0]) || zIn[0] == '_'))
+            while (zIn < pStream->zEnd && LexIsIdent(zIn[0]))
             {
                 zIn++;
             }
@@ -154,10 +236,7 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
         {
             pStream->zText++;
             /* Inline comments */
-            while (pStream->zText < pStream->zEnd && pStream->zText[0] != '\n')
-            {
-                pStream->zText++;
-            }
+            pStream->zText = LexFindByte(pStream->zText, pStream->zEnd, '\n');
             /* Tell the upper-layer to ignore this token */
             return SXERR_CONTINUE;
         }
@@ -167,6 +246,11 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
             /* Block comment */
             while (pStream->zText < pStream->zEnd)
             {
+                pStream->zText = LexFindByte2(pStream->zText, pStream->zEnd, '*', '\n');
+                if (pStream->zText >= pStream->zEnd)
+                {
+                    break;
+                }
                 if (pStream->zText[0] == '*')
                 {
                     if (&pStream->zText[1] >= pStream->zEnd || pStream->zText[1] == '/')
@@ -184,11 +268,11 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
             /* Tell the upper-layer to ignore this token */
             return SXERR_CONTINUE;
         }
-        else if (SyisDigit(pStream->zText[0]))
+        else if (LexIsDigit(pStream->zText[0]))
         {
             pStream->zText++;
             /* Decimal digit stream */
-            while (pStream->zText < pStream->zEnd && pStream->zText[0] < 0xc0 && SyisDigit(pStream->zText[0]))
+            while (pStream->zText < pStream->zEnd && LexIsDigit(pStream->zText[0]))
             {
                 pStream->zText++;
             }
@@ -201,8 +285,7 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
                 {
                     /* Real number */
                     pStream->zText++;
-                    while (pStream->zText < pStream->zEnd && pStream->zText[0] < 0xc0 &&
-                           SyisDigit(pStream->zText[0]))
+                    while (pStream->zText < pStream->zEnd && LexIsDigit(pStream->zText[0]))
                     {
                         pStream->zText++;
                     }
@@ -216,12 +299,11 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
                             {
                                 c = pStream->zText[0];
                                 if ((c == '+' || c == '-') && &pStream->zText[1] < pStream->zEnd &&
-                                    pStream->zText[1] < 0xc0 && SyisDigit(pStream->zText[1]))
+                                    LexIsDigit(pStream->zText[1]))
                                 {
                                     pStream->zText++;
                                 }
-                                while (pStream->zText < pStream->zEnd && pStream->zText[0] < 0xc0 &&
-                                       SyisDigit(pStream->zText[0]))
+                                while (pStream->zText < pStream->zEnd && LexIsDigit(pStream->zText[0]))
                                 {
                                     pStream->zText++;
                                 }
@@ -239,12 +321,11 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
                     {
                         c = pStream->zText[0];
                         if ((c == '+' || c == '-') && &pStream->zText[1] < pStream->zEnd &&
-                            pStream->zText[1] < 0xc0 && SyisDigit(pStream->zText[1]))
+                            LexIsDigit(pStream->zText[1]))
                         {
                             pStream->zText++;
                         }
-                        while (pStream->zText < pStream->zEnd && pStream->zText[0] < 0xc0 &&
-                               SyisDigit(pStream->zText[0]))
+                        while (pStream->zText < pStream->zEnd && LexIsDigit(pStream->zText[0]))
                         {
                             pStream->zText++;
                         }
@@ -255,7 +336,7 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
                 {
                     /* Hex digit stream */
                     pStream->zText++;
-                    while (pStream->zText < pStream->zEnd && pStream->zText[0] < 0xc0 && SyisHex(pStream->zText[0]))
+                    while (pStream->zText < pStream->zEnd && LexIsHex(pStream->zText[0]))
                     {
                         pStream->zText++;
                     }
@@ -371,6 +452,15 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
                 pStr->zString++;
                 while (pStream->zText < pStream->zEnd)
                 {
+                    /* Skip the string body up to the next quote or new line */
+                    while (pStream->zText < pStream->zEnd && !LexClass(pStream->zText[0], LEX_CLASS_SSTR))
+                    {
+                        pStream->zText++;
+                    }
+                    if (pStream->zText >= pStream->zEnd)
+                    {
+                        break;
+                    }
                     if (pStream->zText[0] == '\'')
                     {
                         if (pStream->zText[-1] != '\\')
@@ -412,6 +502,15 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
                 pStr->zString++;
                 while (pStream->zText < pStream->zEnd)
                 {
+                    /* Skip the string body up to the next quote,brace or new line */
+                    while (pStream->zText < pStream->zEnd && !LexClass(pStream->zText[0], LEX_CLASS_DSTR))
+                    {
+                        pStream->zText++;
+                    }
+                    if (pStream->zText >= pStream->zEnd)
+                    {
+                        break;
+                    }
                     if (pStream->zText[0] == '{' && &pStream->zText[1] < pStream->zEnd && pStream->zText[1] == '$')
                     {
                         iNest = 1;
@@ -547,7 +646,7 @@ static sxi32 TokenizePHP(SyStream* pStream, SyToken* pToken, void* pUserData, vo
                         /* TICKET 1433-0010: Reference operator '=&' */
                         const unsigned char* zCur = pStream->zText;
                         sxu32 nLine = 0;
-                        while (zCur < pStream->zEnd && zCur[0] < 0xc0 && SyisSpace(zCur[0]))
+                        while (zCur < pStream->zEnd && LexIsSpace(zCur[0]))
                         {
                             if (zCur[0] == '\n')
                             {
@@ -1021,7 +1120,7 @@ static sxi32 LexExtractHeredoc(SyStream* pStream, SyToken* pToken)
     SyString sDelim;
     SyString sStr;
     /* Jump leading white spaces */
-    while (zIn < zEnd && zIn[0] < 0xc0 && SyisSpace(zIn[0]) && zIn[0] != '\n')
+    while (zIn < zEnd && LexIsSpace(zIn[0]) && zIn[0] != '\n')
     {
         zIn++;
     }
@@ -1036,7 +1135,7 @@ static sxi32 LexExtractHeredoc(SyStream* pStream, SyToken* pToken)
         bNowDoc = zIn[0] == '\'' ? TRUE : FALSE;
         zIn++;
     }
-    if (zIn[0] < 0xc0 && !SyisAlphaNum(zIn[0]) && zIn[0] != '_')
+    if (zIn[0] < 0xc0 && !LexIsIdent(zIn[0]))
     {
         /* Invalid delimiter,return immediately */
         return SXERR_CONTINUE;
@@ -1047,7 +1146,7 @@ static sxi32 LexExtractHeredoc(SyStream* pStream, SyToken* pToken)
     {
         zPtr = zIn;
         /* Skip alphanumeric stream */
-        while (zPtr < zEnd && zPtr[0] < 0xc0 && (SyisAlphaNum(zPtr[0]) || zPtr[0] == '_'))
+        while (zPtr < zEnd && LexIsIdent(zPtr[0]))
         {
             zPtr++;
         }
@@ -1076,7 +1175,7 @@ static sxi32 LexExtractHeredoc(SyStream* pStream, SyToken* pToken)
         zIn++;
     }
     /* Jump trailing white spaces */
-    while (zIn < zEnd && zIn[0] < 0xc0 && SyisSpace(zIn[0]) && zIn[0] != '\n')
+    while (zIn < zEnd && LexIsSpace(zIn[0]) && zIn[0] != '\n')
     {
         zIn++;
     }
@@ -1109,7 +1208,7 @@ static sxi32 LexExtractHeredoc(SyStream* pStream, SyToken* pToken)
             SyMemcmp((const void*)sDelim.zString, (const void*)zIn, sDelim.nByte) == 0)
         {
             zPtr = &zIn[sDelim.nByte];
-            while (zPtr < zEnd && zPtr[0] < 0xc0 && SyisSpace(zPtr[0]) && zPtr[0] != '\n')
+            while (zPtr < zEnd && LexIsSpace(zPtr[0]) && zPtr[0] != '\n')
             {
                 zPtr++;
             }
@@ -1123,7 +1222,7 @@ static sxi32 LexExtractHeredoc(SyStream* pStream, SyToken* pToken)
             {
                 const unsigned char* zCur = zPtr;
                 zPtr++;
-                while (zPtr < zEnd && zPtr[0] < 0xc0 && SyisSpace(zPtr[0]) && zPtr[0] != '\n')
+                while (zPtr < zEnd && LexIsSpace(zPtr[0]) && zPtr[0] != '\n')
                 {
                     zPtr++;
                 }
@@ -1179,6 +1278,248 @@ PH7_PRIVATE sxi32 PH7_TokenizePHP(const char* zInput, sxu32 nLen, sxu32 nLineSta
     return rc;
 }
 
+/*
+ * Track the nesting level and the statement boundaries seen by an incremental tokenizer.
+ * Return TRUE if the given token is a top-level semi-colon that may end a statement window.
+ */
+static int LexTrackToken(ph7_token_stream* pStream, SyToken* pToken)
+{
+    sxu32 nType = pToken->nType;
+    sxu32 nKey = 0;
+    if (nType & PH7_TK_KEYWORD)
+    {
+        nKey = (sxu32)SX_PTR_TO_INT(pToken->pUserData);
+    }
+    if (pStream->bLead)
+    {
+        /* Remember the keyword leading the statement [i.e: if,while,foreach...] */
+        pStream->nLead = nKey;
+        pStream->bLead = FALSE;
+    }
+    if (nType & (PH7_TK_LPAREN | PH7_TK_OCB | PH7_TK_OSB))
+    {
+        pStream->iNest++;
+    }
+    else if (nType & (PH7_TK_RPAREN | PH7_TK_CCB | PH7_TK_CSB))
+    {
+        /* A brace may close a block opened by a previous PHP chunk [i.e: <?php if($a){ ?>html<?php } ?>].
+         * The nesting level is tracked relative to the enclosing block so that it never drops below zero.
+         */
+        if (pStream->iNest > 0)
+        {
+            pStream->iNest--;
+        }
+        if (pStream->iNest == 0 && (nType & PH7_TK_CCB))
+        {
+            /* End of a top-level block */
+            pStream->bLead = TRUE;
+            pStream->nQuest = 0;
+        }
+    }
+    else if (pStream->iNest == 0)
+    {
+        if (nType & PH7_TK_SEMI)
+        {
+            pStream->bLead = TRUE;
+            pStream->nQuest = 0;
+            return pStream->iAlt == 0;
+        }
+        else if (nType & PH7_TK_COLON)
+        {
+            if (pStream->nQuest > 0)
+            {
+                /* Ternary operator */
+                pStream->nQuest--;
+            }
+            else
+            {
+                if (pStream->nLead == PH7_TKWRD_IF || pStream->nLead == PH7_TKWRD_WHILE ||
+                    pStream->nLead == PH7_TKWRD_FOR || pStream->nLead == PH7_TKWRD_FOREACH ||
+                    pStream->nLead == PH7_TKWRD_SWITCH || pStream->nLead == PH7_TKWRD_DECLARE)
+                {
+                    /* Alternative syntax [i.e: if(): ... endif;] */
+                    pStream->iAlt++;
+                }
+                /* Label,case or alternative block,a new statement follow */
+                pStream->bLead = TRUE;
+            }
+        }
+        else if ((nType & PH7_TK_OP) && pToken->sData.nByte == sizeof(char) && pToken->sData.zString[0] == '?')
+        {
+            pStream->nQuest++;
+        }
+        else if (nKey == PH7_TKWRD_ENDIF || nKey == PH7_TKWRD_ENDWHILE || nKey == PH7_TKWRD_ENDFOR ||
+                 nKey == PH7_TKWRD_END4EACH || nKey == PH7_TKWRD_ENDSWITCH || nKey == PH7_TKWRD_ENDDEC)
+        {
+            if (pStream->iAlt > 0)
+            {
+                pStream->iAlt--;
+            }
+        }
+    }
+    return FALSE;
+}
+
+/*
+ * Check if the given token continues the statement that precede it
+ * [i.e: if(..) stmt; else stmt; do stmt; while(..);].
+ */
+static int LexIsContinuation(SyToken* pToken)
+{
+    if (pToken->nType & PH7_TK_KEYWORD)
+    {
+        sxu32 nKey = (sxu32)SX_PTR_TO_INT(pToken->pUserData);
+        return nKey == PH7_TKWRD_ELSE || nKey == PH7_TKWRD_ELIF || nKey == PH7_TKWRD_WHILE ||
+               nKey == PH7_TKWRD_CATCH;
+    }
+    if ((pToken->nType & PH7_TK_ID) && pToken->sData.nByte == sizeof("finally") - 1 &&
+        SyStrnicmp(pToken->sData.zString, "finally", sizeof("finally") - 1) == 0)
+    {
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * Prepare an incremental tokenization of a raw PHP input.
+ * Tokens are extracted on demand by [PH7_TokenStreamNext()] into the given set.
+ */
+PH7_PRIVATE sxi32 PH7_TokenStreamInit(
+    ph7_token_stream* pStream, /* Incremental tokenizer */
+    const char* zInput,        /* PHP chunk to tokenize */
+    sxu32 nLen,                /* Chunk length */
+    sxu32 nLineStart,          /* Line of the first token */
+    SySet* pOut                /* Token set */
+)
+{
+    SyStream* pIn = &pStream->sLexer.sStream;
+    sxi32 rc;
+    /* Initialize the lexer */
+    rc = SyLexInit(&pStream->sLexer, &(*pOut), TokenizePHP, 0);
+    if (rc != SXRET_OK)
+    {
+        return rc;
+    }
+    pIn->nLine = nLineStart;
+    pIn->zText = pIn->zInput = (const unsigned char*)zInput;
+    pIn->zEnd = &pIn->zInput[nLen];
+    SySetReset(&(*pOut));
+    pStream->nStart = pStream->nEnd = pStream->nScan = 0;
+    pStream->iNest = pStream->iAlt = pStream->nQuest = 0;
+    pStream->nLead = 0;
+    pStream->bLead = TRUE;
+    return SXRET_OK;
+}
+
+/*
+ * Extract the next top-level statement window of an incremental tokenizer.
+ * A window ends at a top-level semi-colon unless the next token continues the
+ * statement [i.e: else,elseif,while,catch] or an alternative syntax block is
+ * still open. The semi-colon that ended the previous window is kept in front of
+ * the set so that operators are disambiguated exactly as in a single pass.
+ * Tokens that may still be merged by the tokenizer [i.e: (int) type casts] are
+ * tracked only once two more tokens have been extracted.
+ * On success,the window is available in the token set at [nStart,nEnd).
+ * SXERR_EOF is returned when the input is exhausted.
+ */
+PH7_PRIVATE sxi32 PH7_TokenStreamNext(ph7_token_stream* pStream)
+{
+    SyStream* pIn = &pStream->sLexer.sStream;
+    SySet* pSet = pStream->sLexer.pTokenSet;
+    SyToken* aToken;
+    SyToken sToken;
+    sxu32 nSplit = 0;
+    int bSplit = FALSE;
+    sxu32 nCarry, n;
+    sxi32 rc;
+    if (pStream->nEnd > 0)
+    {
+        if (pStream->nEnd >= SySetUsed(pSet))
+        {
+            /* The previous window extended to the end of the input */
+            return SXERR_EOF;
+        }
+        /* Keep the statement terminator and the tokens that follow it */
+        aToken = (SyToken*)SySetBasePtr(pSet);
+        nCarry = SySetUsed(pSet) - (pStream->nEnd - 1);
+        for (n = 0; n < nCarry; ++n)
+        {
+            aToken[n] = aToken[pStream->nEnd - 1 + n];
+        }
+        pSet->nUsed = nCarry;
+        pStream->nStart = pStream->nScan = 1;
+    }
+    for (;;)
+    {
+        /* Track the extracted tokens */
+        while (pStream->nScan < SySetUsed(pSet) && (pStream->nScan + 2 < SySetUsed(pSet) || pIn->zText >= pIn->zEnd))
+        {
+            SyToken* pToken = (SyToken*)SySetAt(pSet, pStream->nScan);
+            if (bSplit)
+            {
+                bSplit = FALSE;
+                if (!LexIsContinuation(pToken))
+                {
+                    /* Statement window delimited */
+                    pStream->nEnd = nSplit + 1;
+                    return SXRET_OK;
+                }
+            }
+            if (LexTrackToken(&(*pStream), pToken))
+            {
+                nSplit = pStream->nScan;
+                bSplit = TRUE;
+            }
+            pStream->nScan++;
+        }
+        if (pIn->zText >= pIn->zEnd)
+        {
+            /* End of input reached */
+            break;
+        }
+        /* Extract a single token */
+        const unsigned char* zCur = pIn->zText;
+        rc = TokenizePHP(pIn, &sToken, 0, 0);
+        if (rc == SXRET_OK)
+        {
+            rc = SySetPut(pSet, (const void*)&sToken);
+            if (rc != SXRET_OK)
+            {
+                return rc;
+            }
+        }
+        else if (rc == SXERR_CONTINUE)
+        {
+            /* Ignored token [i.e: comments] */
+            pIn->nIgn++;
+        }
+        else
+        {
+            break;
+        }
+        if (zCur >= pIn->zText)
+        {
+            /* Automatic advance of the stream cursor */
+            pIn->zText = &zCur[1];
+        }
+    }
+    /* The window extend to the end of the input */
+    pStream->nEnd = SySetUsed(pSet);
+    if (pStream->nEnd <= pStream->nStart)
+    {
+        return SXERR_EOF;
+    }
+    return SXRET_OK;
+}
+
+/*
+ * Release an incremental tokenizer.
+ */
+PH7_PRIVATE sxi32 PH7_TokenStreamRelease(ph7_token_stream* pStream)
+{
+    return SyLexRelease(&pStream->sLexer);
+}
+
 /*
  * High level public tokenizer.
  *  Tokenize the input into PHP tokens and raw tokens [i.e: HTML,XML,Raw text...].
@@ -1254,6 +1595,12 @@ PH7_PRIVATE sxi32 PH7_TokenizeRawText(const char* zInput, sxu32 nLen, SySet* pOu
         zCurEnd = 0;
         while (zIn < zEnd)
         {
+            /* Jump to the next tag candidate or new line */
+            zIn = (const char*)LexFindByte2((const unsigned char*)zIn, (const unsigned char*)zEnd, '<', '\n');
+            if (zIn >= zEnd)
+            {
+                break;
+            }
             if (zIn[0] == '<')
             {
                 const char* zTmp = zIn; /* End of raw input marker */
@@ -1302,7 +1649,7 @@ PH7_PRIVATE sxi32 PH7_TokenizeRawText(const char* zInput, sxu32 nLen, SySet* pOu
             break;
         }
         /* Ignore leading white space */
-        while (zIn < zEnd && (unsigned char)zIn[0] < 0xc0 && SyisSpace(zIn[0]))
+        while (zIn < zEnd && LexIsSpace(zIn[0]))
         {
             if (zIn[0] == '\n')
             {
@@ -1316,6 +1663,11 @@ PH7_PRIVATE sxi32 PH7_TokenizeRawText(const char* zInput, sxu32 nLen, SySet* pOu
         while ((sxu32)(zEnd - zIn) >= sCtag.nByte)
         {
             const char* zPtr;
+            /* Skip bytes that cannot start a closing tag,a comment,a heredoc or a new line */
+            while ((sxu32)(zEnd - zIn) > sCtag.nByte && !LexClass(zIn[0], LEX_CLASS_CHUNK))
+            {
+                zIn++;
+            }
             if (SyMemcmp(zIn, sCtag.zString, sCtag.nByte) == 0 && iNest < 1)
             {
                 break;
@@ -1363,7 +1715,7 @@ PH7_PRIVATE sxi32 PH7_TokenizeRawText(const char* zInput, sxu32 nLen, SySet* pOu
                 if (iNest > 0)
                 {
                     zIn++;
-                    while (zIn < zEnd && (unsigned char)zIn[0] < 0xc0 && SyisSpace(zIn[0]) && zIn[0] != '\n')
+                    while (zIn < zEnd && LexIsSpace(zIn[0]) && zIn[0] != '\n')
                     {
                         zIn++;
                     }
@@ -1376,7 +1728,7 @@ PH7_PRIVATE sxi32 PH7_TokenizeRawText(const char* zInput, sxu32 nLen, SySet* pOu
                             zIn++;
                             SX_JMP_UTF8(zIn, zEnd);
                         }
-                        else if (!SyisAlphaNum(zIn[0]) && zIn[0] != '_')
+                        else if (!LexIsIdent(zIn[0]))
                         {
                             break;
                         }
@@ -1396,7 +1748,7 @@ PH7_PRIVATE sxi32 PH7_TokenizeRawText(const char* zInput, sxu32 nLen, SySet* pOu
                      iNest < 1)
             {
                 zIn += sizeof("<<<") - 1;
-                while (zIn < zEnd && (unsigned char)zIn[0] < 0xc0 && SyisSpace(zIn[0]) && zIn[0] != '\n')
+                while (zIn < zEnd && LexIsSpace(zIn[0]) && zIn[0] != '\n')
                 {
                     zIn++;
                 }
@@ -1413,7 +1765,7 @@ PH7_PRIVATE sxi32 PH7_TokenizeRawText(const char* zInput, sxu32 nLen, SySet* pOu
                         zIn++;
                         SX_JMP_UTF8(zIn, zEnd);
                     }
-                    else if (!SyisAlphaNum(zIn[0]) && zIn[0] != '_')
+                    else if (!LexIsIdent(zIn[0]))
                     {
                         break;
                     }
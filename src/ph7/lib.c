@@ -328,6 +328,106 @@ PH7_PRIVATE const SyMutexMethods* SyMutexExportMethods(void)
 #endif // __WINNT__
 #endif // PH7_ENABLE_THREADS
 
+#if defined(PH7_ENABLE_THREADS)
+
+/* SyRunTimeApi: sxthread.c */
+
+/* Maximum number of tasks dispatched by a single call to SyThreadRunTasks() */
+#define SXTHREAD_MAX_TASK 64
+
+typedef struct SyThreadTask SyThreadTask;
+
+struct SyThreadTask
+{
+    ProcThreadTask xTask; /* Task body */
+    void* pArg;           /* Task argument */
+};
+
+#if defined(__WINNT__)
+
+static DWORD WINAPI WinThreadMain(LPVOID pArg)
+{
+    SyThreadTask* pTask = (SyThreadTask*)pArg;
+    pTask->xTask(pTask->pArg);
+    return 0;
+}
+
+#elif defined(__UNIXES__)
+
+static void* UnixThreadMain(void* pArg)
+{
+    SyThreadTask* pTask = (SyThreadTask*)pArg;
+    pTask->xTask(pTask->pArg);
+    return 0;
+}
+
+#endif // __WINNT__
+
+/*
+ * Run a batch of independent tasks in parallel and wait for their completion.
+ * pTask points to an array of nTask records of nTaskSize bytes each,every record is
+ * passed to xTask(). The last task is run by the calling thread,so are tasks that
+ * cannot be dispatched to a new thread [i.e: thread creation failure or platforms
+ * others than Windows and UNIX systems].
+ */
+PH7_PRIVATE void SyThreadRunTasks(ProcThreadTask xTask, void* pTask, sxu32 nTaskSize, sxu32 nTask)
+{
+    SyThreadTask aTask[SXTHREAD_MAX_TASK];
+    int aRunning[SXTHREAD_MAX_TASK];
+#if defined(__WINNT__)
+    HANDLE aThread[SXTHREAD_MAX_TASK];
+#elif defined(__UNIXES__)
+    pthread_t aThread[SXTHREAD_MAX_TASK];
+#endif
+    sxu32 n;
+    if (nTask > SXTHREAD_MAX_TASK)
+    {
+        nTask = SXTHREAD_MAX_TASK;
+    }
+    for (n = 0; n < nTask; n++)
+    {
+        aTask[n].xTask = xTask;
+        aTask[n].pArg = (void*)&((char*)pTask)[n * nTaskSize];
+        aRunning[n] = 0;
+        if (n + 1 >= nTask)
+        {
+            /* Last task,run by the caller */
+            break;
+        }
+#if defined(__WINNT__)
+        aThread[n] = CreateThread(0, 0, WinThreadMain, (LPVOID)&aTask[n], 0, 0);
+        aRunning[n] = aThread[n] != 0;
+#elif defined(__UNIXES__)
+        aRunning[n] = pthread_create(&aThread[n], 0, UnixThreadMain, (void*)&aTask[n]) == 0;
+#endif
+        if (!aRunning[n])
+        {
+            /* Run in the calling thread */
+            xTask(aTask[n].pArg);
+        }
+    }
+    if (nTask > 0)
+    {
+        xTask(aTask[nTask - 1].pArg);
+    }
+    /* Wait for the dispatched tasks */
+    for (n = 0; n + 1 < nTask; n++)
+    {
+        if (!aRunning[n])
+        {
+            continue;
+        }
+#if defined(__WINNT__)
+        WaitForSingleObject(aThread[n], INFINITE);
+        CloseHandle(aThread[n]);
+#elif defined(__UNIXES__)
+        pthread_join(aThread[n], 0);
+#endif
+    }
+}
+
+#endif // PH7_ENABLE_THREADS
+
 static void* SyOSHeapAlloc(sxu32 nByte)
 {
 #if defined(__WINNT__)
@@ -763,13 +863,13 @@ static sxu32 Systrcpy(char* zDest, sxu32 nDestLen, const char* zSrc, sxu32 nLen)
     }
     // Reserve a room for the null terminator.
     unsigned char* zEnd = &zBuf[nDestLen - 1];
+    const unsigned char* zIn = (const unsigned char*)zSrc;
     for (;;)
     {
         if (zBuf >= zEnd || nLen == 0)
         {
             break;
         }
-        unsigned char* zIn = (unsigned char*)zSrc;
         zBuf[0] = zIn[0];
         zIn++;
         zBuf++;
@@ -1742,7 +1842,7 @@ PH7_PRIVATE sxi32 SyBlobNullAppend(SyBlob* pBlob)
 {
     sxu32 n = pBlob->nByte;
 
-    sxi32 rc = SyBlobAppend(&(*pBlob), (const void*)'\0', sizeof(char));
+    sxi32 rc = SyBlobAppend(&(*pBlob), (const void*)"\0", sizeof(char));
     if (rc == SXRET_OK)
     {
         pBlob->nByte = n;
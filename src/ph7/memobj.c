@@ -154,14 +154,13 @@ static sxi64 MemObjStringToInt(ph7_value* pObj)
 static sxi32 MemObjCallClassCastMethod(
     ph7_vm* pVm,               /* VM that trigger the invocation */
     ph7_class_instance* pThis, /* Target class instance [i.e: Object] */
-    const char* zMethod,       /* Magic method name [i.e: __toString] */
-    sxu32 nLen,                /* Method name length */
+    sxi32 iMagic,              /* Magic method [i.e: PH7_CLASS_MAGIC_TOSTRING] */
     ph7_value* pResult         /* OUT: Store the return value of the magic method here */
 )
 {
     ph7_class_method* pMethod;
     /* Check if the method is available */
-    pMethod = PH7_ClassExtractMethod(pThis->pClass, zMethod, nLen);
+    pMethod = pThis->pClass->apMagic[iMagic];
     if (pMethod == 0)
     {
         /* No such method */
@@ -218,7 +217,7 @@ static sxi64 MemObjIntValue(ph7_value* pObj)
         /* Invoke the [__toInt()] magic method if available [note that this is a symisc extension]  */
         PH7_MemObjInit(pObj->pVm, &sResult);
         rc = MemObjCallClassCastMethod(pObj->pVm, (ph7_class_instance*)pObj->x.pOther,
-                                       "__toInt", sizeof("__toInt") - 1, &sResult);
+                                       PH7_CLASS_MAGIC_TOINT, &sResult);
         if (rc == SXRET_OK && (sResult.iFlags & MEMOBJ_INT))
         {
             /* Extract method return value */
@@ -302,7 +301,7 @@ static ph7_real MemObjRealValue(ph7_value* pObj)
         /* Invoke the [__toFloat()] magic method if available [note that this is a symisc extension]  */
         PH7_MemObjInit(pObj->pVm, &sResult);
         rc = MemObjCallClassCastMethod(pObj->pVm, (ph7_class_instance*)pObj->x.pOther,
-                                       "__toFloat", sizeof("__toFloat") - 1, &sResult);
+                                       PH7_CLASS_MAGIC_TOFLOAT, &sResult);
         if (rc == SXRET_OK && (sResult.iFlags & MEMOBJ_REAL))
         {
             /* Extract method return value */
@@ -361,7 +360,7 @@ static sxi32 MemObjStringValue(SyBlob* pOut, ph7_value* pObj, sxu8 bStrictBool)
         /* Invoke the __toString() method if available */
         PH7_MemObjInit(pObj->pVm, &sResult);
         rc = MemObjCallClassCastMethod(pObj->pVm, (ph7_class_instance*)pObj->x.pOther,
-                                       "__toString", sizeof("__toString") - 1, &sResult);
+                                       PH7_CLASS_MAGIC_TOSTRING, &sResult);
         if (rc == SXRET_OK && (sResult.iFlags & MEMOBJ_STRING) && SyBlobLength(&sResult.sBlob) > 0)
         {
             /* Expand method return value */
@@ -462,7 +461,7 @@ static sxi32 MemObjBooleanValue(ph7_value* pObj)
         /* Invoke the __toBool() method if available [note that this is a symisc extension]  */
         PH7_MemObjInit(pObj->pVm, &sResult);
         rc = MemObjCallClassCastMethod(pObj->pVm, (ph7_class_instance*)pObj->x.pOther,
-                                       "__toBool", sizeof("__toBool") - 1, &sResult);
+                                       PH7_CLASS_MAGIC_TOBOOL, &sResult);
         if (rc == SXRET_OK && (sResult.iFlags & (MEMOBJ_INT | MEMOBJ_BOOL)))
         {
             /* Extract method return value */
@@ -589,7 +588,7 @@ PH7_PRIVATE sxi32 PH7_MemObjToHashmap(ph7_value* pObj)
     {
         ph7_hashmap* pMap;
 /* Allocate a new hashmap instance */
-        pMap = PH7_NewHashmap(pObj->pVm, 0, 0);
+        pMap = PH7_NewHashmap(pObj->pVm, 0, 0, 0);
         if (pMap == 0)
         {
             return SXERR_MEM;
@@ -663,7 +662,7 @@ PH7_PRIVATE sxi32 PH7_MemObjToObject(ph7_value* pObj)
             return SXRET_OK;
         }
 /* Check if a constructor is available */
-        pCons = PH7_ClassExtractMethod(pClass, "__construct", sizeof("__construct") - 1);
+        pCons = pClass->apMagic[PH7_CLASS_MAGIC_CONSTRUCT];
         if (pCons)
         {
             ph7_value* apArg[2];
@@ -1435,7 +1434,7 @@ PH7_PRIVATE sxi32 PH7_MemObjAdd(ph7_value* pObj1, ph7_value* pObj2, int bAddStor
             else
             {
 /* Create a new hashmap */
-                pMap = PH7_NewHashmap(pObj1->pVm, 0, 0);
+                pMap = PH7_NewHashmap(pObj1->pVm, 0, 0, 0);
                 if (pMap == 0)
                 {
                     PH7_VmThrowError(pObj1->pVm, 0, PH7_CTX_ERR,
@@ -68,6 +68,9 @@ PH7_PRIVATE ph7_class* PH7_NewRawClass(ph7_vm* pVm, const SyString* pName, sxu32
     SyHashInit(&pClass->hAttr, &pVm->sAllocator, 0, 0);
     SyHashInit(&pClass->hDerived, &pVm->sAllocator, 0, 0);
     SySetInit(&pClass->aInterface, &pVm->sAllocator, sizeof(ph7_class*));
+    SySetInit(&pClass->aAncestor, &pVm->sAllocator, sizeof(ph7_class*));
+    SySetInit(&pClass->aLayout, &pVm->sAllocator, sizeof(ph7_class_attr*));
+    SyHashInit(&pClass->hLayout, &pVm->sAllocator, 0, 0);
     pClass->nLine = nLine;
 /* All done */
     return pClass;
@@ -218,6 +221,11 @@ PH7_PRIVATE sxi32 PH7_ClassInstallAttr(ph7_class* pClass, ph7_class_attr* pAttr)
     SyString* pName = &pAttr->sName;
     sxi32 rc;
     rc = SyHashInsert(&pClass->hAttr, (const void*)pName->zString, pName->nByte, pAttr);
+    if (pAttr->pClass == 0)
+    {
+/* Record the declaring class */
+        pAttr->pClass = pClass;
+    }
     return rc;
 }
 /*
@@ -496,7 +504,173 @@ PH7_PRIVATE sxi32 PH7_ClassImplement(ph7_class* pMain, ph7_class* pInterface)
  */
     return SXRET_OK;
 }
+/*
+ * Names of the magic methods cached in ph7_class.apMagic[].
+ * Must be kept in sync with the PH7_CLASS_MAGIC_* indexes.
+ */
+static const SyString aMagicName[PH7_CLASS_MAGIC_COUNT] = {
+    {"__construct",  sizeof("__construct") - 1},
+    {"__destruct",   sizeof("__destruct") - 1},
+    {"__clone",      sizeof("__clone") - 1},
+    {"__get",        sizeof("__get") - 1},
+    {"__call",       sizeof("__call") - 1},
+    {"__callStatic", sizeof("__callStatic") - 1},
+    {"__invoke",     sizeof("__invoke") - 1},
+    {"__toString",   sizeof("__toString") - 1},
+    {"__toInt",      sizeof("__toInt") - 1},
+    {"__toFloat",    sizeof("__toFloat") - 1},
+    {"__toBool",     sizeof("__toBool") - 1},
+    {"offsetGet",    sizeof("offsetGet") - 1},
+    {"offsetSet",    sizeof("offsetSet") - 1}
+};
+/*
+ * Resolve the magic methods of a class once its own and inherited methods
+ * are installed so that the VM never looks them up by name at run-time.
+ * A method named after the class stands for a missing __construct().
+ */
+PH7_PRIVATE void PH7_ClassResolveMagicMethods(ph7_class* pClass)
+{
+    sxi32 i;
+    for (i = 0; i < PH7_CLASS_MAGIC_COUNT; i++)
+    {
+        pClass->apMagic[i] = PH7_ClassExtractMethod(pClass, aMagicName[i].zString, aMagicName[i].nByte);
+    }
+    if (pClass->apMagic[PH7_CLASS_MAGIC_CONSTRUCT] == 0)
+    {
+        /* Check for a constructor with the same base class name */
+        pClass->apMagic[PH7_CLASS_MAGIC_CONSTRUCT] = PH7_ClassExtractMethod(pClass, pClass->sName.zString,
+                                                                            pClass->sName.nByte);
+    }
+}
+/*
+ * Append the ancestry table of the given class to the ancestry table
+ * of the main class being built.
+ */
+static sxi32 ClassMergeAncestry(ph7_class* pMain, ph7_class* pClass)
+{
+    ph7_class** apAncestor;
+    sxu32 n;
+    sxi32 rc;
+    apAncestor = (ph7_class**)SySetBasePtr(&pClass->aAncestor);
+    for (n = 0; n < SySetUsed(&pClass->aAncestor); n++)
+    {
+        rc = SySetPut(&pMain->aAncestor, (const void*)&apAncestor[n]);
+        if (rc != SXRET_OK)
+        {
+            return rc;
+        }
+    }
+    return SXRET_OK;
+}
+/*
+ * Build the ancestry table of a class or an interface.
+ * This function must be called once the base class and the implemented
+ * interfaces are installed. The table holds the class itself,all of its
+ * base classes and all of the implemented interfaces including the ones
+ * they extend. Entries are sorted by address so that [instanceof],catch
+ * blocks and type hints resolve with a binary search rather than walking
+ * the class hierarchy.
+ * This function return SXRET_OK on success. Any other return value indicates failure.
+ */
+PH7_PRIVATE sxi32 PH7_ClassBuildAncestry(ph7_class* pClass)
+{
+    ph7_class** apInterface;
+    ph7_class** apAncestor;
+    ph7_class* pTmp;
+    sxu32 n, i, j;
+    sxi32 rc;
+    SySetReset(&pClass->aAncestor);
+    rc = SySetPut(&pClass->aAncestor, (const void*)&pClass);
+    if (rc == SXRET_OK && pClass->pBase)
+    {
+        /* Base classes [or interfaces] were processed first */
+        rc = ClassMergeAncestry(pClass, pClass->pBase);
+    }
+    apInterface = (ph7_class**)SySetBasePtr(&pClass->aInterface);
+    for (n = 0; rc == SXRET_OK && n < SySetUsed(&pClass->aInterface); n++)
+    {
+        rc = ClassMergeAncestry(pClass, apInterface[n]);
+    }
+    if (rc != SXRET_OK)
+    {
+        return rc;
+    }
+    /* Sort by address (Insertion sort,hierarchies are shallow) */
+    apAncestor = (ph7_class**)SySetBasePtr(&pClass->aAncestor);
+    for (i = 1; i < SySetUsed(&pClass->aAncestor); i++)
+    {
+        pTmp = apAncestor[i];
+        for (j = i; j > 0 && SX_ADDR(apAncestor[j - 1]) > SX_ADDR(pTmp); j--)
+        {
+            apAncestor[j] = apAncestor[j - 1];
+        }
+        apAncestor[j] = pTmp;
+    }
+    /* Remove duplicates [i.e: An interface implemented at different levels] */
+    for (i = 0, j = 0; i < SySetUsed(&pClass->aAncestor); i++)
+    {
+        if (j == 0 || apAncestor[j - 1] != apAncestor[i])
+        {
+            apAncestor[j++] = apAncestor[i];
+        }
+    }
+    SySetTruncate(&pClass->aAncestor, j);
+    return SXRET_OK;
+}
 
+/*
+ * Compute the layout of the instances of a given class. That is,give each
+ * attribute (including inherited ones) a fixed slot in the ph7_class_instance.aAttr[]
+ * array so that objects does not need their own attribute hashtable.
+ * The layout is computed once on the first instantiation of the class.
+ */
+static sxi32 ClassComputeLayout(ph7_class* pClass)
+{
+    ph7_class_attr** apAttr, * pAttr;
+    SyHashEntry* pEntry;
+    sxu32 n, nAttr;
+    sxi32 rc;
+    if (SySetUsed(&pClass->aLayout) == SyHashTotalEntry(&pClass->hAttr))
+    {
+        /* Already computed */
+        return SXRET_OK;
+    }
+    /* Discard any stale layout */
+    SySetReset(&pClass->aLayout);
+    SyHashRelease(&pClass->hLayout);
+    SyHashInit(&pClass->hLayout, pClass->hAttr.pAllocator, 0, 0);
+    SyHashResetLoopCursor(&pClass->hAttr);
+    while ((pEntry = SyHashGetNextEntry(&pClass->hAttr)) != 0)
+    {
+        pAttr = (ph7_class_attr*)pEntry->pUserData;
+        rc = SySetPut(&pClass->aLayout, (const void*)&pAttr);
+        if (rc != SXRET_OK)
+        {
+            SySetReset(&pClass->aLayout);
+            return rc;
+        }
+    }
+    /* Keep the order in which the attributes were installed [i.e: reverse of the hashtable walk] */
+    apAttr = (ph7_class_attr**)SySetBasePtr(&pClass->aLayout);
+    nAttr = SySetUsed(&pClass->aLayout);
+    for (n = 0; n < nAttr / 2; ++n)
+    {
+        pAttr = apAttr[n];
+        apAttr[n] = apAttr[nAttr - 1 - n];
+        apAttr[nAttr - 1 - n] = pAttr;
+    }
+    for (n = 0; n < nAttr; ++n)
+    {
+        rc = SyHashInsert(&pClass->hLayout, SyStringData(&apAttr[n]->sName), SyStringLength(&apAttr[n]->sName),
+                          SX_INT_TO_PTR(n));
+        if (rc != SXRET_OK)
+        {
+            SySetReset(&pClass->aLayout);
+            return rc;
+        }
+    }
+    return SXRET_OK;
+}
 /*
  * Create a class instance [i.e: Object in the PHP jargon] at run-time.
  * The following function is called when an object is created at run-time
@@ -579,8 +753,31 @@ PH7_PRIVATE sxi32 PH7_ClassImplement(ph7_class* pMain, ph7_class* pInterface)
 static ph7_class_instance* NewClassInstance(ph7_vm* pVm, ph7_class* pClass)
 {
     ph7_class_instance* pThis;
-    /* Allocate a new instance */
-    pThis = (ph7_class_instance*)SyMemBackendPoolAlloc(&pVm->sAllocator, sizeof(ph7_class_instance));
+    sxu32 nAttr;
+    /* Make sure the instance layout is computed */
+    if (ClassComputeLayout(&(*pClass)) != SXRET_OK)
+    {
+        return 0;
+    }
+    nAttr = SySetUsed(&pClass->aLayout);
+    pThis = pClass->pFreeInstance;
+    if (pThis && pThis->nAttr == nAttr)
+    {
+        /* Recycle a dead instance,its attribute slots are already reserved */
+        pClass->pFreeInstance = pThis->pNextFree;
+        pClass->nFreeInstance--;
+        pThis->pNextFree = 0;
+        pThis->iRef = 1;
+        pThis->iFlags = 0;
+        if (PH7_VmResetClassInstanceFrame(&(*pVm), pThis) != SXRET_OK)
+        {
+            return 0;
+        }
+        return pThis;
+    }
+    /* Allocate a new instance and its attribute slots in a single chunk */
+    pThis = (ph7_class_instance*)SyMemBackendPoolAlloc(&pVm->sAllocator,
+                                                       sizeof(ph7_class_instance) + nAttr * sizeof(VmClassAttr));
     if (pThis == 0)
     {
         return 0;
@@ -591,7 +788,14 @@ static ph7_class_instance* NewClassInstance(ph7_vm* pVm, ph7_class* pClass)
     pThis->iRef = 1;
     pThis->pVm = pVm;
     pThis->pClass = pClass;
-    SyHashInit(&pThis->hAttr, &pVm->sAllocator, 0, 0);
+    pThis->aAttr = (VmClassAttr*)&pThis[1];
+    pThis->nAttr = nAttr;
+    /* Associate a private VM frame with this class instance */
+    if (PH7_VmCreateClassInstanceFrame(&(*pVm), pThis) != SXRET_OK)
+    {
+        SyMemBackendPoolFree(&pVm->sAllocator, pThis);
+        return 0;
+    }
     return pThis;
 }
 /*
@@ -601,19 +805,7 @@ static ph7_class_instance* NewClassInstance(ph7_vm* pVm, ph7_class* pClass)
 PH7_PRIVATE ph7_class_instance* PH7_NewClassInstance(ph7_vm* pVm, ph7_class* pClass)
 {
     ph7_class_instance* pNew;
-    sxi32 rc;
     pNew = NewClassInstance(&(*pVm), &(*pClass));
-    if (pNew == 0)
-    {
-        return 0;
-    }
-/* Associate a private VM frame with this class instance */
-    rc = PH7_VmCreateClassInstanceFrame(&(*pVm), pNew);
-    if (rc != SXRET_OK)
-    {
-        SyMemBackendPoolFree(&pVm->sAllocator, pNew);
-        return 0;
-    }
     return pNew;
 }
 
@@ -716,10 +908,8 @@ PH7_PRIVATE ph7_class_instance* PH7_CloneClassInstance(ph7_class_instance* pSrc)
 {
     ph7_class_instance* pClone;
     ph7_class_method* pMethod;
-    SyHashEntry* pEntry2;
-    SyHashEntry* pEntry;
     ph7_vm* pVm;
-    sxi32 rc;
+    sxu32 n;
 /* Allocate a new instance */
     pVm = pSrc->pVm;
     pClone = NewClassInstance(pVm, pSrc->pClass);
@@ -727,20 +917,11 @@ PH7_PRIVATE ph7_class_instance* PH7_CloneClassInstance(ph7_class_instance* pSrc)
     {
         return 0;
     }
-/* Associate a private VM frame with this class instance */
-    rc = PH7_VmCreateClassInstanceFrame(pVm, pClone);
-    if (rc != SXRET_OK)
-    {
-        SyMemBackendPoolFree(&pVm->sAllocator, pClone);
-        return 0;
-    }
 /* Duplicate object values */
-    SyHashResetLoopCursor(&pSrc->hAttr);
-    SyHashResetLoopCursor(&pClone->hAttr);
-    while ((pEntry = SyHashGetNextEntry(&pSrc->hAttr)) != 0 && (pEntry2 = SyHashGetNextEntry(&pClone->hAttr)) != 0)
+    for (n = 0; n < pSrc->nAttr; ++n)
     {
-        VmClassAttr* pSrcAttr = (VmClassAttr*)pEntry->pUserData;
-        VmClassAttr* pDestAttr = (VmClassAttr*)pEntry2->pUserData;
+        VmClassAttr* pSrcAttr = &pSrc->aAttr[n];
+        VmClassAttr* pDestAttr = &pClone->aAttr[n];
 /* Duplicate non-static attribute */
         if ((pSrcAttr->pAttr->iFlags & (PH7_CLASS_ATTR_STATIC | PH7_CLASS_ATTR_CONSTANT)) == 0)
         {
@@ -754,7 +935,7 @@ PH7_PRIVATE ph7_class_instance* PH7_CloneClassInstance(ph7_class_instance* pSrc)
         }
     }
 /* call the __clone method on the cloned object if available */
-    pMethod = PH7_ClassExtractMethod(pClone->pClass, "__clone", sizeof("__clone") - 1);
+    pMethod = pClone->pClass->apMagic[PH7_CLASS_MAGIC_CLONE];
     if (pMethod)
     {
         if (pMethod->iCloneDepth < 16)
@@ -784,9 +965,9 @@ PH7_PRIVATE ph7_class_instance* PH7_CloneClassInstance(ph7_class_instance* pSrc)
 static void PH7_ClassInstanceRelease(ph7_class_instance* pThis)
 {
     ph7_class_method* pDestr;
-    SyHashEntry* pEntry;
     ph7_class* pClass;
     ph7_vm* pVm;
+    sxu32 n;
     if (pThis->iFlags & CLASS_INSTANCE_DESTROYED)
     {
         /*
@@ -800,26 +981,32 @@ static void PH7_ClassInstanceRelease(ph7_class_instance* pThis)
     /* Invoke any defined destructor if available */
     pVm = pThis->pVm;
     pClass = pThis->pClass;
-    pDestr = PH7_ClassExtractMethod(pClass, "__destruct", sizeof("__destruct") - 1);
+    pDestr = pClass->apMagic[PH7_CLASS_MAGIC_DESTRUCT];
     if (pDestr)
     {
         /* Invoke the destructor */
         pThis->iRef = 2; /* Prevent garbage collection */
         PH7_VmCallClassMethod(pVm, pThis, pDestr, 0, 0, 0);
     }
+    if (pClass->nFreeInstance < PH7_CLASS_FREE_INSTANCE_MAX &&
+        PH7_VmRecycleClassInstanceFrame(pVm, pThis) == SXRET_OK)
+    {
+        /* Keep the instance and its attribute slots for the next instantiation of this class */
+        pThis->pNextFree = pClass->pFreeInstance;
+        pClass->pFreeInstance = pThis;
+        pClass->nFreeInstance++;
+        return;
+    }
     /* Release non-static attributes */
-    SyHashResetLoopCursor(&pThis->hAttr);
-    while ((pEntry = SyHashGetNextEntry(&pThis->hAttr)) != 0)
+    for (n = 0; n < pThis->nAttr; ++n)
     {
-        VmClassAttr* pVmAttr = (VmClassAttr*)pEntry->pUserData;
+        VmClassAttr* pVmAttr = &pThis->aAttr[n];
         if ((pVmAttr->pAttr->iFlags & (PH7_CLASS_ATTR_STATIC | PH7_CLASS_ATTR_CONSTANT)) == 0)
         {
             PH7_VmUnsetMemObj(pVm, pVmAttr->nIdx, TRUE);
         }
-        SyMemBackendPoolFree(&pVm->sAllocator, pVmAttr);
     }
-    /* Release the whole structure */
-    SyHashRelease(&pThis->hAttr);
+    /* Release the whole structure including the attribute slots */
     SyMemBackendPoolFree(&pVm->sAllocator, pThis);
 }
 /*
@@ -915,9 +1102,9 @@ PH7_PRIVATE void PH7_ClassInstanceUnref(ph7_class_instance* pThis)
 PH7_PRIVATE sxi32
 PH7_ClassInstanceCmp(ph7_class_instance* pLeft, ph7_class_instance* pRight, int bStrict, int iNest)
 {
-    SyHashEntry* pEntry, * pEntry2;
     ph7_value sV1, sV2;
     sxi32 rc;
+    sxu32 n;
     if (iNest > 31)
     {
 /* Nesting limit reached */
@@ -951,15 +1138,13 @@ PH7_ClassInstanceCmp(ph7_class_instance* pLeft, ph7_class_instance* pRight, int
 /* Same instance,don't bother processing,object are equals */
         return 0;
     }
-    SyHashResetLoopCursor(&pLeft->hAttr);
-    SyHashResetLoopCursor(&pRight->hAttr);
     PH7_MemObjInit(pLeft->pVm, &sV1);
     PH7_MemObjInit(pLeft->pVm, &sV2);
     sV1.nIdx = sV2.nIdx = SXU32_HIGH;
-    while ((pEntry = SyHashGetNextEntry(&pLeft->hAttr)) != 0 && (pEntry2 = SyHashGetNextEntry(&pRight->hAttr)) != 0)
+    for (n = 0; n < pLeft->nAttr; ++n)
     {
-        VmClassAttr* p1 = (VmClassAttr*)pEntry->pUserData;
-        VmClassAttr* p2 = (VmClassAttr*)pEntry2->pUserData;
+        VmClassAttr* p1 = &pLeft->aAttr[n];
+        VmClassAttr* p2 = &pRight->aAttr[n];
 /* Compare only non-static attribute */
         if ((p1->pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC)) == 0)
         {
@@ -996,9 +1181,9 @@ PH7_ClassInstanceCmp(ph7_class_instance* pLeft, ph7_class_instance* pRight, int
  */
 PH7_PRIVATE sxi32 PH7_ClassInstanceDump(SyBlob* pOut, ph7_class_instance* pThis, int ShowType, int nTab, int nDepth)
 {
-    SyHashEntry* pEntry;
     ph7_value* pValue;
     sxi32 rc;
+    sxu32 n;
     int i;
     if (nDepth > 31)
     {
@@ -1024,10 +1209,9 @@ PH7_PRIVATE sxi32 PH7_ClassInstanceDump(SyBlob* pOut, ph7_class_instance* pThis,
     SyBlobAppend(&(*pOut),"\n",sizeof(char));
 #endif
 /* Dump object attributes */
-    SyHashResetLoopCursor(&pThis->hAttr);
-    while ((pEntry = SyHashGetNextEntry(&pThis->hAttr)) != 0)
+    for (n = 0; n < pThis->nAttr; ++n)
     {
-        VmClassAttr* pVmAttr = (VmClassAttr*)pEntry->pUserData;
+        VmClassAttr* pVmAttr = &pThis->aAttr[n];
         if ((pVmAttr->pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC)) == 0)
         {
 /* Dump non-static/constant attribute only */
@@ -1104,8 +1288,7 @@ PH7_PRIVATE sxi32 PH7_ClassInstanceCallMagicMethod(
     ph7_vm* pVm,               /* VM that own all this stuff */
     ph7_class* pClass,         /* Target class */
     ph7_class_instance* pThis, /* Target object */
-    const char* zMethod,       /* Magic method name [i.e: __toString()]*/
-    sxu32 nByte,               /* zMethod length*/
+    sxi32 iMagic,              /* Magic method [i.e: PH7_CLASS_MAGIC_GET] */
     const SyString* pAttrName,  /* Attribute name */
     ph7_value* pKey
 )
@@ -1116,7 +1299,7 @@ PH7_PRIVATE sxi32 PH7_ClassInstanceCallMagicMethod(
     sxi32 rc;
     int nArg;
 /* Make sure the magic method is available */
-    pMeth = PH7_ClassExtractMethod(&(*pClass), zMethod, nByte);
+    pMeth = pClass->apMagic[iMagic];
     if (pMeth == 0)
     {
 /* No such method,return immediately */
@@ -1189,18 +1372,16 @@ PH7_PRIVATE ph7_value* PH7_ClassInstanceExtractAttrValue(ph7_class_instance* pTh
  */
 PH7_PRIVATE sxi32 PH7_ClassInstanceToHashmap(ph7_class_instance* pThis, ph7_hashmap* pMap)
 {
-    SyHashEntry* pEntry;
     SyString* pAttrName;
     VmClassAttr* pAttr;
     ph7_value* pValue;
     ph7_value sName;
-/* Reset the loop cursor */
-    SyHashResetLoopCursor(&pThis->hAttr);
+    sxu32 n;
     PH7_MemObjInitFromString(pThis->pVm, &sName, 0);
-    while ((pEntry = SyHashGetNextEntry(&pThis->hAttr)) != 0)
+    for (n = 0; n < pThis->nAttr; ++n)
     {
 /* Point to the current attribute */
-        pAttr = (VmClassAttr*)pEntry->pUserData;
+        pAttr = &pThis->aAttr[n];
 /* Extract attribute value */
         pValue = ExtractClassAttrValue(pThis->pVm, pAttr);
         if (pValue)
@@ -1232,19 +1413,17 @@ PH7_PRIVATE sxi32 PH7_ClassInstanceWalk(
     void* pUserData /* Last argument to xWalk() */
 )
 {
-    SyHashEntry* pEntry; /* Hash entry */
     VmClassAttr* pAttr;  /* Pointer to the attribute */
     ph7_value* pValue;   /* Attribute value */
     ph7_value sValue;    /* Copy of the attribute value */
+    sxu32 n;             /* Slot index */
     int rc;
-/* Reset the loop cursor */
-    SyHashResetLoopCursor(&pThis->hAttr);
     PH7_MemObjInit(pThis->pVm, &sValue);
 /* Start the walk process */
-    while ((pEntry = SyHashGetNextEntry(&pThis->hAttr)) != 0)
+    for (n = 0; n < pThis->nAttr; ++n)
     {
 /* Point to the current attribute */
-        pAttr = (VmClassAttr*)pEntry->pUserData;
+        pAttr = &pThis->aAttr[n];
 /* Extract attribute value */
         pValue = ExtractClassAttrValue(pThis->pVm, pAttr);
         if (pValue)
@@ -1273,17 +1452,14 @@ PH7_PRIVATE sxi32 PH7_ClassInstanceWalk(
  */
 PH7_PRIVATE ph7_value* PH7_ClassInstanceFetchAttr(ph7_class_instance* pThis, const SyString* pName)
 {
-    SyHashEntry* pEntry;
     VmClassAttr* pAttr;
-/* Query the attribute hashtable */
-    pEntry = SyHashGet(&pThis->hAttr, (const void*)pName->zString, pName->nByte);
-    if (pEntry == 0)
+/* Query the class layout */
+    pAttr = PH7_ClassInstanceLookupAttr(&(*pThis), pName);
+    if (pAttr == 0)
     {
 /* No such attribute */
         return 0;
     }
-/* Point to the class atrribute */
-    pAttr = (VmClassAttr*)pEntry->pUserData;
 /* Check if we are dealing with a static/constant attribute */
     if (pAttr->pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC))
     {
@@ -1293,3 +1469,26 @@ PH7_PRIVATE ph7_value* PH7_ClassInstanceFetchAttr(ph7_class_instance* pThis, con
 /* Return the attribute value */
     return ExtractClassAttrValue(pThis->pVm, pAttr);
 }
+/*
+ * Return the slot holding the attribute of the given name in a class instance
+ * [i.e: Object in the PHP jargon] or NULL when no such attribute is defined.
+ * The name is resolved against the layout shared by all the instances of the class.
+ * Member access instructions only call this routine the first time a site sees a
+ * given class and index the slot directly afterwards [refer to VmMemberCacheInsert()].
+ */
+PH7_PRIVATE VmClassAttr* PH7_ClassInstanceLookupAttr(ph7_class_instance* pThis, const SyString* pName)
+{
+    SyHashEntry* pEntry;
+    sxu32 nSlot;
+    pEntry = SyHashGet(&pThis->pClass->hLayout, (const void*)pName->zString, pName->nByte);
+    if (pEntry == 0)
+    {
+        return 0;
+    }
+    nSlot = (sxu32)SX_PTR_TO_INT(pEntry->pUserData);
+    if (nSlot >= pThis->nAttr)
+    {
+        return 0;
+    }
+    return &pThis->aAttr[nSlot];
+}
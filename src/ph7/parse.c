@@ -791,6 +791,101 @@ static sxi32 ExprAssembleAnnon(ph7_gen_state* pGen, SyToken** ppCur, SyToken* pE
     return rc;
 }
 
+/*
+ * Allocate nByte of memory from the expression arena.
+ * Expression nodes live only while the enclosing expression is compiled,
+ * so they are carved out of a chain of blocks owned by the code generator
+ * rather than allocated one at a time. The memory is reclaimed in bulk by
+ * PH7_ExprArenaRestore() once the code for the expression is emitted.
+ */
+static void* ExprArenaAlloc(ph7_gen_state* pGen, sxu32 nByte)
+{
+    GenArenaMark* pPos = &pGen->sArena;
+    GenArenaBlock* pBlock = pPos->pBlock;
+    unsigned char* zChunk;
+    /* Keep every chunk pointer aligned */
+    nByte = (nByte + 7) & ~7u;
+    if (pBlock == 0 || pPos->nUsed + nByte > pBlock->nSize)
+    {
+        GenArenaBlock* pNext;
+        /* Move to the next block in the chain */
+        pNext = pBlock ? pBlock->pNext : pGen->pArenaFirst;
+        if (pNext == 0 || pNext->nSize < nByte)
+        {
+            sxu32 nSize = nByte > GEN_ARENA_BLOCK_SIZE ? nByte : GEN_ARENA_BLOCK_SIZE;
+            GenArenaBlock* pNew;
+            pNew = (GenArenaBlock*)SyMemBackendAlloc(&pGen->pVm->sAllocator, sizeof(GenArenaBlock) + nSize);
+            if (pNew == 0)
+            {
+                return 0;
+            }
+            pNew->nSize = nSize;
+            /* Link to the chain */
+            pNew->pNext = pNext;
+            if (pBlock)
+            {
+                pBlock->pNext = pNew;
+            }
+            else
+            {
+                pGen->pArenaFirst = pNew;
+            }
+            pNext = pNew;
+        }
+        pPos->pBlock = pBlock = pNext;
+        pPos->nUsed = 0;
+    }
+    zChunk = &((unsigned char*)&pBlock[1])[pPos->nUsed];
+    pPos->nUsed += nByte;
+    return (void*)zChunk;
+}
+/*
+ * Append an item to a set whose storage lives in the expression arena.
+ * Such sets are initialized without a memory backend so that SySetPut()
+ * and SySetRelease() never touch their storage.
+ */
+static sxi32 ExprArenaSetPut(ph7_gen_state* pGen, SySet* pSet, const void* pItem)
+{
+    unsigned char* zBase;
+    if (pSet->nUsed >= pSet->nSize)
+    {
+        sxu32 nSize = pSet->nSize > 0 ? pSet->nSize << 1 : 8;
+        void* pNew;
+        pNew = ExprArenaAlloc(&(*pGen), nSize * pSet->eSize);
+        if (pNew == 0)
+        {
+            return SXERR_MEM;
+        }
+        if (pSet->nUsed > 0)
+        {
+            SyMemcpy(pSet->pBase, pNew, pSet->nUsed * pSet->eSize);
+        }
+        pSet->pBase = pNew;
+        pSet->nSize = nSize;
+    }
+    zBase = (unsigned char*)pSet->pBase;
+    SyMemcpy(pItem, &zBase[pSet->nUsed * pSet->eSize], pSet->eSize);
+    pSet->nUsed++;
+    return SXRET_OK;
+}
+/*
+ * Save the current position of the expression arena.
+ */
+PH7_PRIVATE void PH7_ExprArenaSave(ph7_gen_state* pGen, GenArenaMark* pMark)
+{
+    *pMark = pGen->sArena;
+}
+/*
+ * Rewind the expression arena to a position saved by PH7_ExprArenaSave().
+ * Every node and argument set allocated since then is discarded at once.
+ * Nested expressions [i.e: closure bodies] save and restore their own
+ * position while the enclosing tree is still live, so positions are
+ * always restored in the reverse order they were saved.
+ */
+PH7_PRIVATE void PH7_ExprArenaRestore(ph7_gen_state* pGen, const GenArenaMark* pMark)
+{
+    pGen->sArena = *pMark;
+}
 /*
  * Extract a single expression node from the input.
  * On success store the freshly extractd node in ppNode.
@@ -806,7 +901,7 @@ static sxi32 ExprExtractNode(ph7_gen_state* pGen, ph7_expr_node** ppNode)
     SyToken* pCur;
     sxi32 rc;
     /* Allocate a new node */
-    pNode = (ph7_expr_node*)SyMemBackendPoolAlloc(&pGen->pVm->sAllocator, sizeof(ph7_expr_node));
+    pNode = (ph7_expr_node*)ExprArenaAlloc(&(*pGen), sizeof(ph7_expr_node));
     if (pNode == 0)
     {
         /* If the supplied memory subsystem is so sick that we are unable to allocate
@@ -816,7 +911,7 @@ static sxi32 ExprExtractNode(ph7_gen_state* pGen, ph7_expr_node** ppNode)
     }
     /* Zero the structure */
     SyZero(pNode, sizeof(ph7_expr_node));
-    SySetInit(&pNode->aNodeArgs, &pGen->pVm->sAllocator, sizeof(ph7_expr_node**));
+    SySetInit(&pNode->aNodeArgs, 0, sizeof(ph7_expr_node**));
     /* Point to the head of the token stream */
     pCur = pNode->pStart = pGen->pIn;
     /* Start collecting tokens */
@@ -858,7 +953,6 @@ static sxi32 ExprExtractNode(ph7_gen_state* pGen, ph7_expr_node** ppNode)
                     {
                         rc = SXERR_SYNTAX;
                     }
-                    SyMemBackendPoolFree(&pGen->pVm->sAllocator, pNode);
                     return rc;
                 }
             }
@@ -896,7 +990,6 @@ static sxi32 ExprExtractNode(ph7_gen_state* pGen, ph7_expr_node** ppNode)
                     {
                         rc = SXERR_SYNTAX;
                     }
-                    SyMemBackendPoolFree(&pGen->pVm->sAllocator, pNode);
                     return rc;
                 }
                 pNode->xCode = (nKeyword == PH7_TKWRD_LIST) ? PH7_CompileList : PH7_CompileArray;
@@ -913,7 +1006,6 @@ static sxi32 ExprExtractNode(ph7_gen_state* pGen, ph7_expr_node** ppNode)
                         {
                             rc = SXERR_SYNTAX;
                         }
-                        SyMemBackendPoolFree(&pGen->pVm->sAllocator, pNode);
                         return rc;
                     }
                 }
@@ -934,7 +1026,6 @@ static sxi32 ExprExtractNode(ph7_gen_state* pGen, ph7_expr_node** ppNode)
                 rc = ExprAssembleAnnon(&(*pGen), &pCur, pGen->pEnd);
                 if (rc != SXRET_OK)
                 {
-                    SyMemBackendPoolFree(&pGen->pVm->sAllocator, pNode);
                     return rc;
                 }
                 pNode->xCode = PH7_CompileAnnonFunc;
@@ -976,7 +1067,6 @@ static sxi32 ExprExtractNode(ph7_gen_state* pGen, ph7_expr_node** ppNode)
                 {
                     rc = SXERR_SYNTAX;
                 }
-                SyMemBackendPoolFree(&pGen->pVm->sAllocator, pNode);
                 return rc;
             }
         }
@@ -1025,59 +1115,6 @@ PH7_PRIVATE sxi32 PH7_GetNextExpr(SyToken* pStart, SyToken* pEnd, SyToken** ppNe
     return SXRET_OK;
 }
 
-/*
- * Free an expression tree.
- */
-static void ExprFreeTree(ph7_gen_state* pGen, ph7_expr_node* pNode)
-{
-    if (pNode->pLeft)
-    {
-        /* Release the left tree */
-        ExprFreeTree(&(*pGen), pNode->pLeft);
-    }
-    if (pNode->pRight)
-    {
-        /* Release the right tree */
-        ExprFreeTree(&(*pGen), pNode->pRight);
-    }
-    if (pNode->pCond)
-    {
-        /* Release the conditional tree used by the ternary operator */
-        ExprFreeTree(&(*pGen), pNode->pCond);
-    }
-    if (SySetUsed(&pNode->aNodeArgs) > 0)
-    {
-        ph7_expr_node** apArg;
-        sxu32 n;
-        /* Release node arguments */
-        apArg = (ph7_expr_node**)SySetBasePtr(&pNode->aNodeArgs);
-        for (n = 0; n < SySetUsed(&pNode->aNodeArgs); ++n)
-        {
-            ExprFreeTree(&(*pGen), apArg[n]);
-        }
-        SySetRelease(&pNode->aNodeArgs);
-    }
-    /* Finally,release this node */
-    SyMemBackendPoolFree(&pGen->pVm->sAllocator, pNode);
-}
-/*
- * Free an expression tree.
- * This function is a wrapper around ExprFreeTree() defined above.
- */
-PH7_PRIVATE sxi32 PH7_ExprFreeTree(ph7_gen_state* pGen, SySet* pNodeSet)
-{
-    ph7_expr_node** apNode;
-    sxu32 n;
-    apNode = (ph7_expr_node**)SySetBasePtr(pNodeSet);
-    for (n = 0; n < SySetUsed(pNodeSet); ++n)
-    {
-        if (apNode[n])
-        {
-            ExprFreeTree(&(*pGen), apNode[n]);
-        }
-    }
-    return SXRET_OK;
-}
 
 /*
  * Check if the given node is a modifialbe l/r-value.
@@ -1170,14 +1207,13 @@ static sxi32 ExprProcessFuncArguments(ph7_gen_state* pGen, ph7_expr_node* pOp, p
             {
                 PH7_GenCompileError(&(*pGen), E_WARNING, apNode[iNode]->pStart->nLine,
                                     "call-time pass-by-reference is depreceated");
-                ExprFreeTree(&(*pGen), apNode[iNode]);
                 apNode[iNode] = 0;
             }
             ExprMakeTree(&(*pGen), &apNode[iNode], iCur - iNode);
             if (apNode[iNode])
             {
                 /* Put a pointer to the root of the tree in the arguments set */
-                SySetPut(&pOp->aNodeArgs, (const void*)&apNode[iNode]);
+                ExprArenaSetPut(&(*pGen), &pOp->aNodeArgs, (const void*)&apNode[iNode]);
             }
             else
             {
@@ -1279,9 +1315,7 @@ static sxi32 ExprMakeTree(ph7_gen_state* pGen, ph7_expr_node** apNode, sxi32 nTo
                 return rc;
             }
         }
-        /* Free the left and right nodes */
-        ExprFreeTree(&(*pGen), apNode[iLeft]);
-        ExprFreeTree(&(*pGen), apNode[iCur]);
+        /* Discard the left and right nodes,their memory is reclaimed with the expression arena */
         apNode[iLeft] = 0;
         apNode[iCur] = 0;
     }
@@ -1330,9 +1364,7 @@ static sxi32 ExprMakeTree(ph7_gen_state* pGen, ph7_expr_node** apNode, sxi32 nTo
                 return rc;
             }
         }
-        /* Free the left and right nodes */
-        ExprFreeTree(&(*pGen), apNode[iLeft]);
-        ExprFreeTree(&(*pGen), apNode[iCur]);
+        /* Discard the left and right nodes,their memory is reclaimed with the expression arena */
         apNode[iLeft] = 0;
         apNode[iCur] = 0;
     }
@@ -1460,7 +1492,7 @@ static sxi32 ExprMakeTree(ph7_gen_state* pGen, ph7_expr_node** apNode, sxi32 nTo
                         return rc;
                     }
                     /* Link the node to it's index */
-                    SySetPut(&pNode->aNodeArgs, (const void*)&apNode[iCur + 1]);
+                    ExprArenaSetPut(&(*pGen), &pNode->aNodeArgs, (const void*)&apNode[iCur + 1]);
                 }
                 /* Link the node to the tree */
                 pNode->pLeft = apNode[iLeft];
@@ -2004,7 +2036,7 @@ PH7_PRIVATE sxi32 PH7_ExprMakeTree(ph7_gen_state* pGen, SySet* pExprNode, ph7_ex
             return rc;
         }
 /* Save the extracted node */
-        SySetPut(pExprNode, (const void*)&pNode);
+        ExprArenaSetPut(&(*pGen), pExprNode, (const void*)&pNode);
     }
     if (SySetUsed(pExprNode) < 1)
     {
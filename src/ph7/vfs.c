@@ -3244,10 +3244,12 @@ static ph7_int64 StreamReadLine(io_private* pDev, const char** pzData, ph7_int64
  * Note that PH7 IO streams looks like PHP streams but their implementation differ greately.
  * Please refer to the official documentation for a full discussion.
  * This function return a handle on success. Otherwise null.
+ * If pOpened is not NULL,the path of the file that was actually opened [i.e: after the
+ * include path lookup] is appended to it.
  */
 PH7_PRIVATE void* PH7_StreamOpenHandle(ph7_vm* pVm, const ph7_io_stream* pStream, const char* zFile,
                                        int iFlags, int use_include, ph7_value* pResource, int bPushInclude,
-                                       int* pNew)
+                                       int* pNew, SyBlob* pOpened)
 {
     void* pHandle = 0; /* cc warning */
     SyString sFile;
@@ -3269,6 +3271,10 @@ PH7_PRIVATE void* PH7_StreamOpenHandle(ph7_vm* pVm, const ph7_io_stream* pStream
         {
             /*  Open the file directly */
             rc = pStream->xOpen(zFile, iFlags, pResource, &pHandle);
+            if (rc == PH7_OK && pOpened)
+            {
+                SyBlobAppend(pOpened, sFile.zString, sFile.nByte);
+            }
         }
         else
         {
@@ -3297,6 +3303,10 @@ PH7_PRIVATE void* PH7_StreamOpenHandle(ph7_vm* pVm, const ph7_io_stream* pStream
                 rc = pStream->xOpen((const char*)SyBlobData(&sWorker), iFlags, pResource, &pHandle);
                 if (rc == PH7_OK)
                 {
+                    if (pOpened)
+                    {
+                        SyBlobAppend(pOpened, SyBlobData(&sWorker), SyBlobLength(&sWorker));
+                    }
                     if (bPushInclude)
                     {
                         /* Mark as included */
@@ -3324,6 +3334,10 @@ PH7_PRIVATE void* PH7_StreamOpenHandle(ph7_vm* pVm, const ph7_io_stream* pStream
     {
         /* Open the URI direcly */
         rc = pStream->xOpen(zFile, iFlags, pResource, &pHandle);
+        if (rc == PH7_OK && pOpened)
+        {
+            SyBlobAppend(pOpened, sFile.zString, sFile.nByte);
+        }
     }
     if (rc != PH7_OK)
     {
@@ -4063,7 +4077,7 @@ static int PH7_builtin_readfile(ph7_context* pCtx, int nArg, ph7_value** apArg)
     }
     /* Try to open the file in read-only mode */
     pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY,
-                                   use_include, nArg > 2 ? apArg[2] : 0, FALSE, 0);
+                                   use_include, nArg > 2 ? apArg[2] : 0, FALSE, 0, 0);
     if (pHandle == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening '%s'", zFile);
@@ -4151,7 +4165,7 @@ static int PH7_builtin_file_get_contents(ph7_context* pCtx, int nArg, ph7_value*
     /* Try to open the file in read-only mode */
     pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, use_include,
                                    nArg > 2 ? apArg[2] : 0,
-                                   FALSE, 0);
+                                   FALSE, 0, 0);
     if (pHandle == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening '%s'", zFile);
@@ -4285,7 +4299,7 @@ static int PH7_builtin_file_put_contents(ph7_context* pCtx, int nArg, ph7_value*
         }
     }
     pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, iOpenFlags, use_include,
-                                   nArg > 3 ? apArg[3] : 0, FALSE, FALSE);
+                                   nArg > 3 ? apArg[3] : 0, FALSE, FALSE, 0);
     if (pHandle == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening '%s'", zFile);
@@ -4404,7 +4418,7 @@ static int PH7_builtin_file(ph7_context* pCtx, int nArg, ph7_value** apArg)
     }
     /* Try to open the file in read-only mode */
     pDev->pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, use_include,
-                                         nArg > 2 ? apArg[2] : 0, FALSE, 0);
+                                         nArg > 2 ? apArg[2] : 0, FALSE, 0, 0);
     if (pDev->pHandle == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening '%s'", zFile);
@@ -4509,7 +4523,7 @@ static int PH7_builtin_copy(ph7_context* pCtx, int nArg, ph7_value** apArg)
     }
     /* Try to open the source file in a read-only mode */
     pIn = PH7_StreamOpenHandle(pCtx->pVm, pSin, zFile, PH7_IO_OPEN_RDONLY, FALSE, nArg > 2 ? apArg[2] : 0, FALSE,
-                               0);
+                               0, 0);
     if (pIn == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening source: '%s'", zFile);
@@ -4540,7 +4554,7 @@ static int PH7_builtin_copy(ph7_context* pCtx, int nArg, ph7_value** apArg)
     /* Try to open the destination file in a read-write mode */
     pOut = PH7_StreamOpenHandle(pCtx->pVm, pSout, zFile,
                                 PH7_IO_OPEN_CREATE | PH7_IO_OPEN_TRUNC | PH7_IO_OPEN_RDWR, FALSE,
-                                nArg > 2 ? apArg[2] : 0, FALSE, 0);
+                                nArg > 2 ? apArg[2] : 0, FALSE, 0, 0);
     if (pOut == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening destination: '%s'", zFile);
@@ -5430,7 +5444,7 @@ static int PH7_builtin_fopen(ph7_context* pCtx, int nArg, ph7_value** apArg)
     iOpenFlags = StrModeToFlags(pCtx, zMode, imLen);
     /* Try to get a handle */
     pDev->pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zUri, iOpenFlags,
-                                         nArg > 2 ? ph7_value_to_bool(apArg[2]) : FALSE, pResource, FALSE, 0);
+                                         nArg > 2 ? ph7_value_to_bool(apArg[2]) : FALSE, pResource, FALSE, 0, 0);
     if (pDev->pHandle == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening '%s'", zUri);
@@ -5558,7 +5572,7 @@ static int PH7_builtin_md5_file(ph7_context* pCtx, int nArg, ph7_value** apArg)
         raw_output = ph7_value_to_bool(apArg[1]);
     }
     /* Try to open the file in read-only mode */
-    pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, FALSE, 0, FALSE, 0);
+    pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, FALSE, 0, FALSE, 0, 0);
     if (pHandle == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening '%s'", zFile);
@@ -5639,7 +5653,7 @@ static int PH7_builtin_sha1_file(ph7_context* pCtx, int nArg, ph7_value** apArg)
         raw_output = ph7_value_to_bool(apArg[1]);
     }
     /* Try to open the file in read-only mode */
-    pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, FALSE, 0, FALSE, 0);
+    pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, FALSE, 0, FALSE, 0, 0);
     if (pHandle == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening '%s'", zFile);
@@ -5720,7 +5734,7 @@ static int PH7_builtin_parse_ini_file(ph7_context* pCtx, int nArg, ph7_value** a
         return PH7_OK;
     }
     /* Try to open the file in read-only mode */
-    pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, FALSE, 0, FALSE, 0);
+    pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, FALSE, 0, FALSE, 0, 0);
     if (pHandle == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening '%s'", zFile);
@@ -5860,7 +5874,7 @@ static int PH7_builtin_zip_open(ph7_context* pCtx, int nArg, ph7_value** apArg)
         /* FALL THROUGH */
     }
     /* Try to open the file in read-only mode */
-    pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, FALSE, 0, FALSE, 0);
+    pHandle = PH7_StreamOpenHandle(pCtx->pVm, pStream, zFile, PH7_IO_OPEN_RDONLY, FALSE, 0, FALSE, 0, 0);
     if (pHandle == 0)
     {
         ph7_context_throw_error_format(pCtx, PH7_CTX_ERR, "IO error while opening '%s'", zFile);
@@ -142,6 +142,46 @@ struct VmShutdownCB
     ph7_value aArg[10];   /* Callback arguments (10 maximum arguments) */
     int nArg;             /* Total number of given arguments */
 };
+/*
+ * Instance member access instructions [i.e: $this->x, $pObj->method()] carry
+ * an inline cache in their third operand. Each entry records the class of an
+ * object seen at the access site together with the resolved method or attribute
+ * slot so that subsequent executions on instances of the same class skip the
+ * hash lookups. Up to VM_MEMBER_CACHE_SIZE classes are remembered per site,
+ * sites seeing more classes than that fall back to the generic lookup.
+ */
+#define VM_MEMBER_CACHE_SIZE 4
+typedef struct VmMemberCacheEntry VmMemberCacheEntry;
+struct VmMemberCacheEntry
+{
+    ph7_class* pClass;       /* Class of the accessed instance */
+    SyString sName;          /* Member name as it was looked up (Owned by the cache) */
+    ph7_class_method* pMeth; /* Resolved method or NULL for an attribute access */
+    sxu32 nSlot;             /* Resolved attribute slot in the instance layout */
+};
+typedef struct VmMemberCache VmMemberCache;
+struct VmMemberCache
+{
+    VmMemberCacheEntry aEntry[VM_MEMBER_CACHE_SIZE]; /* Per-class entries */
+    sxu32 nEntry;                                    /* Total number of used entries */
+};
+/*
+ * PH7_OP_CALL instructions cache the function table entry they resolved last
+ * in their third operand so that hot call sites skip the hash lookups.
+ * The binding is only honored while the function tables epoch it was
+ * recorded under is current. Refer to the implementation of [PH7_VmInstallUserFunction()],
+ * [PH7_VmInstallForeignFunction()] and [ph7_delete_function()].
+ */
+typedef struct VmCallCache VmCallCache;
+struct VmCallCache
+{
+    SyHashEntry* pEntry; /* Resolved entry in pVm->hFunction or pVm->hHostFunction */
+    sxu32 nEpoch;        /* Function tables epoch the binding was made under */
+    int bHost;           /* TRUE if pEntry belongs to pVm->hHostFunction */
+    int bReadOnly;       /* TRUE if the foreign function never modify its array arguments */
+};
+/* TRUE if the value hold a view of an array literal [See PH7_HashmapShareLiteral()] */
+#define VmIsLiteralView(pObj) (((pObj)->iFlags & MEMOBJ_HASHMAP) && ((ph7_hashmap*)(pObj)->x.pOther)->pLiteral)
 /* Uncaught exception code value */
 #define PH7_EXCEPTION -255
 /*
@@ -206,13 +246,15 @@ PH7_PRIVATE sxi32 PH7_VmRegisterConstant(
     ph7_vm* pVm,            /* Target VM */
     const SyString* pName,  /* Constant name */
     ProcConstant xExpand,   /* Constant expansion callback */
-    void* pUserData         /* Last argument to xExpand() */
+    void* pUserData,        /* Last argument to xExpand() */
+    sxi32 iFlags            /* Constant flags (PH7_CONSTANT_IMMUTABLE) */
 )
 {
     ph7_constant* pCons;
     SyHashEntry* pEntry;
     char* zDupName;
     sxi32 rc;
+    pVm->nDeclared++;
     pEntry = SyHashGet(&pVm->hConstant, (const void*)pName->zString, pName->nByte);
     if (pEntry != NULL)
     {
@@ -220,6 +262,8 @@ PH7_PRIVATE sxi32 PH7_VmRegisterConstant(
         pCons = (ph7_constant*)pEntry->pUserData;
         pCons->xExpand = xExpand;
         pCons->pUserData = pUserData;
+        pCons->iFlags = iFlags;
+        pCons->nLitIdx = 0;
         return SXRET_OK;
     }
 /* Allocate a new constant instance */
@@ -239,6 +283,8 @@ PH7_PRIVATE sxi32 PH7_VmRegisterConstant(
     SyStringInitFromBuf(&pCons->sName, zDupName, pName->nByte);
     pCons->xExpand = xExpand;
     pCons->pUserData = pUserData;
+    pCons->iFlags = iFlags;
+    pCons->nLitIdx = 0;
     rc = SyHashInsert(&pVm->hConstant, (const void*)zDupName, SyStringLength(&pCons->sName), pCons);
     if (rc != SXRET_OK)
     {
@@ -318,6 +364,7 @@ PH7_PRIVATE sxi32 PH7_VmInstallForeignFunction(
         pFunc->pUserData = pUserData;
         pFunc->xFunc = xFunc;
         SySetReset(&pFunc->aAux);
+        pVm->nFuncEpoch++;
         return SXRET_OK;
     }
 /* Create a new user function */
@@ -334,6 +381,8 @@ PH7_PRIVATE sxi32 PH7_VmInstallForeignFunction(
         SyMemBackendPoolFree(&pVm->sAllocator, pFunc);
         return rc;
     }
+/* Invalidate call sites bound to the previous function tables */
+    pVm->nFuncEpoch++;
 /* User function successfully installed */
     return SXRET_OK;
 }
@@ -383,6 +432,7 @@ PH7_PRIVATE sxi32 PH7_VmInstallUserFunction(
 /* Use the built-in name */
         pName = &pFunc->sName;
     }
+    pVm->nDeclared++;
 /* Check for duplicates (functions with the same name) first */
     pEntry = SyHashGet(&pVm->hFunction, pName->zString, pName->nByte);
     if (pEntry != NULL)
@@ -393,14 +443,91 @@ PH7_PRIVATE sxi32 PH7_VmInstallUserFunction(
 /* Link */
             pFunc->pNextName = pLink;
             pEntry->pUserData = pFunc;
+            pVm->nFuncEpoch++;
         }
         return SXRET_OK;
     }
 /* First time seen */
     pFunc->pNextName = 0;
     rc = SyHashInsert(&pVm->hFunction, pName->zString, pName->nByte, pFunc);
+/* A user function may shadow a foreign one already bound to a call site */
+    pVm->nFuncEpoch++;
     return rc;
 }
+/*
+ * Precompute the default value of an instance attribute when it is a plain
+ * literal [i.e: public $a = 'abc',$b = -1,$c = array(1,2)] so that objects are
+ * initialized by a simple copy rather than executing the attribute bytecode for
+ * each new instance. Complex defaults [PH7 extension: public $a = rand() & 1023]
+ * are still evaluated per instance.
+ */
+static void VmClassAttrTemplate(ph7_vm* pVm, ph7_class_attr* pAttr)
+{
+    ph7_value* pDefault = &pAttr->sDefault;
+    VmInstr* aInstr;
+    ph7_value* pObj;
+    sxu32 nInstr;
+    if (pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC | PH7_CLASS_ATTR_TEMPLATE))
+    {
+        /* Not an instance attribute or already processed */
+        return;
+    }
+    aInstr = (VmInstr*)SySetBasePtr(&pAttr->aByteCode);
+    nInstr = SySetUsed(&pAttr->aByteCode);
+    /* Expected bytecodes: LOADC [UMINUS] DONE or LOAD_MAP DONE */
+    if (nInstr < 2 || nInstr > 3 || aInstr[nInstr - 1].iOp != PH7_OP_DONE)
+    {
+        return;
+    }
+    if (aInstr[0].iOp == PH7_OP_LOAD_MAP && aInstr[0].iP2 > 0 && nInstr == 2)
+    {
+        /* Constant array literal,copied on each instantiation */
+        pObj = (ph7_value*)SySetAt(&pVm->aLitObj, aInstr[0].iP2);
+        if (pObj == 0 || (pObj->iFlags & MEMOBJ_HASHMAP) == 0)
+        {
+            return;
+        }
+        PH7_MemObjInit(&(*pVm), pDefault);
+        PH7_MemObjLoad(pObj, pDefault);
+    }
+    else if (aInstr[0].iOp == PH7_OP_LOADC && aInstr[0].iP1 == 0 /* Not subject to constant expansion */)
+    {
+        pObj = (ph7_value*)SySetAt(&pVm->aLitObj, aInstr[0].iP2);
+        if (pObj == 0 || (pObj->iFlags & MEMOBJ_HASHMAP))
+        {
+            return;
+        }
+        if (nInstr == 3)
+        {
+            if (aInstr[1].iOp != PH7_OP_UMINUS || (pObj->iFlags & (MEMOBJ_INT | MEMOBJ_REAL)) == 0)
+            {
+                return;
+            }
+            PH7_MemObjInit(&(*pVm), pDefault);
+            PH7_MemObjLoad(pObj, pDefault);
+            /* Negative number [i.e: public $a = -1] */
+            if (pDefault->iFlags & MEMOBJ_REAL)
+            {
+                pDefault->rVal = -pDefault->rVal;
+            }
+            if (pDefault->iFlags & MEMOBJ_INT)
+            {
+                pDefault->x.iVal = -pDefault->x.iVal;
+            }
+        }
+        else
+        {
+            PH7_MemObjInit(&(*pVm), pDefault);
+            PH7_MemObjLoad(pObj, pDefault);
+        }
+    }
+    else
+    {
+        return;
+    }
+    pDefault->nIdx = SXU32_HIGH; /* Mark as constant */
+    pAttr->iFlags |= PH7_CLASS_ATTR_TEMPLATE;
+}
 /*
  * Install a user defined class in the corresponding VM container.
  */
@@ -412,6 +539,13 @@ PH7_PRIVATE sxi32 PH7_VmInstallClass(
     SyString* pName = &pClass->sName;
     SyHashEntry* pEntry;
     sxi32 rc;
+    pVm->nDeclared++;
+/* Precompute literal defaults of the instance attributes declared by this class */
+    SyHashResetLoopCursor(&pClass->hAttr);
+    while ((pEntry = SyHashGetNextEntry(&pClass->hAttr)) != 0)
+    {
+        VmClassAttrTemplate(&(*pVm), (ph7_class_attr*)pEntry->pUserData);
+    }
 /* Check for duplicates */
     pEntry = SyHashGet(&pVm->hClass, (const void*)pName->zString, pName->nByte);
     if (pEntry != NULL)
@@ -814,8 +948,11 @@ static sxi32 VmLocalExec(ph7_vm* pVm, SySet* pByteCode, ph7_value* pResult);
 static sxi32 VmErrorFormat(ph7_vm* pVm, sxi32 iErr, const char* zFormat, ...);
 
 /*
- * Mount a compiled class into the freshly created vitual machine so that
+ * Mount a compiled class into the running vitual machine so that
  * it can be instanciated from the executed PHP script.
+ * Classes are mounted on first use [i.e: PH7_VmExtractClass()] rather than
+ * when the VM is made ready so that the work done per request scales with
+ * the classes actually used by the script.
  */
 static sxi32 VmMountUserClass(
     ph7_vm* pVm,      /* Target VM */
@@ -826,14 +963,21 @@ static sxi32 VmMountUserClass(
     ph7_class_attr* pAttr;
     SyHashEntry* pEntry;
     sxi32 rc;
+    if (pClass->iFlags & PH7_CLASS_MOUNTED)
+    {
+        /* Already mounted */
+        return SXRET_OK;
+    }
+    /* Mark as mounted first so that attributes referring to this class do not recurse */
+    pClass->iFlags |= PH7_CLASS_MOUNTED;
     /* Reset the loop cursor */
     SyHashResetLoopCursor(&pClass->hAttr);
-    /* Process only static and constant attribute */
+    /* Process only static and constant attribute not yet mounted by a related class */
     while ((pEntry = SyHashGetNextEntry(&pClass->hAttr)) != 0)
     {
         /* Extract the current attribute */
         pAttr = (ph7_class_attr*)pEntry->pUserData;
-        if (pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC))
+        if ((pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC)) && pAttr->nIdx == SXU32_HIGH)
         {
             ph7_value* pMemObj;
             /* Reserve a memory object for this constant/static attribute */
@@ -892,6 +1036,63 @@ static sxi32 VmMountUserClass(
     }
     return SXRET_OK;
 }
+/* Forward declaration */
+static VmRefObj* VmRefObjExtract(ph7_vm* pVm, sxu32 nObjIdx);
+
+/*
+ * Store the default value of a non-static class attribute in the memory object
+ * at index nIdx.
+ * The value is computed first since the memory object table may grow meanwhile.
+ */
+static sxi32 VmClassAttrInitValue(ph7_vm* pVm, ph7_class_attr* pAttr, sxu32 nIdx)
+{
+    ph7_value sValue, * pMemObj;
+    PH7_MemObjInit(&(*pVm), &sValue);
+    if (pAttr->iFlags & PH7_CLASS_ATTR_TEMPLATE)
+    {
+/* Copy the precomputed default value */
+        if (pAttr->sDefault.iFlags & MEMOBJ_HASHMAP)
+        {
+            ph7_hashmap* pSrc = (ph7_hashmap*)pAttr->sDefault.x.pOther;
+            ph7_hashmap* pMap;
+            if (pSrc->iFlags & HASHMAP_LITERAL)
+            {
+                /* Scalar values only,share them until the first modification */
+                pMap = PH7_HashmapShareLiteral(&(*pVm), pSrc);
+            }
+            else
+            {
+                pMap = PH7_HashmapDupLiteral(&(*pVm), pSrc);
+            }
+            if (pMap == 0)
+            {
+                return SXERR_MEM;
+            }
+            PH7_MemObjInitFromArray(&(*pVm), &sValue, pMap);
+        }
+        else
+        {
+            PH7_MemObjLoad(&pAttr->sDefault, &sValue);
+        }
+    }
+    else if (SySetUsed(&pAttr->aByteCode) > 0)
+    {
+/* Initialize attribute default value (any complex expression) */
+        VmLocalExec(&(*pVm), &pAttr->aByteCode, &sValue);
+    }
+    else
+    {
+/* No default value */
+        return SXRET_OK;
+    }
+    pMemObj = (ph7_value*)SySetAt(&pVm->aMemObj, nIdx);
+    if (pMemObj)
+    {
+        PH7_MemObjStore(&sValue, pMemObj);
+    }
+    PH7_MemObjRelease(&sValue);
+    return SXRET_OK;
+}
 /*
  * Allocate a private frame for attributes of the given
  * class instance (Object in the PHP jargon).
@@ -901,22 +1102,17 @@ PH7_PRIVATE sxi32 PH7_VmCreateClassInstanceFrame(
     ph7_class_instance* pObj /* Class instance */
 )
 {
-    ph7_class* pClass = pObj->pClass;
+    ph7_class_attr** apAttr;
     ph7_class_attr* pAttr;
-    SyHashEntry* pEntry;
     sxi32 rc;
-/* Install class attribute in the private frame associated with this instance */
-    SyHashResetLoopCursor(&pClass->hAttr);
-    while ((pEntry = SyHashGetNextEntry(&pClass->hAttr)) != 0)
+    sxu32 n;
+/* Install class attributes at the slots given by the class layout */
+    apAttr = (ph7_class_attr**)SySetBasePtr(&pObj->pClass->aLayout);
+    for (n = 0; n < pObj->nAttr; ++n)
     {
-        VmClassAttr* pVmAttr;
+        VmClassAttr* pVmAttr = &pObj->aAttr[n];
 /* Extract the current attribute */
-        pAttr = (ph7_class_attr*)pEntry->pUserData;
-        pVmAttr = (VmClassAttr*)SyMemBackendPoolAlloc(&pVm->sAllocator, sizeof(VmClassAttr));
-        if (pVmAttr == 0)
-        {
-            return SXERR_MEM;
-        }
+        pAttr = apAttr[n];
         pVmAttr->pAttr = pAttr;
         if ((pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC)) == 0)
         {
@@ -925,46 +1121,95 @@ PH7_PRIVATE sxi32 PH7_VmCreateClassInstanceFrame(
             pMemObj = PH7_ReserveMemObj(&(*pVm));
             if (pMemObj == 0)
             {
-                SyMemBackendPoolFree(&pVm->sAllocator, pVmAttr);
                 return SXERR_MEM;
             }
             pVmAttr->nIdx = pMemObj->nIdx;
-            if (SySetUsed(&pAttr->aByteCode) > 0)
-            {
-/* Initialize attribute default value (any complex expression) */
-                VmLocalExec(&(*pVm), &pAttr->aByteCode, pMemObj);
-            }
-            rc = SyHashInsert(&pObj->hAttr, SyStringData(&pAttr->sName), SyStringLength(&pAttr->sName), pVmAttr);
+            rc = VmClassAttrInitValue(&(*pVm), pAttr, pVmAttr->nIdx);
             if (rc != SXRET_OK)
             {
-                VmSlot sSlot;
-/* Restore memory object */
-                sSlot.nIdx = pMemObj->nIdx;
-                sSlot.pUserData = 0;
-                SySetPut(&pVm->aFreeObj, (const void*)&sSlot);
-                SyMemBackendPoolFree(&pVm->sAllocator, pVmAttr);
-                return SXERR_MEM;
+                return rc;
             }
 /* Install attribute in the reference table */
-            PH7_VmRefObjInstall(&(*pVm), pMemObj->nIdx, 0, 0, VM_REF_IDX_KEEP);
+            PH7_VmRefObjInstall(&(*pVm), pVmAttr->nIdx, 0, 0, VM_REF_IDX_KEEP);
         }
         else
         {
 /* Install static/constant attribute */
             pVmAttr->nIdx = pAttr->nIdx;
-            rc = SyHashInsert(&pObj->hAttr, SyStringData(&pAttr->sName), SyStringLength(&pAttr->sName), pVmAttr);
+        }
+    }
+    return SXRET_OK;
+}
+/*
+ * Reinitialize the attributes of a recycled class instance.
+ * The memory objects reserved by [PH7_VmCreateClassInstanceFrame()] are kept
+ * and only their values are set back to the attribute defaults.
+ */
+PH7_PRIVATE sxi32 PH7_VmResetClassInstanceFrame(ph7_vm* pVm, ph7_class_instance* pObj)
+{
+    ph7_value* pMemObj;
+    sxi32 rc;
+    sxu32 n;
+    for (n = 0; n < pObj->nAttr; ++n)
+    {
+        VmClassAttr* pVmAttr = &pObj->aAttr[n];
+        if ((pVmAttr->pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC)) == 0)
+        {
+            pMemObj = (ph7_value*)SySetAt(&pVm->aMemObj, pVmAttr->nIdx);
+            if (pMemObj == 0)
+            {
+                return SXERR_CORRUPT;
+            }
+            rc = VmClassAttrInitValue(&(*pVm), pVmAttr->pAttr, pVmAttr->nIdx);
             if (rc != SXRET_OK)
             {
-                SyMemBackendPoolFree(&pVm->sAllocator, pVmAttr);
-                return SXERR_MEM;
+                return rc;
+            }
+        }
+    }
+    return SXRET_OK;
+}
+/*
+ * Release the attribute values of a dead class instance but keep the
+ * memory objects holding them so that the instance can be recycled.
+ * This is only possible when no variable or array entry still references
+ * one of the attributes [i.e: $a = &$pObj->x],in which case SXERR_BUSY
+ * is returned and nothing is released.
+ */
+PH7_PRIVATE sxi32 PH7_VmRecycleClassInstanceFrame(ph7_vm* pVm, ph7_class_instance* pObj)
+{
+    VmClassAttr* pVmAttr;
+    ph7_value* pMemObj;
+    VmRefObj* pRef;
+    sxu32 n;
+/* Make sure the attributes are not referenced elsewhere */
+    for (n = 0; n < pObj->nAttr; ++n)
+    {
+        pVmAttr = &pObj->aAttr[n];
+        if ((pVmAttr->pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC)) == 0)
+        {
+            pRef = VmRefObjExtract(&(*pVm), pVmAttr->nIdx);
+            if (pRef == 0 || SySetUsed(&pRef->aReference) > 0 || SySetUsed(&pRef->aArrEntries) > 0)
+            {
+                return SXERR_BUSY;
+            }
+        }
+    }
+/* Release the values only */
+    for (n = 0; n < pObj->nAttr; ++n)
+    {
+        pVmAttr = &pObj->aAttr[n];
+        if ((pVmAttr->pAttr->iFlags & (PH7_CLASS_ATTR_CONSTANT | PH7_CLASS_ATTR_STATIC)) == 0)
+        {
+            pMemObj = (ph7_value*)SySetAt(&pVm->aMemObj, pVmAttr->nIdx);
+            if (pMemObj)
+            {
+                PH7_MemObjRelease(pMemObj);
             }
         }
     }
     return SXRET_OK;
 }
-
-/* Forward declaration */
-static VmRefObj* VmRefObjExtract(ph7_vm* pVm, sxu32 nObjIdx);
 
 static sxi32 VmRefObjUnlink(ph7_vm* pVm, VmRefObj* pRef);
 
@@ -1025,6 +1270,8 @@ PH7_PRIVATE ph7_value* VmReserveMemObj(ph7_vm* pVm, sxu32* pIndex)
 
 /* Forward declaration */
 static sxi32 VmEvalChunk(ph7_vm* pVm, ph7_context* pCtx, SyString* pChunk, int iFlags, int bTrueReturn);
+static void VmEvalCacheTrim(ph7_vm* pVm, sxu32 nEntry, sxu32 nByte);
+static sxi32 VmPreloadFiles(ph7_vm* pVm, const char** azPath, sxu32 nPath, sxu32 nThread);
 /*
  * Built-in classes/interfaces and some functions that cannot be implemented
  * directly as foreign functions.
@@ -1389,9 +1636,22 @@ PH7_PRIVATE sxi32 PH7_VmInit(
     SyBlobInit(&pVm->sArgv, &pVm->sAllocator);
     SySetInit(&pVm->aLitObj, &pVm->sAllocator, sizeof(ph7_value));
     SySetAlloc(&pVm->aLitObj, 0xFF);
+/* Allocate the reference table now since constant array literals are built at compile-time */
+    pVm->nRefSize = 0x10; /* Must be a power of two for fast arithemtic */
+    pVm->apRefObj = (VmRefObj**)SyMemBackendAlloc(&pVm->sAllocator, sizeof(VmRefObj*) * pVm->nRefSize);
+    if (pVm->apRefObj == 0)
+    {
+        rc = SXERR_MEM;
+        goto Err;
+    }
+/* Zero the reference table */
+    SyZero(pVm->apRefObj, sizeof(VmRefObj*) * pVm->nRefSize);
     SyHashInit(&pVm->hHostFunction, &pVm->sAllocator, 0, 0);
     SyHashInit(&pVm->hFunction, &pVm->sAllocator, 0, 0);
     SyHashInit(&pVm->hClass, &pVm->sAllocator, SyStrHash, SyStrnmicmp);
+    SyHashInit(&pVm->hAutoload, &pVm->sAllocator, SyStrHash, SyStrnmicmp);
+    SyHashInit(&pVm->hPreload, &pVm->sAllocator, 0, 0);
+    SyHashInit(&pVm->hEvalCache, &pVm->sAllocator, 0, 0);
     SyHashInit(&pVm->hConstant, &pVm->sAllocator, 0, 0);
     SyHashInit(&pVm->hSuper, &pVm->sAllocator, 0, 0);
     SyHashInit(&pVm->hPDO, &pVm->sAllocator, 0, 0);
@@ -1417,6 +1677,12 @@ PH7_PRIVATE sxi32 PH7_VmInit(
 #else
     pVm->nMaxDepth = 16;
 #endif
+/* Builtin sort functions are single threaded by default */
+    pVm->nSortThread = 1;
+    pVm->nSortThreshold = PH7_SORT_THREAD_THRESHOLD;
+/* Compiled chunk cache limits */
+    pVm->nEvalMax = PH7_EVAL_CACHE_ENTRIES;
+    pVm->nEvalMaxByte = PH7_EVAL_CACHE_BYTES;
 /* Default assertion flags */
     pVm->iAssertFlags = PH7_ASSERT_WARNING; /* Issue a warning for each failed assertion */
 /* JSON return status */
@@ -1447,6 +1713,14 @@ PH7_PRIVATE sxi32 PH7_VmInit(
         goto Err;
     }
     PH7_MemObjInitFromBool(pVm, pObj, 0);
+/* Register built-in functions [i.e: is_null(), array_diff(), strlen(), etc.]
+ * before compilation so that calls to pure built-ins can be folded.
+ */
+    PH7_RegisterBuiltInFunction(&(*pVm));
+/* Register built-in constants [i.e: PHP_EOL, PHP_OS...] before compilation
+ * so that immutable ones can be inlined in the literal table.
+ */
+    PH7_RegisterBuiltInConstant(&(*pVm));
 /* Create the global frame */
     rc = VmEnterFrame(&(*pVm), 0, 0, 0);
     if (rc != SXRET_OK)
@@ -1475,6 +1749,9 @@ PH7_PRIVATE sxi32 PH7_VmInit(
     SyStringInitFromBuf(&sBuiltin, PH7_BUILTIN_LIB, sizeof(PH7_BUILTIN_LIB) - 1);
 /* Compile the built-in library */
     VmEvalChunk(&(*pVm), 0, &sBuiltin, PH7_PHP_ONLY, FALSE);
+/* Remember what the built-in library declared */
+    pVm->nBuiltinFunc = SyHashTotalEntry(&pVm->hFunction);
+    pVm->nBuiltinClass = SyHashTotalEntry(&pVm->hClass);
 /* Reset the code generator */
     PH7_ResetCodeGenerator(&(*pVm), pEngine->xConf.xErr, pEngine->xConf.pErrData);
     return SXRET_OK;
@@ -1557,7 +1834,6 @@ PH7_PRIVATE sxi32 PH7_VmMakeReady(
     ph7_vm* pVm /* Target VM */
 )
 {
-    SyHashEntry* pEntry;
     sxi32 rc;
     if (pVm->nMagic != PH7_VM_INIT)
     {
@@ -1574,6 +1850,8 @@ PH7_PRIVATE sxi32 PH7_VmMakeReady(
     {
         return SXERR_MEM;
     }
+/* Optimize the main script */
+    PH7_OptimizeByteCode(&(*pVm), pVm->pByteContainer);
 /* Script return value */
     PH7_MemObjInit(&(*pVm), &pVm->sExec); /* Assume a NULL return value */
 /* Allocate a new operand stack */
@@ -1586,16 +1864,6 @@ PH7_PRIVATE sxi32 PH7_VmMakeReady(
  * private data. */
     pVm->sVmConsumer.xConsumer = PH7_VmBlobConsumer;
     pVm->sVmConsumer.pUserData = &pVm->sConsumer;
-/* Allocate the reference table */
-    pVm->nRefSize = 0x10; /* Must be a power of two for fast arithemtic */
-    pVm->apRefObj = (VmRefObj**)SyMemBackendAlloc(&pVm->sAllocator, sizeof(VmRefObj*) * pVm->nRefSize);
-    if (pVm->apRefObj == 0)
-    {
-/* Don't worry about freeing memory, everything will be released shortly */
-        return SXERR_MEM;
-    }
-/* Zero the reference table */
-    SyZero(pVm->apRefObj, sizeof(VmRefObj*) * pVm->nRefSize);
 /* Register special functions first [i.e: print, json_encode(), func_get_args(), die, etc.] */
     rc = VmRegisterSpecialFunction(&(*pVm));
     if (rc != SXRET_OK)
@@ -1610,20 +1878,7 @@ PH7_PRIVATE sxi32 PH7_VmMakeReady(
 /* Don't worry about freeing memory, everything will be released shortly */
         return rc;
     }
-/* Register built-in constants [i.e: PHP_EOL, PHP_OS...] */
-    PH7_RegisterBuiltInConstant(&(*pVm));
-/* Register built-in functions [i.e: is_null(), array_diff(), strlen(), etc.] */
-    PH7_RegisterBuiltInFunction(&(*pVm));
-/* Initialize and install static and constants class attributes */
-    SyHashResetLoopCursor(&pVm->hClass);
-    while ((pEntry = SyHashGetNextEntry(&pVm->hClass)) != 0)
-    {
-        rc = VmMountUserClass(&(*pVm), (ph7_class*)pEntry->pUserData);
-        if (rc != SXRET_OK)
-        {
-            return rc;
-        }
-    }
+/* Static and constants class attributes are initialized when the class is first used */
 /* Random number betwwen 0 and 1023 used to generate unique ID */
     pVm->unique_id = PH7_VmRandomNum(&(*pVm)) & 1023;
 /* VM is ready for bytecode execution */
@@ -2083,6 +2338,29 @@ PH7_PRIVATE sxi32 PH7_VmConfigure(ph7_vm* pVm, sxi32 nOp, va_list ap)
 /* Run-Time Error report */
             pVm->bErrReport = 1;
             break;
+        case PH7_VM_CONFIG_DUMP_FULL:
+/* Full bytecode dump */
+            pVm->bDumpFull = 1;
+            break;
+        case PH7_VM_CONFIG_EVAL_CACHE:
+        {
+/* Compiled chunk cache limits */
+            int nEntry = va_arg(ap, int);
+            unsigned int nMaxByte = va_arg(ap, unsigned int);
+            if (nEntry < 0)
+            {
+                rc = SXERR_INVALID;
+                break;
+            }
+            pVm->nEvalMax = (sxu32)nEntry;
+            if (nMaxByte > 0)
+            {
+                pVm->nEvalMaxByte = nMaxByte;
+            }
+            /* Evict what no longer fits */
+            VmEvalCacheTrim(&(*pVm), pVm->nEvalMax, pVm->nEvalMaxByte);
+            break;
+        }
         case PH7_VM_CONFIG_RECURSION_DEPTH:
         {
 /* Recursion depth */
@@ -2295,6 +2573,91 @@ PH7_PRIVATE sxi32 PH7_VmConfigure(ph7_vm* pVm, sxi32 nOp, va_list ap)
             pVm->xErrLog = xErrLog;
             break;
         }
+        case PH7_VM_CONFIG_SORT_THREAD:
+        {
+/* Number of threads used by the builtin sort functions */
+            int nThread = va_arg(ap, int);
+            unsigned int nThreshold = va_arg(ap, unsigned int);
+            if (nThread < 1 || nThread > PH7_SORT_THREAD_MAX)
+            {
+                rc = SXERR_INVALID;
+                break;
+            }
+#ifndef PH7_ENABLE_THREADS
+            if (nThread > 1)
+            {
+                /* Threading support was omitted at compile-time */
+                rc = SXERR_NOTIMPLEMENTED;
+                break;
+            }
+#endif
+            pVm->nSortThread = (sxu32)nThread;
+            if (nThreshold > 0)
+            {
+                pVm->nSortThreshold = nThreshold;
+            }
+            break;
+        }
+        case PH7_VM_CONFIG_PRELOAD_FILES:
+        {
+/* Load a batch of scripts ahead of include/require */
+            const char** azPath = va_arg(ap, const char **);
+            int nPath = va_arg(ap, int);
+            int nThread = va_arg(ap, int);
+            if (azPath == 0 || nPath < 1 || nThread < 1 || nThread > PH7_PRELOAD_THREAD_MAX)
+            {
+                rc = SXERR_INVALID;
+                break;
+            }
+#ifndef PH7_ENABLE_THREADS
+            if (nThread > 1)
+            {
+                /* Threading support was omitted at compile-time */
+                rc = SXERR_NOTIMPLEMENTED;
+                break;
+            }
+#endif
+            rc = VmPreloadFiles(&(*pVm), azPath, (sxu32)nPath, (sxu32)nThread);
+            break;
+        }
+        case PH7_VM_CONFIG_AUTOLOAD_CLASS:
+        {
+/* Autoload index entry: script to load the first time the class is requested */
+            const char* zClass = va_arg(ap, const char *);
+            const char* zPath = va_arg(ap, const char *);
+            SyHashEntry* pEntry;
+            char* zKey, * zDup;
+            sxu32 nLen;
+            if (SX_EMPTY_STR(zClass) || SX_EMPTY_STR(zPath))
+            {
+                rc = SXERR_EMPTY;
+                break;
+            }
+            zDup = SyMemBackendStrDup(&pVm->sAllocator, zPath, SyStrlen(zPath));
+            if (zDup == 0)
+            {
+                rc = SXERR_MEM;
+                break;
+            }
+            nLen = SyStrlen(zClass);
+            pEntry = SyHashGet(&pVm->hAutoload, (const void*)zClass, nLen);
+            if (pEntry != NULL)
+            {
+/* Overwrite the previous entry */
+                SyMemBackendFree(&pVm->sAllocator, pEntry->pUserData);
+                pEntry->pUserData = zDup;
+                break;
+            }
+            zKey = SyMemBackendStrDup(&pVm->sAllocator, zClass, nLen);
+            if (zKey == 0)
+            {
+                SyMemBackendFree(&pVm->sAllocator, zDup);
+                rc = SXERR_MEM;
+                break;
+            }
+            rc = SyHashInsert(&pVm->hAutoload, (const void*)zKey, nLen, zDup);
+            break;
+        }
         case PH7_VM_CONFIG_EXEC_VALUE:
         {
 /* Script return value */
@@ -2386,12 +2749,6 @@ static const char* VmInstrToString(sxi32 nOp);
  */
 static sxi32 VmByteCodeDump(SySet* pByteCode, ProcConsumer xConsumer, void* pUserData)
 {
-    static const char zDump[] = {
-        "====================================================\n"
-        "PH7 VM Dump   Copyright (C) 2011-2012 Symisc Systems\n"
-        "                              http://www.symisc.net/\n"
-        "====================================================\n"
-    };
     VmInstr* pInstr, * pEnd;
     sxi32 rc = SXRET_OK;
     sxu32 n;
@@ -2399,7 +2756,6 @@ static sxi32 VmByteCodeDump(SySet* pByteCode, ProcConsumer xConsumer, void* pUse
     pInstr = (VmInstr*)SySetBasePtr(pByteCode);
     pEnd = &pInstr[SySetUsed(pByteCode)];
     n = 0;
-    xConsumer((const void*)zDump, sizeof(zDump) - 1, pUserData);
     /* Dump instructions */
     for (;;)
     {
@@ -2578,37 +2934,486 @@ static sxi32 VmThrowErrorAp(
     return rc;
 }
 
-/**
- * Format and throw a run-time error and invoke the supplied VM output consumer callback.
- * Refer to the implementation of [ph7_context_throw_error_format()] for additional information.
- * ------------------------------------
- * Simple boring wrapper function.
- * ------------------------------------
+/**
+ * Format and throw a run-time error and invoke the supplied VM output consumer callback.
+ * Refer to the implementation of [ph7_context_throw_error_format()] for additional information.
+ * ------------------------------------
+ * Simple boring wrapper function.
+ * ------------------------------------
+ */
+static sxi32 VmErrorFormat(ph7_vm* pVm, sxi32 iErr, const char* zFormat, ...)
+{
+    va_list ap;
+    sxi32 rc;
+    va_start(ap, zFormat);
+    rc = VmThrowErrorAp(&(*pVm), 0, iErr, zFormat, ap);
+    va_end(ap);
+
+    return rc;
+}
+
+/**
+ * Format and throw a run-time error and invoke the supplied VM output consumer callback.
+ * Refer to the implementation of [ph7_context_throw_error_format()] for additional
+ * information.
+ * ------------------------------------
+ * Simple boring wrapper function.
+ * ------------------------------------
+ */
+PH7_PRIVATE sxi32 PH7_VmThrowErrorAp(ph7_vm* pVm, SyString* pFuncName, sxi32 iErr, const char* zFormat, va_list ap)
+{
+    sxi32 rc;
+    rc = VmThrowErrorAp(&(*pVm), &(*pFuncName), iErr, zFormat, ap);
+    return rc;
+}
+
+/*
+ * Look up the inline cache of a member access instruction for an entry
+ * matching the given class and member name.
+ * Return the cached entry on success.NULL otherwise.
+ * Class definitions are immutable once installed and a redeclared class gets
+ * a fresh ph7_class instance, so a (class, name) pair never goes stale.
+ */
+static VmMemberCacheEntry* VmMemberCacheLookup(VmInstr* pInstr, ph7_class* pClass, const SyString* pName)
+{
+    VmMemberCache* pCache = (VmMemberCache*)pInstr->p3;
+    VmMemberCacheEntry* pEntry;
+    sxu32 n;
+    if (pCache == 0)
+    {
+        return 0;
+    }
+    for (n = 0; n < pCache->nEntry; ++n)
+    {
+        pEntry = &pCache->aEntry[n];
+        /* The member name is checked as well since it may be computed at run-time [i.e: $pObj->$zName] */
+        if (pEntry->pClass == pClass && pEntry->sName.nByte == pName->nByte &&
+            SyMemcmp(pEntry->sName.zString, pName->zString, pName->nByte) == 0)
+        {
+            return pEntry;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Record a resolved method or attribute slot in the inline cache of
+ * a member access instruction. The cache is allocated on first use.
+ * Sites that already remember VM_MEMBER_CACHE_SIZE classes are left untouched.
+ */
+static void VmMemberCacheInsert(ph7_vm* pVm, VmInstr* pInstr, ph7_class* pClass, const SyString* pName,
+                                ph7_class_method* pMeth, sxu32 nSlot)
+{
+    VmMemberCache* pCache = (VmMemberCache*)pInstr->p3;
+    VmMemberCacheEntry* pEntry;
+    char* zName;
+    if (pCache == 0)
+    {
+        pCache = (VmMemberCache*)SyMemBackendPoolAlloc(&pVm->sAllocator, sizeof(VmMemberCache));
+        if (pCache == 0)
+        {
+            return;
+        }
+        SyZero(pCache, sizeof(VmMemberCache));
+        pInstr->p3 = pCache;
+    }
+    if (pCache->nEntry >= VM_MEMBER_CACHE_SIZE)
+    {
+        /* Megamorphic site */
+        return;
+    }
+    pEntry = &pCache->aEntry[pCache->nEntry];
+    /* Record the name as it was looked up so that later lookups with the same name hit */
+    zName = SyMemBackendStrDup(&pVm->sAllocator, pName->zString, pName->nByte);
+    if (zName == 0)
+    {
+        return;
+    }
+    pCache->nEntry++;
+    pEntry->pClass = pClass;
+    SyStringInitFromBuf(&pEntry->sName, zName, pName->nByte);
+    pEntry->pMeth = pMeth;
+    pEntry->nSlot = nSlot;
+}
+
+/*
+ * Foreign functions that only read the arrays they are given,including their
+ * internal cursor. Shared array literals are passed to them as is.
+ */
+static const char* azReadOnlyFunc[] = {
+    "count", "sizeof", "isset", "empty", "is_array", "in_array", "array_key_exists", "key_exists",
+    "array_search", "array_keys", "array_values", "array_sum", "implode", "join", "var_dump", "print_r",
+    "json_encode"
+};
+/*
+ * Check whether the given foreign function is listed above.
+ */
+static int VmIsReadOnlyFunc(const SyString* pName)
+{
+    sxu32 n;
+    for (n = 0; n < SX_ARRAYSIZE(azReadOnlyFunc); ++n)
+    {
+        if (SyStrlen(azReadOnlyFunc[n]) == pName->nByte &&
+            SyMemcmp(azReadOnlyFunc[n], pName->zString, pName->nByte) == 0)
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+/*
+ * Resolve the target of a PH7_OP_CALL instruction.
+ * Compiled functions are looked up first,then foreign functions. The result
+ * is bound to the call site so that later executions with the same function
+ * name only pay a name comparison until the function tables change.
+ * Return the function table entry on success.NULL if no such function.
+ */
+static SyHashEntry* VmCallResolve(ph7_vm* pVm, VmInstr* pInstr, const SyString* pName, int* pHost)
+{
+    VmCallCache* pCache = (VmCallCache*)pInstr->p3;
+    SyHashEntry* pEntry;
+    int bHost = FALSE;
+    if (pCache && pCache->pEntry && pCache->nEpoch == pVm->nFuncEpoch)
+    {
+        pEntry = pCache->pEntry;
+        /* The function name is checked as well since it may be computed at run-time [i.e: $zFunc()] */
+        if (pEntry->nKeyLen == pName->nByte && SyMemcmp(pEntry->pKey, pName->zString, pName->nByte) == 0)
+        {
+            *pHost = pCache->bHost;
+            return pEntry;
+        }
+    }
+    /* Check for a compiled function first */
+    pEntry = SyHashGet(&pVm->hFunction, (const void*)pName->zString, pName->nByte);
+    if (pEntry == 0)
+    {
+        /* Look for an installed foreign function */
+        pEntry = SyHashGet(&pVm->hHostFunction, (const void*)pName->zString, pName->nByte);
+        if (pEntry == 0)
+        {
+            return 0;
+        }
+        bHost = TRUE;
+    }
+    if (pCache == 0)
+    {
+        pCache = (VmCallCache*)SyMemBackendPoolAlloc(&pVm->sAllocator, sizeof(VmCallCache));
+        pInstr->p3 = pCache;
+    }
+    if (pCache)
+    {
+        /* Bind the call site */
+        pCache->pEntry = pEntry;
+        pCache->nEpoch = pVm->nFuncEpoch;
+        pCache->bHost = bHost;
+        pCache->bReadOnly = bHost && VmIsReadOnlyFunc(pName);
+    }
+    *pHost = bHost;
+    return pEntry;
+}
+/*
+ * Check whether the given instruction pop two operands and only read them.
+ */
+static int VmIsBinaryReadOp(sxi32 iOp)
+{
+    switch (iOp)
+    {
+        case PH7_OP_CAT:
+        case PH7_OP_MUL:
+        case PH7_OP_DIV:
+        case PH7_OP_MOD:
+        case PH7_OP_ADD:
+        case PH7_OP_SUB:
+        case PH7_OP_SHL:
+        case PH7_OP_SHR:
+        case PH7_OP_LT:
+        case PH7_OP_LE:
+        case PH7_OP_GT:
+        case PH7_OP_GE:
+        case PH7_OP_EQ:
+        case PH7_OP_NEQ:
+        case PH7_OP_TEQ:
+        case PH7_OP_TNE:
+        case PH7_OP_SEQ:
+        case PH7_OP_SNE:
+        case PH7_OP_BAND:
+        case PH7_OP_BXOR:
+        case PH7_OP_BOR:
+        case PH7_OP_LAND:
+        case PH7_OP_LOR:
+        case PH7_OP_LXOR:
+            return TRUE;
+        default:
+            break;
+    }
+    return FALSE;
+}
+/*
+ * Check whether the element of an array literal view loaded by the PH7_OP_LOAD_IDX
+ * instruction at pInstr is only read by the instructions that follow
+ * [i.e: return $aMap[$zKey]; or if( isset($aMap[$zKey]) )].
+ * The view is indexed as is in that case rather than copied.
+ */
+static int VmIsElementReadOnly(ph7_vm* pVm, VmInstr* pInstr)
+{
+    VmInstr* pNext = &pInstr[1];
+    switch (pNext->iOp)
+    {
+        case PH7_OP_DONE:
+        {
+            VmFrame* pFrame = pVm->pFrame;
+            ph7_vm_func* pFunc;
+            while (pFrame->pParent && (pFrame->iFlags & VM_FRAME_EXCEPTION))
+            {
+                pFrame = pFrame->pParent;
+            }
+            /* Functions returning by reference hand the element to the caller */
+            pFunc = (ph7_vm_func*)pFrame->pUserData;
+            return pFunc == 0 || (pFunc->iFlags & VM_FUNC_REF_RETURN) == 0;
+        }
+        case PH7_OP_STORE:
+            /* Not a member store */
+            return pNext->iP2 == 0;
+        case PH7_OP_POP:
+        case PH7_OP_CONSUME:
+        case PH7_OP_JZ:
+        case PH7_OP_JNZ:
+        case PH7_OP_SWITCH:
+        case PH7_OP_CVT_INT:
+        case PH7_OP_CVT_STR:
+        case PH7_OP_CVT_REAL:
+        case PH7_OP_CVT_BOOL:
+        case PH7_OP_CVT_NUMC:
+        case PH7_OP_UMINUS:
+        case PH7_OP_UPLUS:
+        case PH7_OP_BITNOT:
+        case PH7_OP_LNOT:
+            return TRUE;
+        case PH7_OP_LOAD:
+            if (pNext->p3 == 0)
+            {
+                /* Variable name taken from the stack */
+                return FALSE;
+            }
+            break;
+        case PH7_OP_LOADC:
+            break;
+        default:
+            return VmIsBinaryReadOp(pNext->iOp);
+    }
+    /* A second operand is pushed,look at what consume both */
+    if (VmIsBinaryReadOp(pNext[1].iOp))
+    {
+        return TRUE;
+    }
+    if (pNext[1].iOp == PH7_OP_LOAD_IDX && pNext[1].iP1 && pNext[1].iP2 == 0)
+    {
+        /* String offset [i.e: $aMap[$x][0]] */
+        return TRUE;
+    }
+    if (pNext->iOp == PH7_OP_LOADC && pNext->iP1 == 0 && pNext[1].iOp == PH7_OP_CALL)
+    {
+        ph7_value* pName;
+        SyString sName;
+        int bHost;
+        /* Last argument of a function call */
+        pName = (ph7_value*)SySetAt(&pVm->aLitObj, pNext->iP2);
+        if (pName == 0 || (pName->iFlags & MEMOBJ_STRING) == 0)
+        {
+            return FALSE;
+        }
+        SyStringInitFromBuf(&sName, SyBlobData(&pName->sBlob), SyBlobLength(&pName->sBlob));
+        if (VmCallResolve(&(*pVm), &pNext[1], &sName, &bHost) == 0 || pNext[1].p3 == 0)
+        {
+            return FALSE;
+        }
+        return ((VmCallCache*)pNext[1].p3)->bReadOnly;
+    }
+    return FALSE;
+}
+
+/*
+ * Release a bytecode container together with the inline caches that
+ * PH7_OP_MEMBER and PH7_OP_CALL instructions bound in their third operand
+ * during execution. This routine must be used for every bytecode container
+ * that is released before the virtual machine itself [i.e: eval() chunks,
+ * included files,folded expressions].
  */
-static sxi32 VmErrorFormat(ph7_vm* pVm, sxi32 iErr, const char* zFormat, ...)
+static void VmReleaseByteCode(ph7_vm* pVm, SySet* pByteCode)
 {
-    va_list ap;
-    sxi32 rc;
-    va_start(ap, zFormat);
-    rc = VmThrowErrorAp(&(*pVm), 0, iErr, zFormat, ap);
-    va_end(ap);
-
-    return rc;
+    VmInstr* aInstr;
+    sxu32 n, i;
+    aInstr = (VmInstr*)SySetBasePtr(pByteCode);
+    for (n = 0; n < SySetUsed(pByteCode); ++n)
+    {
+        if (aInstr[n].p3 == 0)
+        {
+            continue;
+        }
+        if (aInstr[n].iOp == PH7_OP_MEMBER && aInstr[n].iP1 == 0)
+        {
+            /* Instance member access. Static accesses hold the member name or the
+             * resolved attribute in P3 and own nothing.
+             */
+            VmMemberCache* pCache = (VmMemberCache*)aInstr[n].p3;
+            for (i = 0; i < pCache->nEntry; ++i)
+            {
+                SyMemBackendFree(&pVm->sAllocator, (void*)pCache->aEntry[i].sName.zString);
+            }
+            SyMemBackendPoolFree(&pVm->sAllocator, pCache);
+            aInstr[n].p3 = 0;
+        }
+        else if (aInstr[n].iOp == PH7_OP_CALL)
+        {
+            /* VmCallCache instance */
+            SyMemBackendPoolFree(&pVm->sAllocator, aInstr[n].p3);
+            aInstr[n].p3 = 0;
+        }
+    }
+    SySetRelease(pByteCode);
 }
 
-/**
- * Format and throw a run-time error and invoke the supplied VM output consumer callback.
- * Refer to the implementation of [ph7_context_throw_error_format()] for additional
- * information.
- * ------------------------------------
- * Simple boring wrapper function.
- * ------------------------------------
+/*
+ * Limits on user functions evaluated in place at their call sites
+ * [refer to VmInlinePrepare()].
  */
-PH7_PRIVATE sxi32 PH7_VmThrowErrorAp(ph7_vm* pVm, SyString* pFuncName, sxi32 iErr, const char* zFormat, va_list ap)
+#define VM_INLINE_MAX_ARG   8
+#define VM_INLINE_MAX_INSTR 16
+
+/*
+ * Check whether a compiled function can be evaluated in place at its call sites
+ * and if so,build the rewritten body. Only plain functions whose body is a single
+ * 'return' of an expression over literals and by-value arguments qualify.
+ * Calls,jumps and every instruction that touches the VM frame are rejected so
+ * the rewritten body cannot recurse nor observe that no frame was entered.
+ * Return the length of the rewritten body,or -1 if the function is not a
+ * candidate. The result is recorded in the function so the analysis runs once.
+ */
+static sxi32 VmInlinePrepare(ph7_vm* pVm, ph7_vm_func* pFunc)
 {
-    sxi32 rc;
-    rc = VmThrowErrorAp(&(*pVm), &(*pFuncName), iErr, zFormat, ap);
-    return rc;
+    ph7_vm_func_arg* aFormalArg;
+    VmInstr* aInstr, * aInline;
+    sxu32 nArg, nInstr, n, i;
+    pFunc->nInline = -1;
+    if (pFunc->iFlags & (VM_FUNC_CLASS_METHOD | VM_FUNC_CLOSURE | VM_FUNC_REF_RETURN))
+    {
+        return -1;
+    }
+    nArg = SySetUsed(&pFunc->aArgs);
+    if (nArg > VM_INLINE_MAX_ARG || SySetUsed(&pFunc->aStatic) > 0)
+    {
+        return -1;
+    }
+    aFormalArg = (ph7_vm_func_arg*)SySetBasePtr(&pFunc->aArgs);
+    for (n = 0; n < nArg; ++n)
+    {
+        if ((aFormalArg[n].iFlags & VM_FUNC_ARG_BY_REF) || aFormalArg[n].nType != 0 ||
+            SySetUsed(&aFormalArg[n].aByteCode) > 0)
+        {
+            /* By reference,type hinted or default argument */
+            return -1;
+        }
+    }
+    aInstr = (VmInstr*)SySetBasePtr(&pFunc->aByteCode);
+    nInstr = SySetUsed(&pFunc->aByteCode);
+    /* The body must end with the first 'return' */
+    for (n = 0; n < nInstr && n < VM_INLINE_MAX_INSTR; ++n)
+    {
+        if (aInstr[n].iOp == PH7_OP_DONE)
+        {
+            break;
+        }
+    }
+    if (n < 1 || n >= nInstr || n >= VM_INLINE_MAX_INSTR || aInstr[n].iP1 == 0)
+    {
+        return -1;
+    }
+    nInstr = n + 1;
+    aInline = (VmInstr*)SyMemBackendAlloc(&pVm->sAllocator, nInstr * sizeof(VmInstr));
+    if (aInline == 0)
+    {
+        return -1;
+    }
+    SyMemcpy((const void*)aInstr, aInline, nInstr * sizeof(VmInstr));
+    for (n = 0; n + 1 < nInstr; ++n)
+    {
+        VmInstr* pInstr = &aInline[n];
+        switch (pInstr->iOp)
+        {
+            case PH7_OP_LOADC:
+                if (pInstr->iP1 != 0)
+                {
+                    /* Constant expanded at run-time [i.e: __FUNCTION__] */
+                    goto Reject;
+                }
+                break;
+            case PH7_OP_LOAD:
+            {
+                SyString sName;
+                if (pInstr->p3 == 0)
+                {
+                    /* Variable variable */
+                    goto Reject;
+                }
+                SyStringInitFromBuf(&sName, pInstr->p3, SyStrlen((const char*)pInstr->p3));
+                for (i = 0; i < nArg; ++i)
+                {
+                    if (SyStringCmp(&sName, &aFormalArg[i].sName, SyMemcmp) == 0)
+                    {
+                        break;
+                    }
+                }
+                if (i >= nArg)
+                {
+                    /* Local or global variable */
+                    goto Reject;
+                }
+                pInstr->iOp = PH7_OP_LOAD_ARG;
+                pInstr->iP1 = (sxi32)i;
+                pInstr->iP2 = 0;
+                pInstr->p3 = 0;
+                break;
+            }
+            case PH7_OP_CAT:
+            case PH7_OP_UMINUS:
+            case PH7_OP_UPLUS:
+            case PH7_OP_BITNOT:
+            case PH7_OP_LNOT:
+            case PH7_OP_MUL:
+            case PH7_OP_ADD:
+            case PH7_OP_SUB:
+            case PH7_OP_SHL:
+            case PH7_OP_SHR:
+            case PH7_OP_LT:
+            case PH7_OP_LE:
+            case PH7_OP_GT:
+            case PH7_OP_GE:
+            case PH7_OP_EQ:
+            case PH7_OP_NEQ:
+            case PH7_OP_TEQ:
+            case PH7_OP_TNE:
+            case PH7_OP_BAND:
+            case PH7_OP_BXOR:
+            case PH7_OP_BOR:
+            case PH7_OP_LAND:
+            case PH7_OP_LOR:
+            case PH7_OP_LXOR:
+                if (pInstr->iP2 != 0)
+                {
+                    /* Comparison fused with a jump */
+                    goto Reject;
+                }
+                break;
+            default:
+                goto Reject;
+        }
+    }
+    pFunc->aInline = aInline;
+    pFunc->nInline = (sxi32)nInstr;
+    return (sxi32)nInstr;
+    Reject:
+    SyMemBackendFree(&pVm->sAllocator, aInline);
+    return -1;
 }
 
 /**
@@ -2983,6 +3788,17 @@ static sxi32 VmByteCodeExec(
      * use the public API,to control error output.
      */
                 break;
+/*
+ * LOAD_ARG: P1 * *
+ *
+ * Push a copy of the P1th argument of an inlined function body. The arguments
+ * occupy the bottom of the operand stack [refer to VmInlinePrepare()].
+ */
+            case PH7_OP_LOAD_ARG:
+                pTos++;
+                PH7_MemObjLoad(&pStack[pInstr->iP1], pTos);
+                pTos->nIdx = SXU32_HIGH;
+                break;
 /*
  * IS_A * * *
  *
@@ -3139,17 +3955,41 @@ static sxi32 VmByteCodeExec(
                 break;
             }
 /*
- * LOAD_MAP P1 * *
+ * LOAD_MAP P1 P2 *
  *
  * Allocate a new empty hashmap (array in the PHP jargon) and push it on the stack.
  * If the P1 operand is greater than zero then pop P1 elements from the
  * stack and insert them (key => value pair) in the new hashmap.
+ * If P2 is set,the array is a constant literal folded by the compiler and stored
+ * in the literal table at index P2,push a view of it if it hold scalar values only
+ * [See PH7_HashmapShareLiteral()],a fresh copy otherwise.
  */
             case PH7_OP_LOAD_MAP:
             {
                 ph7_hashmap* pMap;
-                /* Allocate a new hashmap instance */
-                pMap = PH7_NewHashmap(&(*pVm), 0, 0);
+                if (pInstr->iP2 > 0)
+                {
+                    ph7_value* pObj;
+                    pMap = 0;
+                    pObj = (ph7_value*)SySetAt(&pVm->aLitObj, pInstr->iP2);
+                    if (pObj && (pObj->iFlags & MEMOBJ_HASHMAP))
+                    {
+                        pMap = (ph7_hashmap*)pObj->x.pOther;
+                        if (pMap->iFlags & HASHMAP_LITERAL)
+                        {
+                            pMap = PH7_HashmapShareLiteral(&(*pVm), pMap);
+                        }
+                        else
+                        {
+                            pMap = PH7_HashmapDupLiteral(&(*pVm), pMap);
+                        }
+                    }
+                }
+                else
+                {
+                    /* Allocate a new hashmap instance large enough to hold the P1/2 key => value pairs */
+                    pMap = PH7_NewHashmap(&(*pVm), 0, 0, pInstr->iP1 > 0 ? (sxu32)pInstr->iP1 >> 1 : 0);
+                }
                 if (pMap == 0)
                 {
                     VmErrorFormat(&(*pVm), PH7_CTX_ERR,
@@ -3304,14 +4144,14 @@ static sxi32 VmByteCodeExec(
                             SyStringInitFromBuf(&sName, (const char*)SyBlobData(&pIdx->sBlob),
                                                 SyBlobLength(&pIdx->sBlob));
                             /* Call magic method to get element */
-                            PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, "__get", sizeof("__get") - 1,
+                            PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, PH7_CLASS_MAGIC_GET,
                                                              &sName, 0);
                         }
                         else if ((pIdx->iFlags & MEMOBJ_INT))
                         {
                             /* Index is integer */
-                            PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, "offsetGet",
-                                                             sizeof("offsetGet") - 1, 0, pIdx);
+                            PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, PH7_CLASS_MAGIC_OFFSETGET,
+                                                             0, pIdx);
                         }
                         else
                         {
@@ -3368,6 +4208,11 @@ static sxi32 VmByteCodeExec(
                         }
                     }
                 }
+                if (VmIsLiteralView(pTos) && (pInstr->iP2 || !VmIsElementReadOnly(&(*pVm), pInstr)))
+                {
+                    /* The element may be modified,copy the literal entries first */
+                    PH7_HashmapUnshare((ph7_hashmap*)pTos->x.pOther);
+                }
                 rc = SXERR_NOTFOUND; /* Assume the index is invalid */
                 if (pTos->iFlags & MEMOBJ_HASHMAP)
                 {
@@ -3405,7 +4250,8 @@ static sxi32 VmByteCodeExec(
                     }
                     else
                     {
-                        pTos->nIdx = pNode->nValIdx;
+                        /* Elements of a literal view are loaded as constants */
+                        pTos->nIdx = pMap->pLiteral ? SXU32_HIGH : pNode->nValIdx;
                         PH7_HashmapExtractNodeValue(pNode, pTos, FALSE);
                         PH7_HashmapUnref(pMap);
                     }
@@ -3497,9 +4343,10 @@ static sxi32 VmByteCodeExec(
                 break;
             }
 /*
- * STORE * P2 P3
+ * STORE P1 P2 P3
  *
  * Perform a store (Assignment) operation.
+ * If P1 is set then the stored value is discarded [i.e: assignment used as a statement].
  */
             case PH7_OP_STORE:
             {
@@ -3533,6 +4380,11 @@ static sxi32 VmByteCodeExec(
                             PH7_MemObjStore(pTos, pObj);
                         }
                     }
+                    if (pInstr->iP1)
+                    {
+                        /* Discard the stored value */
+                        VmPopOperand(&pTos, 1);
+                    }
                     break;
                 }
                 else if (pInstr->p3 == 0)
@@ -3570,6 +4422,11 @@ static sxi32 VmByteCodeExec(
                 }
                 /* Perform the store operation */
                 PH7_MemObjStore(pTos, pObj);
+                if (pInstr->iP1)
+                {
+                    /* Discard the stored value */
+                    VmPopOperand(&pTos, 1);
+                }
                 break;
             }
 /*
@@ -3594,6 +4451,11 @@ static sxi32 VmByteCodeExec(
                 {
                     pKey = 0;
                 }
+                if (VmIsLiteralView(pTos))
+                {
+                    /* Copy the literal entries first */
+                    PH7_HashmapUnshare((ph7_hashmap*)pTos->x.pOther);
+                }
                 nIdx = pTos->nIdx;
                 if ((pTos->iFlags & MEMOBJ_HASHMAP) != 0)
                 {
@@ -3687,8 +4549,7 @@ static sxi32 VmByteCodeExec(
                                 &(*pVm),
                                 pClass,
                                 pThis,
-                                "offsetSet",
-                                sizeof("offsetSet") - 1,
+                                PH7_CLASS_MAGIC_OFFSETSET,
                                 &pKey,
                                 0);
 
@@ -3700,8 +4561,8 @@ static sxi32 VmByteCodeExec(
                             SyStringInitFromBuf(&sName, (const char*)SyBlobData(&pKey->sBlob),
                                                 SyBlobLength(&pKey->sBlob));
                             /* Call magic method to modify element from object index */
-                            PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, "offsetSet",
-                                                             sizeof("offsetSet") - 1, &sName, 0);
+                            PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, PH7_CLASS_MAGIC_OFFSETSET,
+                                                             &sName, 0);
 
                         }
                         else
@@ -4046,10 +4907,11 @@ static sxi32 VmByteCodeExec(
                 break;
             }
 /*
- * OP_ADD_STORE * * *
+ * OP_ADD_STORE P1 * *
  *
  * Pop the top two elements from the stack, add them together,
  * and push the result back onto the stack.
+ * If P1 is set then the result is discarded.
  */
             case PH7_OP_ADD_STORE:
             {
@@ -4062,6 +4924,11 @@ static sxi32 VmByteCodeExec(
                     goto Abort;
                 }
 #endif
+                if (VmIsLiteralView(pTos))
+                {
+                    /* Array union is performed in place,copy the literal entries first */
+                    PH7_HashmapUnshare((ph7_hashmap*)pTos->x.pOther);
+                }
                 /* Perform the addition */
                 nIdx = pTos->nIdx;
                 PH7_MemObjAdd(pTos, pNos, TRUE);
@@ -4075,6 +4942,12 @@ static sxi32 VmByteCodeExec(
                 {
                     PH7_MemObjStore(pTos, pObj);
                 }
+                if (pInstr->iP1)
+                {
+                    /* Result discarded, no need for a stack dup */
+                    VmPopOperand(&pTos, 2);
+                    break;
+                }
                 /* Ticket 1433-35: Perform a stack dup */
                 PH7_MemObjStore(pTos, pNos);
                 VmPopOperand(&pTos, 1);
@@ -4130,11 +5003,12 @@ static sxi32 VmByteCodeExec(
                 VmPopOperand(&pTos, 1);
                 break;
             }
-/* OP_SUB_STORE * * *
+/* OP_SUB_STORE P1 * *
  *
  * Pop the top two elements from the stack, subtract the
  * first (what was next on the stack) from the second (the
  * top of the stack) and push the result back onto the stack.
+ * If P1 is set then the result is discarded.
  */
             case PH7_OP_SUB_STORE:
             {
@@ -4187,7 +5061,7 @@ static sxi32 VmByteCodeExec(
                 {
                     PH7_MemObjStore(pNos, pObj);
                 }
-                VmPopOperand(&pTos, 1);
+                VmPopOperand(&pTos, pInstr->iP1 ? 2 : 1);
                 break;
             }
 
@@ -4701,10 +5575,10 @@ static sxi32 VmByteCodeExec(
                 pTos = pNos;
                 break;
             }
-/*  CAT_STORE: * * *
+/*  CAT_STORE: P1 * *
  *
  * Pop two elements from the stack. Concatenate them togeher and push the result
- * back.
+ * back. If P1 is set then the result is discarded.
  */
             case PH7_OP_CAT_STORE:
             {
@@ -4741,6 +5615,12 @@ static sxi32 VmByteCodeExec(
                 {
                     PH7_MemObjStore(pTos, pObj);
                 }
+                if (pInstr->iP1)
+                {
+                    /* Result discarded, no need for a stack dup */
+                    VmPopOperand(&pTos, 2);
+                    break;
+                }
                 PH7_MemObjStore(pTos, pNos);
                 VmPopOperand(&pTos, 1);
                 break;
@@ -5506,6 +6386,11 @@ static sxi32 VmByteCodeExec(
                         if (pTos->iFlags & MEMOBJ_HASHMAP)
                         {
                             ph7_hashmap* pMap = (ph7_hashmap*)pTos->x.pOther;
+                            if (pInfo->iFlags & PH7_4EACH_STEP_REF)
+                            {
+                                /* Entries are bound by reference,copy the literal entries first */
+                                PH7_HashmapUnshare(pMap);
+                            }
                             /* Reset the internal loop cursor */
                             PH7_HashmapResetLoopCursor(pMap);
                             /* Mark the step */
@@ -5516,8 +6401,8 @@ static sxi32 VmByteCodeExec(
                         else
                         {
                             ph7_class_instance* pThis = (ph7_class_instance*)pTos->x.pOther;
-                            /* Reset the loop cursor */
-                            SyHashResetLoopCursor(&pThis->hAttr);
+                            /* Start from the first attribute slot */
+                            pStep->nAttr = 0;
                             /* Mark the step */
                             pStep->iFlags |= PH7_4EACH_STEP_OBJECT;
                             pStep->xIter.pThis = pThis;
@@ -5619,20 +6504,21 @@ static sxi32 VmByteCodeExec(
                 else
                 {
                     ph7_class_instance* pThis = pStep->xIter.pThis;
-                    VmClassAttr* pVmAttr = 0; /* Stupid cc -06 warning */
+                    VmClassAttr* pVmAttr = 0;
                     SyHashEntry* pEntry;
                     /* Point to the next attribute */
-                    while ((pEntry = SyHashGetNextEntry(&pThis->hAttr)) != 0)
+                    while (pStep->nAttr < pThis->nAttr)
                     {
-                        pVmAttr = (VmClassAttr*)pEntry->pUserData;
+                        pVmAttr = &pThis->aAttr[pStep->nAttr++];
                         /* Check access permission */
                         if (VmClassMemberAccess(&(*pVm), pThis->pClass, &pVmAttr->pAttr->sName,
                                                 pVmAttr->pAttr->iProtection, FALSE))
                         {
                             break; /* Access is granted */
                         }
+                        pVmAttr = 0;
                     }
-                    if (pEntry == 0)
+                    if (pVmAttr == 0)
                     {
                         /* Clean up the mess left behind */
                         pc = pInstr->iP2 - 1; /* Jump to this destination */
@@ -5698,13 +6584,39 @@ static sxi32 VmByteCodeExec(
 /*
  * OP_MEMBER P1 P2
  * Load class attribute/method on the stack.
+ * If P1 is set to 2,then P3 hold the static attribute resolved at compile time.
  */
             case PH7_OP_MEMBER:
             {
                 ph7_class_instance* pThis;
                 ph7_value* pNos;
                 SyString sName;
-                if (!pInstr->iP1)
+                if (pInstr->iP1 == 2)
+                {
+                    ph7_class_attr* pAttr = (ph7_class_attr*)pInstr->p3;
+                    ph7_value* pValue;
+                    /* Static attribute resolved at compile time [i.e: Foo::$count],load it directly */
+                    if (pAttr->nIdx == SXU32_HIGH && pAttr->pClass)
+                    {
+                        /* First use of the declaring class */
+                        VmMountUserClass(&(*pVm), pAttr->pClass);
+                    }
+                    pTos++;
+                    pValue = (ph7_value*)SySetAt(&pVm->aMemObj, pAttr->nIdx);
+                    if (pValue)
+                    {
+                        PH7_MemObjLoad(pValue, pTos);
+                        /* Load index number */
+                        pTos->nIdx = pAttr->nIdx;
+                    }
+                    else
+                    {
+                        /* Attribute not mounted yet */
+                        MemObjSetType(pTos, MEMOBJ_NULL);
+                        pTos->nIdx = SXU32_HIGH;
+                    }
+                }
+                else if (!pInstr->iP1)
                 {
                     pNos = &pTos[-1];
 #ifdef UNTRUST
@@ -5715,6 +6627,7 @@ static sxi32 VmByteCodeExec(
 #endif
                     if (pNos->iFlags & MEMOBJ_OBJ)
                     {
+                        VmMemberCacheEntry* pCacheEntry;
                         ph7_class* pClass;
                         /* Class already instantiated */
                         pThis = (ph7_class_instance*)pNos->x.pOther;
@@ -5723,14 +6636,24 @@ static sxi32 VmByteCodeExec(
                         /* Extract attribute name first */
                         SyStringInitFromBuf(&sName, (const char*)SyBlobData(&pTos->sBlob),
                                             SyBlobLength(&pTos->sBlob));
+                        /* Consult the inline cache first */
+                        pCacheEntry = VmMemberCacheLookup(pInstr, pClass, &sName);
                         if (pInstr->iP2)
                         {
                             /* Method call */
                             ph7_class_method* pMeth = 0;
-                            if (sName.nByte > 0)
+                            if (pCacheEntry)
+                            {
+                                pMeth = pCacheEntry->pMeth;
+                            }
+                            else if (sName.nByte > 0)
                             {
                                 /* Extract the target method */
                                 pMeth = PH7_ClassExtractMethod(pClass, sName.zString, sName.nByte);
+                                if (pMeth)
+                                {
+                                    VmMemberCacheInsert(&(*pVm), pInstr, pClass, &sName, pMeth, 0);
+                                }
                             }
                             if (pMeth == 0)
                             {
@@ -5739,8 +6662,7 @@ static sxi32 VmByteCodeExec(
                                               &pClass->sName, &sName
                                 );
                                 /* Call the '__Call()' magic method if available */
-                                PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, "__call",
-                                                                 sizeof("__call") - 1,
+                                PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, PH7_CLASS_MAGIC_CALL,
                                                                  &sName, 0);
                                 /* Pop the method name from the stack */
                                 VmPopOperand(&pTos, 1);
@@ -5760,15 +6682,18 @@ static sxi32 VmByteCodeExec(
                         {
                             /* Attribute access */
                             VmClassAttr* pObjAttr = 0;
-                            SyHashEntry* pEntry;
-                            /* Extract the target attribute */
-                            if (sName.nByte > 0)
+                            if (pCacheEntry && pCacheEntry->pMeth == 0 && pCacheEntry->nSlot < pThis->nAttr)
                             {
-                                pEntry = SyHashGet(&pThis->hAttr, (const void*)sName.zString, sName.nByte);
-                                if (pEntry != NULL)
+                                pObjAttr = &pThis->aAttr[pCacheEntry->nSlot];
+                            }
+                            else if (sName.nByte > 0)
+                            {
+                                /* Extract the target attribute */
+                                pObjAttr = PH7_ClassInstanceLookupAttr(pThis, &sName);
+                                if (pObjAttr)
                                 {
-                                    /* Point to the attribute value */
-                                    pObjAttr = (VmClassAttr*)pEntry->pUserData;
+                                    VmMemberCacheInsert(&(*pVm), pInstr, pClass, &sName, 0,
+                                                        (sxu32)(pObjAttr - pThis->aAttr));
                                 }
                             }
                             if (pObjAttr == 0)
@@ -5778,8 +6703,7 @@ static sxi32 VmByteCodeExec(
                                               "Undefined class attribute '%z->%z',PH7 is loading NULL",
                                               &pClass->sName, &sName);
                                 /* Call the __get magic method if available */
-                                PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, "__get",
-                                                                 sizeof("__get") - 1,
+                                PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, pThis, PH7_CLASS_MAGIC_GET,
                                                                  &sName, pNos);
                             }
                             VmPopOperand(&pTos, 1);
@@ -5919,8 +6843,8 @@ static sxi32 VmByteCodeExec(
                                                       &pClass->sName, &sName
                                         );
                                         /* Call the '__CallStatic()' magic method if available */
-                                        PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, 0, "__callStatic",
-                                                                         sizeof("__callStatic") - 1, &sName, 0);
+                                        PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, 0, PH7_CLASS_MAGIC_CALLSTATIC,
+                                                                         &sName, 0);
                                     }
                                     /* Pop the method name from the stack */
                                     if (!pInstr->p3)
@@ -5955,8 +6879,7 @@ static sxi32 VmByteCodeExec(
                                                   "Undefined class attribute '%z::%z',PH7 is loading NULL",
                                                   &pClass->sName, &sName);
                                     /* Call the __get magic method if available */
-                                    PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, 0, "__get",
-                                                                     sizeof("__get") - 1,
+                                    PH7_ClassInstanceCallMagicMethod(&(*pVm), pClass, 0, PH7_CLASS_MAGIC_GET,
                                                                      &sName, 0);
                                 }
                                 /* Pop the attribute name from the stack */
@@ -6074,13 +6997,7 @@ static sxi32 VmByteCodeExec(
                         break;
                     }
                     /* Check if a constructor is available */
-                    pCons = PH7_ClassExtractMethod(pClass, "__construct", sizeof("__construct") - 1);
-                    if (pCons == 0)
-                    {
-                        SyString* pName = &pClass->sName;
-                        /* Check for a constructor with the same base class name */
-                        pCons = PH7_ClassExtractMethod(pClass, pName->zString, pName->nByte);
-                    }
+                    pCons = pClass->apMagic[PH7_CLASS_MAGIC_CONSTRUCT];
                     if (pCons)
                     {
                         /* Call the class constructor */
@@ -6234,6 +7151,7 @@ static sxi32 VmByteCodeExec(
                 ph7_value* pArg = &pTos[-pInstr->iP1];
                 SyHashEntry* pEntry;
                 SyString sName;
+                int bHost;
                 /* Extract function name */
                 if ((pTos->iFlags & MEMOBJ_STRING) == 0)
                 {
@@ -6266,8 +7184,8 @@ static sxi32 VmByteCodeExec(
                         {
                             ph7_class_instance* pThis = (ph7_class_instance*)pTos->x.pOther;
                             /* Call the magic method '__invoke' if available */
-                            PH7_ClassInstanceCallMagicMethod(&(*pVm), pThis->pClass, pThis, "__invoke",
-                                                             sizeof("__invoke") - 1, 0, 0);
+                            PH7_ClassInstanceCallMagicMethod(&(*pVm), pThis->pClass, pThis, PH7_CLASS_MAGIC_INVOKE,
+                                                             0, 0);
                         }
                         else
                         {
@@ -6285,9 +7203,9 @@ static sxi32 VmByteCodeExec(
                     break;
                 }
                 SyStringInitFromBuf(&sName, SyBlobData(&pTos->sBlob), SyBlobLength(&pTos->sBlob));
-                /* Check for a compiled function first */
-                pEntry = SyHashGet(&pVm->hFunction, (const void*)sName.zString, sName.nByte);
-                if (pEntry != NULL)
+                /* Extract the target function (Compiled or foreign) */
+                pEntry = VmCallResolve(&(*pVm), pInstr, &sName, &bHost);
+                if (pEntry != NULL && !bHost)
                 {
                     ph7_vm_func_arg* aFormalArg;
                     ph7_class_instance* pThis;
@@ -6403,6 +7321,40 @@ static sxi32 VmByteCodeExec(
                         /* Function is candidate for overloading,select the appropriate function to call */
                         pVmFunc = VmOverload(&(*pVm), pVmFunc, pArg, (int)(pTos - pArg));
                     }
+                    else if (pVm->sCodeGen.bInline && pVmFunc->nInline >= 0 &&
+                             (sxu32)pInstr->iP1 == SySetUsed(&pVmFunc->aArgs) &&
+                             (pVmFunc->nInline > 0 || VmInlinePrepare(&(*pVm), pVmFunc) > 0))
+                    {
+                        ph7_value aFrame[VM_INLINE_MAX_ARG + VM_INLINE_MAX_INSTR];
+                        sxu32 nFrame = (sxu32)pInstr->iP1 + (sxu32)pVmFunc->nInline;
+                        /* Evaluate the function body in place: move the arguments to the bottom
+                         * of a private operand stack,no VM frame is needed.
+                         */
+                        for (n = 0; n < nFrame; ++n)
+                        {
+                            if (n < (sxu32)pInstr->iP1)
+                            {
+                                SyMemcpy((const void*)&pArg[n], &aFrame[n], sizeof(ph7_value));
+                                PH7_MemObjInit(&(*pVm), &pArg[n]);
+                            }
+                            else
+                            {
+                                PH7_MemObjInit(&(*pVm), &aFrame[n]);
+                            }
+                        }
+                        PH7_MemObjRelease(pTos);
+                        pTos = &pTos[-pInstr->iP1];
+                        rc = VmByteCodeExec(&(*pVm), pVmFunc->aInline, aFrame, pInstr->iP1 - 1, pTos, 0, FALSE);
+                        for (n = 0; n < nFrame; ++n)
+                        {
+                            PH7_MemObjRelease(&aFrame[n]);
+                        }
+                        if (rc == PH7_ABORT)
+                        {
+                            goto Abort;
+                        }
+                        break;
+                    }
                     /* Extract the formal argument set */
                     aFormalArg = (ph7_vm_func_arg*)SySetBasePtr(&pVmFunc->aArgs);
                     /* Create a new VM frame  */
@@ -6765,8 +7717,6 @@ static sxi32 VmByteCodeExec(
                     ph7_user_func* pFunc;
                     ph7_context sCtx;
                     ph7_value sRet;
-                    /* Look for an installed foreign function */
-                    pEntry = SyHashGet(&pVm->hHostFunction, (const void*)sName.zString, sName.nByte);
                     if (pEntry == 0)
                     {
                         /* Call to undefined function */
@@ -6787,6 +7737,11 @@ static sxi32 VmByteCodeExec(
                     SySetReset(&aArg);
                     while (pArg < pTos)
                     {
+                        if (VmIsLiteralView(pArg) && (pInstr->p3 == 0 || !((VmCallCache*)pInstr->p3)->bReadOnly))
+                        {
+                            /* The function may modify the array in place,copy the literal entries first */
+                            PH7_HashmapUnshare((ph7_hashmap*)pArg->x.pOther);
+                        }
                         SySetPut(&aArg, (const void*)&pArg);
                         pArg++;
                     }
@@ -6902,6 +7857,52 @@ static sxi32 VmLocalExec(ph7_vm* pVm, SySet* pByteCode, ph7_value* pResult)
     /* Execution result */
     return rc;
 }
+/*
+ * Evaluate the instructions emitted since nStart in the current bytecode container.
+ * This routine is used by the code generator to fold constant expressions
+ * [i.e: 60*60*24,'a'.'b',strlen('x')] so that the result is computed exactly as
+ * the VM would do at run-time. The caller must make sure that only literal loads,
+ * pure operators and calls to side-effect free foreign functions were emitted.
+ */
+PH7_PRIVATE sxi32 PH7_VmEvalInstr(ph7_vm* pVm, sxu32 nStart, ph7_value* pResult)
+{
+    VmInstr* pInstr, sDone;
+    SySet aByteCode;
+    sxu32 nLen, n;
+    sxi32 rc;
+    nLen = SySetUsed(pVm->pByteContainer);
+    if (nStart >= nLen)
+    {
+        return SXERR_EMPTY;
+    }
+    SySetInit(&aByteCode, &pVm->sAllocator, sizeof(VmInstr));
+    SySetAlloc(&aByteCode, nLen - nStart + 1);
+    for (n = nStart; n < nLen; ++n)
+    {
+        VmInstr sInstr;
+        pInstr = (VmInstr*)SySetAt(pVm->pByteContainer, n);
+        sInstr = *pInstr;
+        if (sInstr.iOp == PH7_OP_JZ || sInstr.iOp == PH7_OP_JNZ)
+        {
+            /* Rebase the jump destination */
+            sInstr.iP2 -= nStart;
+        }
+        SySetPut(&aByteCode, (const void*)&sInstr);
+    }
+    /* Return the value left on the stack */
+    sDone.iOp = PH7_OP_DONE;
+    sDone.iP1 = 1;
+    sDone.iP2 = 0;
+    sDone.p3 = 0;
+    rc = SySetPut(&aByteCode, (const void*)&sDone);
+    if (rc == SXRET_OK)
+    {
+        rc = VmLocalExec(&(*pVm), &aByteCode, &(*pResult));
+    }
+    /* Release the call site caches bound during execution */
+    VmReleaseByteCode(&(*pVm), &aByteCode);
+    return rc;
+}
 
 /*
  * Invoke any installed shutdown callbacks.
@@ -7062,6 +8063,9 @@ static const char* VmInstrToString(sxi32 nOp)
         case PH7_OP_LOADC:
             zOp = "LOADC      ";
             break;
+        case PH7_OP_LOAD_ARG:
+            zOp = "LOAD_ARG   ";
+            break;
         case PH7_OP_LOAD_MAP:
             zOp = "LOAD_MAP   ";
             break;
@@ -7318,8 +8322,64 @@ PH7_PRIVATE sxi32 PH7_VmDump(
     void* pUserData         /* Last argument to xConsumer() */
 )
 {
+    static const char zDump[] = {
+        "====================================================\n"
+        "PH7 VM Dump   Copyright (C) 2011-2012 Symisc Systems\n"
+        "                              http://www.symisc.net/\n"
+        "====================================================\n"
+    };
+    SyHashEntry* pEntry, * pMethEntry;
+    ph7_class_method* pMeth;
+    ph7_vm_func* pFunc;
+    ph7_class* pClass;
+    sxu32 n;
     sxi32 rc;
+    xConsumer((const void*)zDump, sizeof(zDump) - 1, pUserData);
     rc = VmByteCodeDump(pVm->pByteContainer, xConsumer, pUserData);
+    if (rc != SXRET_OK || !pVm->bDumpFull)
+    {
+        return rc;
+    }
+    /* User functions. Newest entries come first, the built-in library is last */
+    SyHashResetLoopCursor(&pVm->hFunction);
+    for (n = 0; rc == SXRET_OK && n + pVm->nBuiltinFunc < SyHashTotalEntry(&pVm->hFunction); ++n)
+    {
+        pEntry = SyHashGetNextEntry(&pVm->hFunction);
+        for (pFunc = (ph7_vm_func*)pEntry->pUserData; rc == SXRET_OK && pFunc; pFunc = pFunc->pNextName)
+        {
+            rc = SyProcFormat(xConsumer, pUserData, "---- Function %z() ----\n", &pFunc->sName);
+            if (rc == SXRET_OK)
+            {
+                rc = VmByteCodeDump(&pFunc->aByteCode, xConsumer, pUserData);
+            }
+        }
+    }
+    /* Class methods, excluding the inherited ones */
+    SyHashResetLoopCursor(&pVm->hClass);
+    for (n = 0; rc == SXRET_OK && n + pVm->nBuiltinClass < SyHashTotalEntry(&pVm->hClass); ++n)
+    {
+        pClass = (ph7_class*)SyHashGetNextEntry(&pVm->hClass)->pUserData;
+        SyHashResetLoopCursor(&pClass->hMethod);
+        while (rc == SXRET_OK && (pMethEntry = SyHashGetNextEntry(&pClass->hMethod)) != 0)
+        {
+            pMeth = (ph7_class_method*)pMethEntry->pUserData;
+            if (pClass->pBase && (pEntry = SyHashGet(&pClass->pBase->hMethod, pMethEntry->pKey, pMethEntry->nKeyLen)) != 0 &&
+                pEntry->pUserData == (void*)pMeth)
+            {
+                continue;
+            }
+            rc = SyProcFormat(xConsumer, pUserData, "---- Method %z::%z() ----\n", &pClass->sName,
+                              &pMeth->sFunc.sName);
+            if (rc == SXRET_OK)
+            {
+                rc = VmByteCodeDump(&pMeth->sFunc.aByteCode, xConsumer, pUserData);
+            }
+        }
+    }
+    if (rc == SXRET_OK)
+    {
+        rc = PH7_GenPeepholeDump(&pVm->sCodeGen, xConsumer, pUserData);
+    }
     return rc;
 }
 /*
@@ -7598,7 +8658,7 @@ PH7_PRIVATE int PH7_VmIsCallable(ph7_vm* pVm, ph7_value* pValue, int CallInvoke)
         /* Call the magic method __invoke if available */
         ph7_class_instance* pThis = (ph7_class_instance*)pValue->x.pOther;
         ph7_class_method* pMethod;
-        pMethod = PH7_ClassExtractMethod(pThis->pClass, "__invoke", sizeof("__invoke") - 1);
+        pMethod = pThis->pClass->apMagic[PH7_CLASS_MAGIC_INVOKE];
         if (pMethod && CallInvoke)
         {
             ph7_value sResult;
@@ -8005,14 +9065,8 @@ static ph7_class* VmExtractClassFromValue(ph7_vm* pVm, ph7_value* pArg)
         zClass = ph7_value_to_string(pArg, &nLen);
         if (nLen > 0)
         {
-            SyHashEntry* pEntry;
             /* Perform a lookup */
-            pEntry = SyHashGet(&pVm->hClass, (const void*)zClass, (sxu32)nLen);
-            if (pEntry != NULL)
-            {
-                /* Point to the desired class */
-                pClass = (ph7_class*)pEntry->pUserData;
-            }
+            pClass = PH7_VmExtractClass(&(*pVm), zClass, (sxu32)nLen, FALSE, 0);
         }
     }
     return pClass;
@@ -8118,8 +9172,8 @@ static int vm_builtin_class_exists(ph7_context* pCtx, int nArg, ph7_value** apAr
         int nLen;
         /* Extract given name */
         zName = ph7_value_to_string(apArg[0], &nLen);
-        /* Perform a hashlookup */
-        if (nLen > 0 && SyHashGet(&pCtx->pVm->hClass, (const void*)zName, (sxu32)nLen) != 0)
+        /* Perform a lookup [i.e: Consult the autoload index if needed] */
+        if (nLen > 0 && PH7_VmExtractClass(pCtx->pVm, zName, (sxu32)nLen, FALSE, 0) != 0)
         {
             /* class is available */
             res = 1;
@@ -8152,7 +9206,7 @@ static int vm_builtin_interface_exists(ph7_context* pCtx, int nArg, ph7_value**
         /* Extract given name */
         zName = ph7_value_to_string(apArg[0], &nLen);
         /* Perform a hashlookup */
-        if (nLen > 0)
+        if (nLen > 0 && PH7_VmExtractClass(pCtx->pVm, zName, (sxu32)nLen, FALSE, 0) != 0)
         {
             pEntry = SyHashGet(&pCtx->pVm->hClass, (const void*)zName, (sxu32)nLen);
         }
@@ -8545,7 +9599,7 @@ static int vm_builtin_get_object_vars(ph7_context* pCtx, int nArg, ph7_value** a
 {
     ph7_class_instance* pThis = 0;
     ph7_value* pName, * pArray;
-    SyHashEntry* pEntry;
+    sxu32 n;
     if (nArg > 0 && (apArg[0]->iFlags & MEMOBJ_OBJ))
     {
         /* Extract the target instance */
@@ -8567,10 +9621,9 @@ static int vm_builtin_get_object_vars(ph7_context* pCtx, int nArg, ph7_value** a
         return PH7_OK;
     }
     /* Fill the array with the defined attribute visible from the current scope */
-    SyHashResetLoopCursor(&pThis->hAttr);
-    while ((pEntry = SyHashGetNextEntry(&pThis->hAttr)) != 0)
+    for (n = 0; n < pThis->nAttr; ++n)
     {
-        VmClassAttr* pVmAttr = (VmClassAttr*)pEntry->pUserData;
+        VmClassAttr* pVmAttr = &pThis->aAttr[n];
         SyString* pAttrName;
         if (pVmAttr->pAttr->iFlags & (PH7_CLASS_ATTR_STATIC | PH7_CLASS_ATTR_CONSTANT))
         {
@@ -8633,39 +9686,36 @@ static int VmQueryInterfaceSet(ph7_class* pClass, SySet* pSet)
  * This function returns TRUE if the given class (first argument)
  * is an instance of the main class (second argument).
  * Otherwise FALSE is returned.
+ * The query is a binary search in the ancestry table built when the
+ * class was compiled. Refer to [PH7_ClassBuildAncestry()].
  */
 static int VmInstanceOf(ph7_class* pThis, ph7_class* pClass)
 {
-    ph7_class* pParent;
-    sxi32 rc;
+    ph7_class** apAncestor;
+    sxu32 iLow, iHigh, iMid;
     if (pThis == pClass)
     {
         /* Instance of the same class */
         return TRUE;
     }
-    /* Check implemented interfaces */
-    rc = VmQueryInterfaceSet(pClass, &pThis->aInterface);
-    if (rc)
-    {
-        return TRUE;
-    }
-    /* Check parent classes */
-    pParent = pThis->pBase;
-    while (pParent)
+    apAncestor = (ph7_class**)SySetBasePtr(&pThis->aAncestor);
+    iLow = 0;
+    iHigh = SySetUsed(&pThis->aAncestor);
+    while (iLow < iHigh)
     {
-        if (pParent == pClass)
+        iMid = (iLow + iHigh) >> 1;
+        if (apAncestor[iMid] == pClass)
         {
-            /* Same instance */
             return TRUE;
         }
-        /* Check the implemented interfaces */
-        rc = VmQueryInterfaceSet(pClass, &pParent->aInterface);
-        if (rc)
+        if (SX_ADDR(apAncestor[iMid]) < SX_ADDR(pClass))
         {
-            return TRUE;
+            iLow = iMid + 1;
+        }
+        else
+        {
+            iHigh = iMid;
         }
-        /* Point to the parent class */
-        pParent = pParent->pBase;
     }
     /* Not an instance of the the given class */
     return FALSE;
@@ -8781,6 +9831,7 @@ PH7_PRIVATE sxi32 PH7_VmCallClassMethod(
 )
 {
     ph7_value* aStack;
+    VmCallCache sCache;
     VmInstr aInstr[2];
     int iCursor;
     int i;
@@ -8823,7 +9874,8 @@ PH7_PRIVATE sxi32 PH7_VmCallClassMethod(
     aInstr[0].iOp = PH7_OP_CALL;
     aInstr[0].iP1 = nArg; /* Total number of given arguments */
     aInstr[0].iP2 = 0;
-    aInstr[0].p3 = 0;
+    aInstr[0].p3 = &sCache; /* Transient call site,do not allocate a binding */
+    SyZero(&sCache, sizeof(VmCallCache));
 /* Emit the DONE instruction */
     aInstr[1].iOp = PH7_OP_DONE;
     aInstr[1].iP1 = 1;   /* Extract method return value */
@@ -8851,6 +9903,7 @@ PH7_PRIVATE sxi32 PH7_VmCallUserFunction(
 )
 {
     ph7_value* aStack;
+    VmCallCache sCache;
     VmInstr aInstr[2];
     int i;
     if ((pFunc->iFlags & (MEMOBJ_STRING | MEMOBJ_HASHMAP)) == 0)
@@ -8955,7 +10008,8 @@ PH7_PRIVATE sxi32 PH7_VmCallUserFunction(
     aInstr[0].iOp = PH7_OP_CALL;
     aInstr[0].iP1 = nArg; /* Total number of given arguments */
     aInstr[0].iP2 = 0;
-    aInstr[0].p3 = 0;
+    aInstr[0].p3 = &sCache; /* Transient call site,do not allocate a binding */
+    SyZero(&sCache, sizeof(VmCallCache));
 /* Emit the DONE instruction */
     aInstr[1].iOp = PH7_OP_DONE;
     aInstr[1].iP1 = 1;   /* Extract function return value if available */
@@ -9185,6 +10239,18 @@ static int vm_builtin_define(ph7_context* pCtx, int nArg, ph7_value** apArg)
         ph7_result_bool(pCtx, 0);
         return SXRET_OK;
     }
+    if (nLen <= 64)
+    {
+        SyHashEntry* pEntry;
+        /* Immutable built-in constants may have been inlined by the compiler,refuse to redefine them */
+        pEntry = SyHashGet(&pCtx->pVm->hConstant, (const void*)zName, (sxu32)nLen);
+        if (pEntry != 0 && (((ph7_constant*)pEntry->pUserData)->iFlags & PH7_CONSTANT_IMMUTABLE))
+        {
+            ph7_context_throw_error_format(pCtx, PH7_CTX_NOTICE, "Constant '%.*s' already defined", nLen, zName);
+            ph7_result_bool(pCtx, 0);
+            return SXRET_OK;
+        }
+    }
     /* Duplicate constant value */
     pValue = (ph7_value*)SyMemBackendPoolAlloc(&pCtx->pVm->sAllocator, sizeof(ph7_value));
     if (pValue == 0)
@@ -12324,6 +13390,148 @@ static int vm_builtin_import_request_variables(ph7_context* pCtx, int nArg, ph7_
     return PH7_OK;
 }
 
+/*
+ * Unlink a compiled chunk from the LRU list.
+ */
+static void VmEvalCacheUnlink(ph7_vm* pVm, VmEvalEntry* pEntry)
+{
+    if (pEntry->pPrev)
+    {
+        pEntry->pPrev->pNext = pEntry->pNext;
+    }
+    else
+    {
+        pVm->pEvalFirst = pEntry->pNext;
+    }
+    if (pEntry->pNext)
+    {
+        pEntry->pNext->pPrev = pEntry->pPrev;
+    }
+    else
+    {
+        pVm->pEvalLast = pEntry->pPrev;
+    }
+    pEntry->pPrev = pEntry->pNext = 0;
+}
+/*
+ * Link a compiled chunk at the head of the LRU list.
+ */
+static void VmEvalCacheLink(ph7_vm* pVm, VmEvalEntry* pEntry)
+{
+    pEntry->pPrev = 0;
+    pEntry->pNext = pVm->pEvalFirst;
+    if (pVm->pEvalFirst)
+    {
+        pVm->pEvalFirst->pPrev = pEntry;
+    }
+    else
+    {
+        pVm->pEvalLast = pEntry;
+    }
+    pVm->pEvalFirst = pEntry;
+}
+/*
+ * Remove a compiled chunk from the cache and release the memory it holds.
+ * The caller must make sure the chunk is not being executed.
+ */
+static void VmEvalCacheDiscard(ph7_vm* pVm, VmEvalEntry* pEntry)
+{
+    VmEvalCacheUnlink(&(*pVm), pEntry);
+    SyHashDeleteEntry(&pVm->hEvalCache, (const void*)pEntry->sSource.zString, pEntry->sSource.nByte, 0);
+    pVm->nEvalByte -= pEntry->nByte;
+    VmReleaseByteCode(&(*pVm), &pEntry->aByteCode);
+    SyMemBackendFree(&pVm->sAllocator, (void*)pEntry->sSource.zString);
+    SyMemBackendPoolFree(&pVm->sAllocator, pEntry);
+}
+/*
+ * Evict the least recently used compiled chunks until the cache holds at most
+ * nEntry chunks and nByte bytes. Chunks that are being executed are skipped.
+ */
+static void VmEvalCacheTrim(ph7_vm* pVm, sxu32 nEntry, sxu32 nByte)
+{
+    VmEvalEntry* pEntry, * pPrev;
+    pEntry = pVm->pEvalLast;
+    while (pEntry && (SyHashTotalEntry(&pVm->hEvalCache) > nEntry || pVm->nEvalByte > nByte))
+    {
+        pPrev = pEntry->pPrev;
+        if (pEntry->nRef < 1)
+        {
+            VmEvalCacheDiscard(&(*pVm), pEntry);
+        }
+        pEntry = pPrev;
+    }
+}
+/*
+ * Remember a freshly compiled chunk. On success the bytecode container is
+ * owned by the cache and a pointer to the new entry is returned.
+ * NULL is returned when the chunk does not fit the cache limits.
+ */
+static VmEvalEntry* VmEvalCacheInsert(ph7_vm* pVm, SyString* pChunk, int iFlags, SySet* pByteCode)
+{
+    VmEvalEntry* pEntry;
+    char* zSource;
+    sxu32 nByte;
+    nByte = (sxu32)sizeof(VmEvalEntry) + pChunk->nByte + SySetUsed(pByteCode) * (sxu32)sizeof(VmInstr);
+    if (nByte > pVm->nEvalMaxByte)
+    {
+        /* Too big to be cached */
+        return 0;
+    }
+    /* Make room for the new chunk */
+    VmEvalCacheTrim(&(*pVm), pVm->nEvalMax - 1, pVm->nEvalMaxByte - nByte);
+    pEntry = (VmEvalEntry*)SyMemBackendPoolAlloc(&pVm->sAllocator, sizeof(VmEvalEntry));
+    if (pEntry == 0)
+    {
+        return 0;
+    }
+    zSource = SyMemBackendStrDup(&pVm->sAllocator, pChunk->zString, pChunk->nByte);
+    if (zSource == 0)
+    {
+        SyMemBackendPoolFree(&pVm->sAllocator, pEntry);
+        return 0;
+    }
+    SyZero(pEntry, sizeof(VmEvalEntry));
+    SyStringInitFromBuf(&pEntry->sSource, zSource, pChunk->nByte);
+    if (SXRET_OK != SyHashInsert(&pVm->hEvalCache, (const void*)zSource, pChunk->nByte, pEntry))
+    {
+        SyMemBackendFree(&pVm->sAllocator, zSource);
+        SyMemBackendPoolFree(&pVm->sAllocator, pEntry);
+        return 0;
+    }
+    /* Take ownership of the bytecode */
+    pEntry->aByteCode = *pByteCode;
+    SySetInit(pByteCode, &pVm->sAllocator, sizeof(VmInstr));
+    pEntry->iFlags = iFlags;
+    pEntry->nByte = nByte;
+    pVm->nEvalByte += nByte;
+    VmEvalCacheLink(&(*pVm), pEntry);
+    return pEntry;
+}
+/*
+ * Execute a compiled chunk and set the execution result if a call context is available.
+ */
+static void VmEvalExec(ph7_vm* pVm, ph7_context* pCtx, SySet* pByteCode, int bTrueReturn)
+{
+    ph7_value sResult; /* Return value */
+    if (bTrueReturn)
+    {
+        /* Assume a boolean true return value */
+        PH7_MemObjInitFromBool(pVm, &sResult, 1);
+    }
+    else
+    {
+        /* Assume a null return value */
+        PH7_MemObjInit(pVm, &sResult);
+    }
+    /* Execute the compiled chunk */
+    VmLocalExec(pVm, pByteCode, &sResult);
+    if (pCtx)
+    {
+        /* Set the execution result */
+        ph7_result_value(pCtx, &sResult);
+    }
+    PH7_MemObjRelease(&sResult);
+}
 /*
  * Compile and evaluate a PHP chunk at run-time.
  * Refer to the eval() language construct implementation for more
@@ -12338,8 +13546,36 @@ static sxi32 VmEvalChunk(
 )
 {
     SySet* pByteCode, aByteCode;
+    VmEvalEntry* pEntry = 0;
     ProcConsumer xErr = 0;
     void* pErrData = 0;
+    sxu32 nDeclared;
+    if (pVm->nEvalMax > 0)
+    {
+        SyHashEntry* pHashEntry;
+        /* Look for a previously compiled copy of this chunk */
+        pHashEntry = SyHashGet(&pVm->hEvalCache, (const void*)pChunk->zString, pChunk->nByte);
+        if (pHashEntry)
+        {
+            pEntry = (VmEvalEntry*)pHashEntry->pUserData;
+            if (pEntry->iFlags == iFlags)
+            {
+                /* Cache hit,skip the code generator */
+                VmEvalCacheUnlink(&(*pVm), pEntry);
+                VmEvalCacheLink(&(*pVm), pEntry);
+                pEntry->nRef++;
+                VmEvalExec(&(*pVm), pCtx, &pEntry->aByteCode, bTrueReturn);
+                pEntry->nRef--;
+                return SXRET_OK;
+            }
+            if (pEntry->nRef < 1)
+            {
+                /* Same text compiled with different flags,replace it */
+                VmEvalCacheDiscard(&(*pVm), pEntry);
+                pEntry = 0;
+            }
+        }
+    }
     /* Initialize bytecode container */
     SySetInit(&aByteCode, &pVm->sAllocator, sizeof(VmInstr));
     SySetAlloc(&aByteCode, 0x20);
@@ -12355,6 +13591,7 @@ static sxi32 VmEvalChunk(
     pByteCode = pVm->pByteContainer;
     pVm->pByteContainer = &aByteCode;
     /* Compile the chunk */
+    nDeclared = pVm->nDeclared;
     PH7_CompileScript(pVm, pChunk, iFlags);
     if (pVm->sCodeGen.nErr > 0)
     {
@@ -12366,7 +13603,6 @@ static sxi32 VmEvalChunk(
     }
     else
     {
-        ph7_value sResult; /* Return value */
         if (SXRET_OK != PH7_VmEmitInstr(pVm, PH7_OP_DONE, 0, 0, 0, 0))
         {
             /* Out of memory */
@@ -12376,29 +13612,28 @@ static sxi32 VmEvalChunk(
             }
             goto Cleanup;
         }
-        if (bTrueReturn)
+        /* Optimize the compiled chunk */
+        PH7_OptimizeByteCode(pVm, &aByteCode);
+        if (pVm->nEvalMax > 0 && pEntry == 0 && nDeclared == pVm->nDeclared)
         {
-            /* Assume a boolean true return value */
-            PH7_MemObjInitFromBool(pVm, &sResult, 1);
-        }
-        else
-        {
-            /* Assume a null return value */
-            PH7_MemObjInit(pVm, &sResult);
-        }
-        /* Execute the compiled chunk */
-        VmLocalExec(pVm, &aByteCode, &sResult);
-        if (pCtx)
-        {
-            /* Set the execution result */
-            ph7_result_value(pCtx, &sResult);
+            /* The chunk did not declare anything at compile-time [i.e: functions,classes,constants]
+             * so its bytecode can be replayed as many times as needed.
+             */
+            pEntry = VmEvalCacheInsert(&(*pVm), pChunk, iFlags, &aByteCode);
+            if (pEntry)
+            {
+                pEntry->nRef++;
+                VmEvalExec(&(*pVm), pCtx, &pEntry->aByteCode, bTrueReturn);
+                pEntry->nRef--;
+                goto Cleanup;
+            }
         }
-        PH7_MemObjRelease(&sResult);
+        VmEvalExec(&(*pVm), pCtx, &aByteCode, bTrueReturn);
     }
     Cleanup:
     /* Cleanup the mess left behind */
     pVm->pByteContainer = pByteCode;
-    SySetRelease(&aByteCode);
+    VmReleaseByteCode(&(*pVm), &aByteCode);
     return SXRET_OK;
 }
 
@@ -12521,6 +13756,205 @@ PH7_PRIVATE sxi32 PH7_VmPushFilePath(ph7_vm* pVm, const char* zPath, int nLen, s
     return SXRET_OK;
 }
 
+/*
+ * Scripts handed to the PH7_VM_CONFIG_PRELOAD_FILES directive are split between
+ * worker threads, each one described by an instance of the following structure.
+ * Workers only go through the VFS memory map routine and never touch the VM.
+ */
+typedef struct VmPreloadTask VmPreloadTask;
+struct VmPreloadTask
+{
+    const ph7_vfs* pVfs; /* Underlying VFS */
+    const char** azPath; /* Scripts to load */
+    void** apView;       /* OUT: Memory view of each script,NULL on failure */
+    ph7_int64* aSize;    /* OUT: Size of each memory view */
+    sxu32 iFirst;        /* First script handled by this task */
+    sxu32 nStride;       /* Distance between two scripts handled by this task */
+    sxu32 nPath;         /* Total number of scripts */
+    sxu32 nSum;          /* Checksum of the touched pages,so that the reads are not optimized out */
+};
+/*
+ * Each preloaded script is kept in an instance of the following structure,
+ * keyed by its canonical path in ph7_vm.hPreload.
+ */
+typedef struct VmPreloadEntry VmPreloadEntry;
+struct VmPreloadEntry
+{
+    SyString sScript;  /* Script contents */
+    ph7_int64 iMtime;  /* Modification time when the script was loaded,-1 if unknown */
+    ph7_int64 iSize;   /* Size of the script when it was loaded */
+};
+/*
+ * Canonicalize a file path [i.e: resolve symbolic links and relative components]
+ * through the xRealpath() method of the underlying VFS and append it to pOut.
+ * Return SXRET_OK on success. Any other return value indicates failure.
+ */
+static sxi32 VmRealPath(ph7_vm* pVm, const char* zPath, SyBlob* pOut)
+{
+    const ph7_vfs* pVfs = pVm->pEngine->pVfs;
+    ph7_context sCtx;
+    ph7_value sRet;
+    sxi32 rc;
+    if (pVfs == 0 || pVfs->xRealpath == 0)
+    {
+        return SXERR_NOTIMPLEMENTED;
+    }
+    PH7_MemObjInit(&(*pVm), &sRet);
+    VmInitCallContext(&sCtx, &(*pVm), 0, &sRet, 0);
+    rc = pVfs->xRealpath(zPath, &sCtx);
+    if (rc == PH7_OK && (sRet.iFlags & MEMOBJ_STRING) && SyBlobLength(&sRet.sBlob) > 0)
+    {
+        rc = SyBlobAppend(pOut, SyBlobData(&sRet.sBlob), SyBlobLength(&sRet.sBlob));
+    }
+    else
+    {
+        rc = SXERR_IO;
+    }
+    VmReleaseCallContext(&sCtx);
+    PH7_MemObjRelease(&sRet);
+    return rc;
+}
+/*
+ * Worker body: map every script assigned to this task and touch each page
+ * of the memory view so that the disk reads happen on this thread.
+ */
+static void VmPreloadTaskRun(void* pArg)
+{
+    VmPreloadTask* pTask = (VmPreloadTask*)pArg;
+    const unsigned char* zView;
+    ph7_int64 nOfft;
+    sxu32 n;
+    for (n = pTask->iFirst; n < pTask->nPath; n += pTask->nStride)
+    {
+        pTask->apView[n] = 0;
+        if (SX_EMPTY_STR(pTask->azPath[n]))
+        {
+            continue;
+        }
+        if (pTask->pVfs->xMmap(pTask->azPath[n], &pTask->apView[n], &pTask->aSize[n]) != PH7_OK)
+        {
+            pTask->apView[n] = 0;
+            continue;
+        }
+        zView = (const unsigned char*)pTask->apView[n];
+        for (nOfft = 0; nOfft < pTask->aSize[n]; nOfft += 4096)
+        {
+            pTask->nSum += zView[nOfft];
+        }
+    }
+}
+/*
+ * Load a batch of scripts on nThread threads and keep their contents so that
+ * include/require [i.e: VmExecIncludedFile()] skip the disk read.
+ * Compilation itself still happens on the calling thread when the script is
+ * included,since the code generator installs functions,classes and literals
+ * directly in the VM.
+ */
+static sxi32 VmPreloadFiles(ph7_vm* pVm, const char** azPath, sxu32 nPath, sxu32 nThread)
+{
+    const ph7_vfs* pVfs = pVm->pEngine->pVfs;
+    VmPreloadTask* aTask;
+    ph7_int64* aSize;
+    SyBlob sReal;
+    void** apView;
+    sxu32 n;
+    if (pVfs == 0 || pVfs->xMmap == 0)
+    {
+        /* Memory map routine not implemented */
+        return SXERR_NOTIMPLEMENTED;
+    }
+    if (nThread > nPath)
+    {
+        nThread = nPath;
+    }
+    apView = (void**)SyMemBackendAlloc(&pVm->sAllocator, nPath * (sxu32)(sizeof(void*) + sizeof(ph7_int64)));
+    aTask = (VmPreloadTask*)SyMemBackendAlloc(&pVm->sAllocator, nThread * (sxu32)sizeof(VmPreloadTask));
+    if (apView == 0 || aTask == 0)
+    {
+        SyMemBackendFree(&pVm->sAllocator, apView);
+        SyMemBackendFree(&pVm->sAllocator, aTask);
+        return SXERR_MEM;
+    }
+    aSize = (ph7_int64*)&apView[nPath];
+    for (n = 0; n < nThread; n++)
+    {
+        aTask[n].pVfs = pVfs;
+        aTask[n].azPath = azPath;
+        aTask[n].apView = apView;
+        aTask[n].aSize = aSize;
+        aTask[n].iFirst = n;
+        aTask[n].nStride = nThread;
+        aTask[n].nPath = nPath;
+        aTask[n].nSum = 0;
+    }
+#ifdef PH7_ENABLE_THREADS
+    if (nThread > 1)
+    {
+        SyThreadRunTasks(VmPreloadTaskRun, (void*)aTask, sizeof(VmPreloadTask), nThread);
+    }
+    else
+#endif
+    {
+        VmPreloadTaskRun((void*)aTask);
+    }
+    /* Copy the loaded scripts into the VM,keyed by their canonical path so that
+     * include/require find them whatever the current directory or include path.
+     */
+    SyBlobInit(&sReal, &pVm->sAllocator);
+    for (n = 0; n < nPath; n++)
+    {
+        VmPreloadEntry* pPreload;
+        SyHashEntry* pEntry;
+        char* zKey, * zData;
+        if (apView[n] == 0)
+        {
+            continue;
+        }
+        zData = (char*)SyMemBackendDup(&pVm->sAllocator, apView[n], (sxu32)aSize[n]);
+        if (pVfs->xUnmap)
+        {
+            pVfs->xUnmap(apView[n], aSize[n]);
+        }
+        SyBlobReset(&sReal);
+        if (zData == 0 || VmRealPath(&(*pVm), azPath[n], &sReal) != SXRET_OK)
+        {
+            /* Without a canonical path,the script cannot be told apart from its namesakes */
+            SyMemBackendFree(&pVm->sAllocator, zData);
+            continue;
+        }
+        pEntry = SyHashGet(&pVm->hPreload, SyBlobData(&sReal), SyBlobLength(&sReal));
+        if (pEntry)
+        {
+            /* Replace the previous copy */
+            pPreload = (VmPreloadEntry*)pEntry->pUserData;
+            SyMemBackendFree(&pVm->sAllocator, (void*)pPreload->sScript.zString);
+        }
+        else
+        {
+            pPreload = (VmPreloadEntry*)SyMemBackendPoolAlloc(&pVm->sAllocator, sizeof(VmPreloadEntry));
+            if (pPreload == 0)
+            {
+                SyMemBackendFree(&pVm->sAllocator, zData);
+                continue;
+            }
+            zKey = SyMemBackendStrDup(&pVm->sAllocator, (const char*)SyBlobData(&sReal), SyBlobLength(&sReal));
+            if (zKey == 0 || SXRET_OK != SyHashInsert(&pVm->hPreload, (const void*)zKey, SyBlobLength(&sReal), pPreload))
+            {
+                SyMemBackendPoolFree(&pVm->sAllocator, pPreload);
+                SyMemBackendFree(&pVm->sAllocator, zKey);
+                SyMemBackendFree(&pVm->sAllocator, zData);
+                continue;
+            }
+        }
+        SyStringInitFromBuf(&pPreload->sScript, zData, aSize[n]);
+        pPreload->iSize = aSize[n];
+        pPreload->iMtime = pVfs->xFileMtime ? pVfs->xFileMtime(azPath[n]) : -1;
+    }
+    SyBlobRelease(&sReal);
+    SyMemBackendFree(&pVm->sAllocator, apView);
+    SyMemBackendFree(&pVm->sAllocator, aTask);
+    return SXRET_OK;
+}
 /*
  * Compile and Execute a PHP script at run-time.
  * SXRET_OK is returned on sucessful evaluation.Any other return values
@@ -12534,7 +13968,8 @@ PH7_PRIVATE sxi32 PH7_VmPushFilePath(ph7_vm* pVm, const char* zPath, int nLen, s
  * constructs for more information.
  */
 static sxi32 VmExecIncludedFile(
-    ph7_context* pCtx, /* Call Context */
+    ph7_vm* pVm,       /* Target VM */
+    ph7_context* pCtx, /* Call Context.NULL otherwise */
     SyString* pPath,   /* Script path or URL*/
     int IncludeOnce    /* TRUE if called from include_once() or require_once() */
 )
@@ -12542,13 +13977,12 @@ static sxi32 VmExecIncludedFile(
     sxi32 rc;
 #ifndef PH7_DISABLE_BUILTIN_FUNC
     const ph7_io_stream* pStream;
-    SyBlob sContents;
+    SyBlob sContents, sOpened;
     void* pHandle;
-    ph7_vm* pVm;
     int isNew;
     /* Initialize fields */
-    pVm = pCtx->pVm;
     SyBlobInit(&sContents, &pVm->sAllocator);
+    SyBlobInit(&sOpened, &pVm->sAllocator);
     isNew = 0;
     /* Extract the associated stream */
     pStream = PH7_VmGetStreamDevice(pVm, &pPath->zString, pPath->nByte);
@@ -12556,9 +13990,10 @@ static sxi32 VmExecIncludedFile(
      * Open the file or the URL [i.e: http://ph7.symisc.net/example/hello.php"]
      * in a read-only mode.
      */
-    pHandle = PH7_StreamOpenHandle(pVm, pStream, pPath->zString, PH7_IO_OPEN_RDONLY, TRUE, 0, TRUE, &isNew);
+    pHandle = PH7_StreamOpenHandle(pVm, pStream, pPath->zString, PH7_IO_OPEN_RDONLY, TRUE, 0, TRUE, &isNew, &sOpened);
     if (pHandle == 0)
     {
+        SyBlobRelease(&sOpened);
         return SXERR_IO;
     }
     rc = SXRET_OK; /* Stupid cc warning */
@@ -12569,24 +14004,62 @@ static sxi32 VmExecIncludedFile(
     }
     else
     {
-        /* Read the whole file contents */
-        rc = PH7_StreamReadWholeFile(pHandle, pStream, &sContents);
-        if (rc == SXRET_OK)
+        VmPreloadEntry* pPreload = 0;
+        /* Check for a preloaded copy of the file that was actually opened first
+         * [refer to PH7_VM_CONFIG_PRELOAD_FILES].
+         */
+        if (SyHashTotalEntry(&pVm->hPreload) > 0 && SyBlobLength(&sOpened) > 0 &&
+            SyBlobNullAppend(&sOpened) == SXRET_OK &&
+            VmRealPath(&(*pVm), (const char*)SyBlobData(&sOpened), &sContents) == SXRET_OK)
+        {
+            const ph7_vfs* pVfs = pVm->pEngine->pVfs;
+            SyHashEntry* pEntry;
+            pEntry = SyHashGet(&pVm->hPreload, SyBlobData(&sContents), SyBlobLength(&sContents));
+            if (pEntry)
+            {
+                pPreload = (VmPreloadEntry*)pEntry->pUserData;
+                if ((pVfs->xFileSize && pVfs->xFileSize((const char*)SyBlobData(&sOpened)) != pPreload->iSize) ||
+                    (pVfs->xFileMtime && pVfs->xFileMtime((const char*)SyBlobData(&sOpened)) != pPreload->iMtime))
+                {
+                    /* The file changed on disk since it was loaded,drop the stale copy */
+                    void* pKey = (void*)pEntry->pKey;
+                    SyHashDeleteEntry2(pEntry);
+                    SyMemBackendFree(&pVm->sAllocator, pKey);
+                    SyMemBackendFree(&pVm->sAllocator, (void*)pPreload->sScript.zString);
+                    SyMemBackendPoolFree(&pVm->sAllocator, pPreload);
+                    pPreload = 0;
+                }
+            }
+            SyBlobReset(&sContents);
+        }
+        if (pPreload)
         {
-            SyString sScript;
-            /* Compile and execute the script */
-            SyStringInitFromBuf(&sScript, SyBlobData(&sContents), SyBlobLength(&sContents));
-            VmEvalChunk(pCtx->pVm, &(*pCtx), &sScript, 0, TRUE);
+            /* Compile and execute the preloaded script */
+            VmEvalChunk(&(*pVm), pCtx, &pPreload->sScript, 0, TRUE);
+        }
+        else
+        {
+            /* Read the whole file contents */
+            rc = PH7_StreamReadWholeFile(pHandle, pStream, &sContents);
+            if (rc == SXRET_OK)
+            {
+                SyString sScript;
+                /* Compile and execute the script */
+                SyStringInitFromBuf(&sScript, SyBlobData(&sContents), SyBlobLength(&sContents));
+                VmEvalChunk(&(*pVm), pCtx, &sScript, 0, TRUE);
+            }
         }
     }
     /* Pop from the set of included file */
     (void)SySetPop(&pVm->aFiles);
     /* Close the handle */
     PH7_StreamCloseHandle(pStream, pHandle);
-    /* Release the working buffer */
+    /* Release the working buffers */
     SyBlobRelease(&sContents);
+    SyBlobRelease(&sOpened);
 #else
-    pCtx = 0; /* cc warning */
+    pVm = 0; /* cc warning */
+    pCtx = 0;
     pPath = 0;
     IncludeOnce = 0;
     rc = SXERR_IO;
@@ -12736,7 +14209,7 @@ static int vm_builtin_include(ph7_context* pCtx, int nArg, ph7_value** apArg)
         return SXRET_OK;
     }
     /* Open,compile and execute the desired script */
-    rc = VmExecIncludedFile(&(*pCtx), &sFile, FALSE);
+    rc = VmExecIncludedFile(pCtx->pVm, &(*pCtx), &sFile, FALSE);
     if (rc != SXRET_OK)
     {
         /* Emit a warning and return false */
@@ -12774,7 +14247,7 @@ static int vm_builtin_include_once(ph7_context* pCtx, int nArg, ph7_value** apAr
         return SXRET_OK;
     }
     /* Open,compile and execute the desired script */
-    rc = VmExecIncludedFile(&(*pCtx), &sFile, TRUE);
+    rc = VmExecIncludedFile(pCtx->pVm, &(*pCtx), &sFile, TRUE);
     if (rc == SXERR_EXISTS)
     {
         /* File already included,return TRUE */
@@ -12817,7 +14290,7 @@ static int vm_builtin_require(ph7_context* pCtx, int nArg, ph7_value** apArg)
         return SXRET_OK;
     }
     /* Open,compile and execute the desired script */
-    rc = VmExecIncludedFile(&(*pCtx), &sFile, FALSE);
+    rc = VmExecIncludedFile(pCtx->pVm, &(*pCtx), &sFile, FALSE);
     if (rc != SXRET_OK)
     {
         /* Fatal,abort VM execution immediately */
@@ -12855,7 +14328,7 @@ static int vm_builtin_require_once(ph7_context* pCtx, int nArg, ph7_value** apAr
         return SXRET_OK;
     }
     /* Open,compile and execute the desired script */
-    rc = VmExecIncludedFile(&(*pCtx), &sFile, TRUE);
+    rc = VmExecIncludedFile(pCtx->pVm, &(*pCtx), &sFile, TRUE);
     if (rc == SXERR_EXISTS)
     {
         /* File already included,return TRUE */
@@ -16027,17 +17500,18 @@ static sxi32 VmRegisterSpecialFunction(ph7_vm* pVm)
     return SXRET_OK;
 }
 /*
- * Check if the given name refer to an installed class.
+ * Check if the given name refer to an installed class without mounting it.
+ * This routine is used by the code generator where the class must not be
+ * mounted (and its static attributes evaluated) in the middle of a compilation.
  * Return a pointer to that class on success. NULL on failure.
  */
-PH7_PRIVATE ph7_class* PH7_VmExtractClass(
+PH7_PRIVATE ph7_class* PH7_VmLookupClass(
     ph7_vm* pVm,        /* Target VM */
     const char* zName,  /* Name of the target class */
     sxu32 nByte,        /* zName length */
-    sxi32 iLoadable,    /* TRUE to return only loadable class
+    sxi32 iLoadable     /* TRUE to return only loadable class
                          * [i.e: no abstract classes or interfaces]
                          */
-    sxi32 iNest         /* Nesting level (Not used) */
 )
 {
     SyHashEntry* pEntry;
@@ -16048,7 +17522,6 @@ PH7_PRIVATE ph7_class* PH7_VmExtractClass(
     if (pEntry == 0)
     {
 /* No such entry,return NULL */
-        iNest = 0; /* cc warning */
         return 0;
     }
     pClass = (ph7_class*)pEntry->pUserData;
@@ -16074,6 +17547,83 @@ PH7_PRIVATE ph7_class* PH7_VmExtractClass(
 /* No such loadable class */
     return 0;
 }
+/*
+ * Load the script registered for the given class name in the autoload index
+ * [i.e: PH7_VM_CONFIG_AUTOLOAD_CLASS]. The entry is consumed first so that a
+ * script which does not declare the expected class is loaded at most once.
+ */
+static sxi32 VmAutoloadClass(ph7_vm* pVm, const char* zName, sxu32 nByte)
+{
+    SyHashEntry* pEntry;
+    SyString sPath;
+    void* pKey;
+    char* zPath;
+    if (SyHashTotalEntry(&pVm->hAutoload) < 1)
+    {
+/* Empty index */
+        return SXERR_NOTFOUND;
+    }
+    pEntry = SyHashGet(&pVm->hAutoload, (const void*)zName, nByte);
+    if (pEntry == 0)
+    {
+        return SXERR_NOTFOUND;
+    }
+    pKey = (void*)pEntry->pKey;
+    zPath = (char*)pEntry->pUserData;
+    SyHashDeleteEntry2(pEntry);
+    SyMemBackendFree(&pVm->sAllocator, pKey);
+/* Compile and execute the script */
+    SyStringInitFromBuf(&sPath, zPath, SyStrlen(zPath));
+    VmExecIncludedFile(&(*pVm), 0, &sPath, TRUE);
+    SyMemBackendFree(&pVm->sAllocator, zPath);
+    return SXRET_OK;
+}
+/*
+ * Check if the given name refer to an installed class.
+ * At run-time,unknown classes are first looked up in the autoload index and
+ * the class is mounted [i.e: static attributes initialized,methods installed]
+ * the first time it is requested.
+ * Return a pointer to that class on success. NULL on failure.
+ */
+PH7_PRIVATE ph7_class* PH7_VmExtractClass(
+    ph7_vm* pVm,        /* Target VM */
+    const char* zName,  /* Name of the target class */
+    sxu32 nByte,        /* zName length */
+    sxi32 iLoadable,    /* TRUE to return only loadable class
+                         * [i.e: no abstract classes or interfaces]
+                         */
+    sxi32 iNest         /* Nesting level (Not used) */
+)
+{
+    ph7_class* pClass;
+    pClass = PH7_VmLookupClass(&(*pVm), zName, nByte, iLoadable);
+    if (pVm->nMagic != PH7_VM_EXEC)
+    {
+/* Not executing yet,return the raw class */
+        iNest = 0; /* cc warning */
+        return pClass;
+    }
+    if (pClass == 0)
+    {
+/* Try the autoload index */
+        if (VmAutoloadClass(&(*pVm), zName, nByte) != SXRET_OK)
+        {
+            return 0;
+        }
+        pClass = PH7_VmLookupClass(&(*pVm), zName, nByte, iLoadable);
+        if (pClass == 0)
+        {
+/* The script does not declare the class */
+            return 0;
+        }
+    }
+    if ((pClass->iFlags & PH7_CLASS_MOUNTED) == 0)
+    {
+/* First use of this class */
+        VmMountUserClass(&(*pVm), pClass);
+    }
+    return pClass;
+}
 /*
  * Reference Table Implementation
  * Status: stable <chm@symisc.net>
@@ -16112,8 +17662,11 @@ static VmRefObj* VmNewRefObj(ph7_vm* pVm, sxu32 nIdx)
  */
 static sxu32 VmRefHash(sxu32 nIdx)
 {
-    /* Calculate the hash based on the memory object index */
-    return nIdx ^ (nIdx << 8) ^ (nIdx >> 8);
+    /* Memory object indexes are dense [i.e: slots are allocated sequentially and
+     * recycled],so the index itself spreads evenly over the table and keeps
+     * neighbour entries in neighbour buckets.
+     */
+    return nIdx;
 }
 
 /*